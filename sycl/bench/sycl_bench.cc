@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+//
+// Single benchmark driver for all registered variants (see registry.hpp)
+//
+// sycl_bench -list : list families and their variants
+// sycl_bench -family=<f> [-variants=<a,b,...>] [family options]
+//
+// Selected variants (all variants of family by default) run one after
+// another on identical input data and one queue, so they are compared on
+// the same warmed device; -report=<file> collects all of them in one file
+//
+// try: sycl_bench -family=sgemm -variants=matmult_local,matmult_groups -reps=5
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "registry.hpp"
+
+namespace {
+
+// -name=value or --name=value
+bool driver_option(const std::string &Arg, const std::string &Name,
+                   std::string &Val) {
+  for (auto &&Prefix : {"-" + Name + "=", "--" + Name + "="})
+    if (Arg.compare(0, Prefix.size(), Prefix) == 0) {
+      Val = Arg.substr(Prefix.size());
+      return true;
+    }
+  return false;
+}
+
+std::vector<std::string> split_names(const std::string &Names) {
+  std::vector<std::string> Ret;
+  std::string::size_type Pos = 0;
+  while (Pos < Names.size()) {
+    auto Comma = Names.find(',', Pos);
+    if (Comma == Names.npos)
+      Comma = Names.size();
+    if (Comma > Pos)
+      Ret.push_back(Names.substr(Pos, Comma - Pos));
+    Pos = Comma + 1;
+  }
+  return Ret;
+}
+
+void dump_families(std::ostream &Os) {
+  auto &Families = sycltesters::FamilyRegistry::instance();
+  for (auto &&Family : Families.names()) {
+    Os << Family << ":";
+    for (auto &&Variant : Families.find(Family)->Variants())
+      Os << " " << Variant;
+    Os << "\n";
+  }
+}
+
+void dump_usage(std::ostream &Os, const std::string &Program) {
+  Os << "Usage: " << Program << " -list\n";
+  Os << "       " << Program
+     << " -family=<f> [-variants=<a,b,...>] [family options]\n";
+  Os << "Family options are listed with -family=<f> -help\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string Family, Variants;
+  bool List = false;
+
+  // driver options are taken out, everything else goes to family parser
+  std::vector<char *> Args{argv[0]};
+  for (int I = 1; I < argc; ++I) {
+    std::string Arg = argv[I];
+    if (driver_option(Arg, "family", Family) ||
+        driver_option(Arg, "variants", Variants))
+      continue;
+    if (Arg == "-list" || Arg == "--list") {
+      List = true;
+      continue;
+    }
+    Args.push_back(argv[I]);
+  }
+
+  if (List) {
+    dump_families(std::cout);
+    return 0;
+  }
+
+  if (Family.empty()) {
+    dump_usage(std::cerr, argv[0]);
+    return 1;
+  }
+
+  const auto *Entry = sycltesters::FamilyRegistry::instance().find(Family);
+  if (Entry == nullptr) {
+    std::cerr << "Unknown family: " << Family << ", available are:\n";
+    dump_families(std::cerr);
+    return 1;
+  }
+
+  int NArgs = Args.size();
+  Args.push_back(nullptr);
+  Entry->Run(NArgs, Args.data(), split_names(Variants));
+}
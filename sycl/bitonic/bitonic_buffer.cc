@@ -79,6 +79,10 @@ public:
   }
 };
 
+REGISTER_VARIANT(bitonicsort, "bitonic_buffer", BitonicSortBuf<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<BitonicSortBuf<int>>(argc, argv);
 }
+#endif
@@ -40,7 +40,7 @@ public:
     int N = std::countr_zero(Sz);
     auto &DeviceQueue = Queue();
 
-    T *A = sycl::malloc_device<T>(Sz, DeviceQueue);
+    T *A = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
     auto EvtCpyData = DeviceQueue.copy(Vec, A, Sz);
     ProfInfo.emplace_back(EvtCpyData, "Copy to device");
     EvtCpyData.wait();
@@ -85,11 +85,15 @@ public:
     auto EvtCpyBack = DeviceQueue.copy(A, Vec, Sz);
     ProfInfo.emplace_back(EvtCpyBack, "Copy back");
     DeviceQueue.wait();
-    sycl::free(A, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(bitonicsort, "bitonic_device", BitonicSortShared<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<BitonicSortShared<int>>(argc, argv);
 }
+#endif
@@ -1,6 +1,7 @@
 //------------------------------------------------------------------------------
 //
 // Bitonic sort, SYCL way, with shared memory
+// All kernels are recorded once into task graph and replayed without waits
 //
 //------------------------------------------------------------------------------
 //
@@ -24,18 +25,18 @@ template <typename T> class bitonic_device_global;
 
 using ConfigTy = sycltesters::bitonicsort::Config;
 
+// command group functions: recorded into task graph, see taskgraph.hpp
 template <typename T>
-auto EnqueueLocalIterationLastStages(sycl::queue &DeviceQueue, T *A, int GSZ,
-                                     int LSZ, int Step, int StageStart) {
+auto LocalIterationLastStages(T *A, int GSZ, int LSZ, int Step,
+                              int StageStart) {
   sycl::range<1> GRange{GSZ}, LRange{LSZ};
   sycl::nd_range<1> IterSpace(GRange, LRange);
   using LTy = sycl::accessor<T, 1, sycl_read_write, sycl_local>;
   const int LMEM = LSZ;
   sycl::range<1> LocalMemorySize{LMEM};
 
-  auto Evt = DeviceQueue.submit([=](sycl::handler &Cgh) {
+  return [=](sycl::handler &Cgh) {
     LTy Cache{LocalMemorySize, Cgh};
-    sycl::stream Out(1024, 256, Cgh);
 
     auto KernStages = [=](sycl::nd_item<1> WorkItem) {
       const int G = WorkItem.get_global_id(0);
@@ -44,7 +45,6 @@ auto EnqueueLocalIterationLastStages(sycl::queue &DeviceQueue, T *A, int GSZ,
       WorkItem.barrier();
 
       const int I = L;
-      int Stage = StageStart;
       for (int Stage = StageStart; Stage >= 0; Stage--) {
         const int SeqLen = 1 << (Stage + 1);
         const int Power2 = 1 << (Step - Stage);
@@ -69,19 +69,18 @@ auto EnqueueLocalIterationLastStages(sycl::queue &DeviceQueue, T *A, int GSZ,
     };
     Cgh.parallel_for<class bitonic_device_local_stages<T>>(IterSpace,
                                                            KernStages);
-  });
-  return Evt;
+  };
 }
 
 template <typename T>
-auto EnqueueLocalIterationFirstSteps(sycl::queue &DeviceQueue, T *A, int GSZ,
-                                     int LSZ, int StepStart, int StepEnd) {
+auto LocalIterationFirstSteps(T *A, int GSZ, int LSZ, int StepStart,
+                              int StepEnd) {
   sycl::range<1> GRange{GSZ}, LRange{LSZ};
   sycl::nd_range<1> IterSpace(GRange, LRange);
   using LTy = sycl::accessor<T, 1, sycl_read_write, sycl_local>;
   const int LMEM = LSZ;
   sycl::range<1> LocalMemorySize{LMEM};
-  auto Evt = DeviceQueue.submit([=](sycl::handler &Cgh) {
+  return [=](sycl::handler &Cgh) {
     LTy Cache{LocalMemorySize, Cgh};
     auto KernSteps = [=](sycl::nd_item<1> WorkItem) {
       const int G = WorkItem.get_global_id(0);
@@ -115,14 +114,54 @@ auto EnqueueLocalIterationFirstSteps(sycl::queue &DeviceQueue, T *A, int GSZ,
       A[G] = Cache[L];
     };
     Cgh.parallel_for<class bitonic_device_local_steps<T>>(IterSpace, KernSteps);
-  });
-  return Evt;
+  };
+}
+
+template <typename T> auto GlobalStage(T *A, size_t Sz, int Step, int Stage) {
+  sycl::range<1> NumOfItems{Sz};
+  return [=](sycl::handler &Cgh) {
+    auto Kernsort = [=](sycl::id<1> I) {
+      const int SeqLen = 1 << (Stage + 1);
+      const int Power2 = 1 << (Step - Stage);
+      const int SeqNum = I / SeqLen;
+      const int Odd = SeqNum / Power2;
+      const bool Increasing = ((Odd % 2) == 0);
+      const int HalfLen = SeqLen / 2;
+
+      if (I < (SeqLen * SeqNum) + HalfLen) {
+        const int J = I + HalfLen;
+        if (((A[I] > A[J]) && Increasing) || ((A[I] < A[J]) && !Increasing)) {
+          T Temp = A[I];
+          A[I] = A[J];
+          A[J] = Temp;
+        }
+      }
+    };
+
+    Cgh.parallel_for<class bitonic_device_global<T>>(NumOfItems, Kernsort);
+  };
 }
 
 template <typename T>
 class BitonicDeviceLocal : public sycltesters::BitonicSort<T> {
   using sycltesters::BitonicSort<T>::Queue;
   ConfigTy Cfg_;
+  sycltesters::TaskGraph Graph_;
+
+  // all kernels of sort as one chain: recorded once per device block
+  void record(T *A, int N, int NFST, int Sz, int LSZ) {
+    Graph_.then("Starting iterations",
+                LocalIterationFirstSteps(A, Sz, LSZ, 0, std::min(NFST - 1, N)));
+    for (int Step = NFST - 1; Step < N; Step++) {
+      int StageLast = NFST - 2;
+      for (int Stage = Step; Stage >= StageLast; Stage--)
+        Graph_.then("Next iteration", GlobalStage(A, Sz, Step, Stage));
+
+      // schedule all stages up to (Step - NFST) as small ones
+      Graph_.then("Starting stages for next step",
+                  LocalIterationLastStages(A, Sz, LSZ, Step, StageLast - 1));
+    }
+  }
 
 public:
   BitonicDeviceLocal(sycl::queue &DeviceQueue, ConfigTy Cfg)
@@ -147,89 +186,45 @@ public:
     if (!Cfg_.Verbose)
       sycltesters::qout.set(true);
 
-    T *A = sycl::malloc_device<T>(Sz, DeviceQueue);
+    T *A = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
     auto EvtCpyData = DeviceQueue.copy(Vec, A, Sz);
     ProfInfo.emplace_back(EvtCpyData, "Copy to device");
-    EvtCpyData.wait();
 
     sycltesters::qout << "N = " << N << std::endl;
     sycltesters::qout << "NFST = " << NFST << std::endl;
     sycltesters::qout << "GSZ = " << GSZ << std::endl;
     sycltesters::qout << "LSZ = " << LSZ << std::endl;
 
-    auto Evt = EnqueueLocalIterationFirstSteps(DeviceQueue, A, Sz, LSZ, 0,
-                                               std::min(NFST - 1, N));
-    ProfInfo.emplace_back(Evt, "Starting iterations");
-    Evt.wait(); // no implicit task graph
+    // pool gives same block for same size, so graph is recorded once
+    if (Graph_.rebind(A, Sz, LSZ))
+      record(A, N, NFST, Sz, LSZ);
 
-    // visualization after prep
+    sycltesters::EvtVec_t GraphInfo;
     if (Cfg_.Verbose) {
-      sycltesters::qout << "After local pre-sort: " << NFST - 1 << std::endl;
-      DeviceQueue.copy(A, Vec, Sz);
-      DeviceQueue.wait();
-      visualize_seq(Vec, Vec + Sz, sycltesters::qout);
-    }
-
-    sycl::range<1> NumOfItems{Sz};
-    for (int Step = NFST - 1; Step < N; Step++) {
-      int StageLast = NFST - 2;
-
-      for (int Stage = Step; Stage >= StageLast; Stage--) {
-        // Offload the work to kernel.
-        auto Evt = DeviceQueue.submit([=](sycl::handler &Cgh) {
-          auto Kernsort = [=](sycl::id<1> I) {
-            const int SeqLen = 1 << (Stage + 1);
-            const int Power2 = 1 << (Step - Stage);
-            const int SeqNum = I / SeqLen;
-            const int Odd = SeqNum / Power2;
-            const bool Increasing = ((Odd % 2) == 0);
-            const int HalfLen = SeqLen / 2;
-
-            if (I < (SeqLen * SeqNum) + HalfLen) {
-              const int J = I + HalfLen;
-              if (((A[I] > A[J]) && Increasing) ||
-                  ((A[I] < A[J]) && !Increasing)) {
-                T Temp = A[I];
-                A[I] = A[J];
-                A[J] = Temp;
-              }
-            }
-          };
-
-          Cgh.parallel_for<class bitonic_device_global<T>>(NumOfItems,
-                                                           Kernsort);
-        });
-        ProfInfo.emplace_back(Evt, "Next iteration");
-        Evt.wait(); // no implicit task graph
-
-        // visualization after stage
-        if (Cfg_.Verbose) {
-          sycltesters::qout << "After stage: " << Stage << std::endl;
-          DeviceQueue.copy(A, Vec, Sz);
-          DeviceQueue.wait();
-          visualize_seq(Vec, Vec + Sz, sycltesters::qout);
-        }
-      }
-
-      // schedule all stages up to (Step - NFST) as small ones
-      auto Evt = EnqueueLocalIterationLastStages(DeviceQueue, A, Sz, LSZ, Step,
-                                                 StageLast - 1);
-      ProfInfo.emplace_back(Evt, "Starting stages for next step");
-      Evt.wait(); // no implicit task graph
-
-      if (Cfg_.Verbose) {
-        sycltesters::qout << "After local stages: " << StageLast << std::endl;
-        DeviceQueue.copy(A, Vec, Sz);
-        DeviceQueue.wait();
-        visualize_seq(Vec, Vec + Sz, sycltesters::qout);
-      }
+      // visualization after every kernel
+      GraphInfo = Graph_.replay_stepwise(
+          DeviceQueue,
+          [&](auto, const std::string &Name) {
+            sycltesters::qout << "After: " << Name << std::endl;
+            DeviceQueue.copy(A, Vec, Sz);
+            DeviceQueue.wait();
+            visualize_seq(Vec, Vec + Sz, sycltesters::qout);
+          },
+          {EvtCpyData});
+    } else {
+      // no host round-trips between kernels
+      GraphInfo = Graph_.replay(DeviceQueue, {EvtCpyData});
     }
+    ProfInfo.insert(ProfInfo.end(), GraphInfo.begin(), GraphInfo.end());
 
     // only for Sz <= LMEM
-    auto EvtCpyBack = DeviceQueue.copy(A, Vec, Sz);
+    auto EvtCpyBack = DeviceQueue.submit([&](sycl::handler &Cgh) {
+      Cgh.depends_on(GraphInfo.back().Evt_);
+      Cgh.copy(A, Vec, Sz);
+    });
     ProfInfo.emplace_back(EvtCpyBack, "Copy back");
     DeviceQueue.wait();
-    sycl::free(A, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
 
     // restoring if it was changed
     sycltesters::qout.set(OldState);
@@ -237,6 +232,10 @@ public:
   }
 };
 
+REGISTER_VARIANT(bitonicsort, "bitonic_device_local", BitonicDeviceLocal<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<BitonicDeviceLocal<int>>(argc, argv);
 }
+#endif
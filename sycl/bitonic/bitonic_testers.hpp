@@ -7,6 +7,14 @@
 //  * inherited from testers.hpp: RUNHOST, INORD...
 //  -DCHECK_BITONIC_CPU : check against bitonic sort CPU code
 //
+// Options to control things:
+// -data=<file> : binary int dataset (see dataset.hpp) of power-of-two
+//                elements, overrides -size
+// -reps=<n>, -warmup=<w> : measured and warmup runs (see testers.hpp)
+//   each run sorts the same initial data
+// -tune : tune lsz for device, tuned lsz is default afterwards (tuner.hpp)
+// numeric options may be lists or ranges: -size=10..20 -lsz=64,128
+//
 //------------------------------------------------------------------------------
 //
 // This file is licensed after LGPL v3
@@ -20,9 +28,12 @@
 #include <bit>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <numeric>
+#include <string>
 #include <vector>
 
 #include <CL/sycl.hpp>
@@ -43,15 +54,14 @@ namespace sycltesters {
 
 namespace bitonicsort {
 struct Config {
-  std::string FileName;
+  std::string FileName, DataFile;
   unsigned Size, LocSz;
   bool Vis = false, Quiet = false, Detailed = false, Definit = false,
        Verbose = false, InpFile = false;
+  BenchConfig Bench;
 };
 
-inline Config read_config(int argc, char **argv) {
-  Config Cfg;
-  options::Parser OptParser;
+inline void add_options(options::Parser &OptParser) {
   OptParser.template add<int>(
       "size", DEF_SIZE, "logarithmic size to sort (1 << size) is real size");
   OptParser.template add<int>("lsz", DEF_BLOCK_SIZE, "local size");
@@ -61,9 +71,17 @@ inline Config read_config(int argc, char **argv) {
   OptParser.template add<int>("definit", 0, "initialize for worst case");
   OptParser.template add<std::string>("inpfile", "",
                                       "initialize from given file");
+  OptParser.template add<std::string>("data", "",
+                                      "binary dataset to initialize from");
   OptParser.template add<int>("verbose", 0,
                               "really verbose mode: after each step");
-  OptParser.parse(argc, argv);
+  add_bench_options(OptParser);
+}
+
+// for currently selected sweep point
+inline Config read_config(const options::Parser &OptParser,
+                          std::string Program) {
+  Config Cfg;
 
   Cfg.Size = OptParser.template get<int>("size");
   Cfg.LocSz = OptParser.template get<int>("lsz");
@@ -73,6 +91,15 @@ inline Config read_config(int argc, char **argv) {
   Cfg.Verbose = OptParser.exists("verbose");
   Cfg.InpFile = OptParser.exists("inpfile");
   Cfg.FileName = OptParser.template get<std::string>("inpfile");
+  Cfg.DataFile = OptParser.template get<std::string>("data");
+  if (!Cfg.DataFile.empty()) {
+    unsigned Elts = dataset_elements<int>(Cfg.DataFile);
+    if (std::popcount(Elts) != 1)
+      throw std::runtime_error("Dataset size shall be power of two");
+    Cfg.Size = std::countr_zero(Elts);
+  }
+  Cfg.Bench = read_bench_options(OptParser, Program);
+  Cfg.Bench.Given = given_options(OptParser, {"lsz"});
 
   if (Cfg.Size < 2 || Cfg.Size > 31)
     throw std::runtime_error("Size is logarithmic, 2 is min, 31 is max");
@@ -85,6 +112,41 @@ inline Config read_config(int argc, char **argv) {
 
   return Cfg;
 }
+
+inline void record_config(const Config &Cfg, ResultRecord &Rec) {
+  Rec.add("config", "size", Cfg.Size);
+  Rec.add("config", "lsz", Cfg.LocSz);
+  Rec.add("config", "definit", Cfg.Definit);
+  Rec.add("config", "inpfile", Cfg.InpFile ? Cfg.FileName : "");
+  Rec.add("config", "data", Cfg.DataFile);
+}
+
+// network of Size * (Size + 1) / 2 stages, every stage compares n / 2 pairs
+// and reads and writes whole array
+template <typename T> WorkCount work_count(const Config &Cfg) {
+  double N = std::ldexp(1.0, Cfg.Size);
+  double Stages = Cfg.Size * (Cfg.Size + 1) / 2.0;
+  return {Stages * N / 2, Stages * 2 * N * sizeof(T)};
+}
+
+// input, tester vector and its saved copy for repeated runs; host
+// reference sorts own copy and returns one more
+template <typename T> Footprint footprint(const Config &Cfg) {
+  double Vec = std::ldexp(1.0, Cfg.Size) * sizeof(T);
+  double Saved = (Cfg.Bench.Reps + Cfg.Bench.Warmup > 1) ? 1 : 0;
+  return {Vec * (2 + Saved + 2 * HOST_REF_COPIES), Vec, Vec};
+}
+
+// local stages sort LocSz elements in local memory, LocSz is power of two
+template <typename T> TuneSpace tune_space(sycl::device D, Config &Cfg) {
+  auto Lim = device_limits(D);
+  auto Legal = [Lim, &Cfg] {
+    size_t L = Cfg.LocSz;
+    return L <= Lim.MaxWG && L * sizeof(T) <= Lim.LocalMem &&
+           L <= (size_t(1) << Cfg.Size);
+  };
+  return {{tune_param("lsz", Cfg.LocSz, pow2_candidates(2, 1024))}, Legal};
+}
 } // namespace bitonicsort
 
 template <typename T> class BitonicSort {
@@ -149,6 +211,7 @@ template <typename T> class BitonicSortTester {
   bitonicsort::Config Cfg_;
   unsigned Sz_;
   std::vector<T> A_;
+  std::vector<T> Orig_; // pristine input for repeated runs
 
 public:
   BitonicSortTester(BitonicSort<T> &Sorter, bitonicsort::Config Cfg)
@@ -161,6 +224,14 @@ public:
       return;
     }
 
+    // mapped binary dataset: copied since sort is in-place
+    if (!Cfg_.DataFile.empty()) {
+      qout << "Mapping dataset: " << Cfg_.DataFile << std::endl;
+      Dataset<T> Ds{Cfg_.DataFile};
+      std::copy(Ds.data(), Ds.data() + Sz_, A_.begin());
+      return;
+    }
+
     // input from file
     if (Cfg_.InpFile) {
       qout << "Reading: " << Cfg_.FileName << std::endl;
@@ -170,16 +241,20 @@ public:
       return;
     }
 
-    // random generate
-    Dice d(0, Sz_);
-    std::generate(A_.begin(), A_.end(), [&] { return d(); });
+    // random generate (in parallel, see dice.hpp)
+    rand_initialize(A_.begin(), A_.end(), 0, Sz_);
   }
 
   template <typename It> void assign(It begin, It end) {
     A_.assign(begin, end);
   }
 
-  std::pair<unsigned, unsigned long long> calculate() {
+  // sorting is in-place, so for multiple runs we need to keep input
+  void save_input() { Orig_ = A_; }
+
+  Timing_t calculate() {
+    if (!Orig_.empty())
+      std::copy(Orig_.begin(), Orig_.end(), A_.begin());
     Timer_.start();
     EvtRet_t Ret = Sorter_(A_.data(), A_.size());
     auto EvtTiming = getTime(Ret, Cfg_.Detailed ? false : true);
@@ -191,73 +266,201 @@ public:
   auto end() { return A_.end(); }
 };
 
+// input as tester initializes it: random, deterministic or from file
+template <typename Ty>
+std::vector<Ty> bitonic_input(sycl::queue &Q, const bitonicsort::Config &Cfg) {
+  BitonicSortHost<Ty> BitonicSortH{Q}; // Q unused for this derived class
+  BitonicSortTester<Ty> Init{BitonicSortH, Cfg};
+  Init.initialize();
+  return {Init.begin(), Init.end()};
+}
+
+// host reference result, empty unless MEASURE_NORMAL
+template <typename Ty>
+std::vector<Ty> bitonic_reference(sycl::queue &Q,
+                                  const bitonicsort::Config &Cfg,
+                                  const std::vector<Ty> &Input) {
+#ifdef MEASURE_NORMAL
+  BitonicSortHost<Ty> BitonicSortH{Q}; // Q unused for this derived class
+  BitonicSortTester<Ty> TesterH{BitonicSortH, Cfg};
+  TesterH.assign(Input.begin(), Input.end());
+  measure_host(Cfg.Bench, [&] { return TesterH.calculate(); });
+  if (Cfg.Vis) {
+    qout << "After sort (host):\n";
+    visualize_seq(TesterH.begin(), TesterH.end(), qout);
+  }
+  return {TesterH.begin(), TesterH.end()};
+#else
+  return {};
+#endif
+}
+
+// measure one variant on given input, HostRef is host result or nullptr
+template <typename Ty>
+BenchResult bench_bitonic_variant(sycl::queue &Q,
+                                  const bitonicsort::Config &Cfg,
+                                  BitonicSort<Ty> &Sorter,
+                                  const std::vector<Ty> &Input,
+                                  const Ty *HostRef) {
+  BitonicSortTester<Ty> Tester{Sorter, Cfg};
+  Tester.assign(Input.begin(), Input.end());
+
+  qout << "Calculating\n";
+  if (Cfg.Bench.Reps + Cfg.Bench.Warmup > 1)
+    Tester.save_input();
+  auto Bench = run_bench(Cfg.Bench, [&] { return Tester.calculate(); });
+  attach_work(Q, Cfg.Bench, Bench, bitonicsort::work_count<Ty>(Cfg));
+
+  if (Cfg.Vis) {
+    qout << "After sort:\n";
+    visualize_seq(Tester.begin(), Tester.end(), qout);
+  }
+
+#ifdef VERIFY
+  if (!std::is_sorted(Tester.begin(), Tester.end()))
+    throw std::runtime_error("Sorting failed");
+  // we may also check with host results
+  if (HostRef != nullptr)
+    check_result("bitonic", HostRef, &*Tester.begin(),
+                 std::distance(Tester.begin(), Tester.end()), Cfg.Bench);
+#endif
+  qout << "Measured time: " << SecFmt{Bench.WallStats.Median} << "\n";
+  qout << "Pure execution time: " << SecFmt{Bench.EvtStats.Median} << "\n";
+  dump_bench(qout, Bench);
+  report_result("bitonicsort", Cfg, Q.get_device(), Bench);
+  return Bench;
+}
+
+// Make(Cfg) creates variant for current sizes of Cfg
+template <typename Ty, typename MakeF>
+void tune_bitonic_variant(sycl::queue &Q, bitonicsort::Config &Cfg, MakeF Make,
+                          const std::vector<Ty> &Input) {
+  auto Space = bitonicsort::tune_space<Ty>(Q.get_device(), Cfg);
+  tune_config(Q, Cfg.Bench, Space, [&] {
+    auto Sorter = Make(Cfg);
+    BitonicSortTester<Ty> Tester{*Sorter, Cfg};
+    Tester.assign(Input.begin(), Input.end());
+    return Tester.calculate();
+  });
+}
+
+template <typename BitonicChildT>
+void single_bitonic_sequence(sycl::queue &Q, bitonicsort::Config Cfg) {
+  qout << "Using vector size = " << (1 << Cfg.Size) << "\n";
+  using Ty = typename BitonicChildT::type;
+  preflight(Q.get_device(), bitonicsort::footprint<Ty>(Cfg));
+
+  qout << "Initializing\n";
+  auto Input = bitonic_input<Ty>(Q, Cfg);
+  tune_bitonic_variant<Ty>(
+      Q, Cfg,
+      [&Q](const bitonicsort::Config &C) {
+        return std::make_unique<BitonicChildT>(Q, C);
+      },
+      Input);
+  BitonicChildT BitonicSort{Q, Cfg};
+
+  if (Cfg.Vis) {
+    qout << "Before sort:\n";
+    visualize_seq(Input.begin(), Input.end(), qout);
+  }
+
+  auto HostRef = bitonic_reference(Q, Cfg, Input);
+  auto Bench = bench_bitonic_variant<Ty>(
+      Q, Cfg, BitonicSort, Input, HostRef.empty() ? nullptr : HostRef.data());
+
+  // Quiet mode output: size, elapsed time
+  if (Cfg.Quiet) {
+    qout.set(!Cfg.Quiet);
+    qout << Cfg.Size << " " << SecFmt{Bench.EvtStats.Median} << "\n";
+    qout.set(Cfg.Quiet);
+  }
+}
+
 template <typename BitonicChildT> void test_sequence(int argc, char **argv) {
   try {
-    auto Cfg = bitonicsort::read_config(argc, argv);
+    options::Parser OptParser;
+    bitonicsort::add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return bitonicsort::read_config(Parser, argv[0]);
+    });
     auto Q = set_queue();
     qout << "Welcome to bitonic sort\n";
-    qout << "Using vector size = " << (1 << Cfg.Size) << "\n";
     print_info(qout, Q.get_device());
 
-    using Ty = typename BitonicChildT::type;
-    BitonicChildT BitonicSort{Q, Cfg};
-    BitonicSortTester<Ty> Tester{BitonicSort, Cfg};
-
-    qout << "Initializing\n";
-    Tester.initialize();
-
-    if (Cfg.Vis) {
-      qout << "Before sort:\n";
-      visualize_seq(Tester.begin(), Tester.end(), qout);
-    }
-
-#ifdef MEASURE_NORMAL
-    BitonicSortHost<Ty> BitonicSortH{Q}; // Q unused for this derived class
-    BitonicSortTester<Ty> TesterH{BitonicSortH, Cfg};
-    TesterH.assign(Tester.begin(), Tester.end());
-    auto ElapsedH = TesterH.calculate();
-    qout << "Measured host time: " << ElapsedH.first << "\n";
-    if (Cfg.Vis) {
-      qout << "After sort (host):\n";
-      visualize_seq(TesterH.begin(), TesterH.end(), qout);
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      dump_sweep_point(I, Cfgs.size());
+      reseed(Cfgs[I].Bench);
+      single_bitonic_sequence<BitonicChildT>(Q, Cfgs[I]);
     }
-#endif
-
-    qout << "Calculating\n";
-    auto Elapsed = Tester.calculate();
+  } catch (sycl::exception const &err) {
+    std::cerr << "SYCL ERROR: " << err.what() << "\n";
+    std::terminate();
+  } catch (std::exception const &err) {
+    std::cerr << "Exception: " << err.what() << "\n";
+    std::terminate();
+  } catch (...) {
+    std::cerr << "Unknown error\n";
+    std::terminate();
+  }
+  qout << "Everything is correct\n";
+}
 
-    if (Cfg.Vis) {
-      qout << "After sort:\n";
-      visualize_seq(Tester.begin(), Tester.end(), qout);
-    }
+namespace bitonicsort {
 
-#ifdef VERIFY
-    if (!std::is_sorted(Tester.begin(), Tester.end())) {
-      std::cerr << "Sorting failed\n";
-      std::terminate();
-    }
-// we may also check with host results
-#ifdef MEASURE_NORMAL
-    auto MisPoint =
-        std::mismatch(TesterH.begin(), TesterH.end(), Tester.begin());
-    if (MisPoint.first != TesterH.end()) {
-      ptrdiff_t I = std::distance(MisPoint.first, TesterH.begin());
-      std::cerr << "Mismatch at: " << I << std::endl;
-      std::cerr << *MisPoint.first << " vs " << *MisPoint.second << std::endl;
-      throw std::runtime_error("Mismath");
-    }
-#endif
-#endif
-    qout << "Measured time: " << Elapsed.first / msec_per_sec << "\n";
+template <typename T> using Registry = VariantRegistry<BitonicSort<T>, Config>;
 
-    auto ExecTime = Elapsed.second / nsec_per_sec;
-    qout << "Pure execution time: " << ExecTime << "\n";
+// sycl_bench sequence: requested variants (all if empty) on same input
+template <typename Ty>
+void bench_sequence(int argc, char **argv,
+                    const std::vector<std::string> &Requested) {
+  try {
+    auto Names = Registry<Ty>::instance().select(Requested);
+    options::Parser OptParser;
+    add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return read_config(Parser, argv[0]);
+    });
+    auto Q = set_queue();
+    qout << "Welcome to bitonic sort\n";
+    print_info(qout, Q.get_device());
 
-    // Quiet mode output: size, elapsed time
-    if (Cfg.Quiet) {
-      qout.set(!Cfg.Quiet);
-      qout << Cfg.Size << " " << ExecTime << "\n";
-      qout.set(Cfg.Quiet);
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      auto &Cfg = Cfgs[I];
+      dump_sweep_point(I, Cfgs.size());
+      qout << "Using vector size = " << (1 << Cfg.Size) << "\n";
+      preflight(Q.get_device(), footprint<Ty>(Cfg));
+      qout << "Initializing\n";
+      reseed(Cfg.Bench);
+      auto Input = bitonic_input<Ty>(Q, Cfg);
+      auto HostRef = bitonic_reference(Q, Cfg, Input);
+
+      VariantResults Results;
+      for (auto &&Name : Names) {
+        qout << "Variant: " << Name << "\n";
+        auto VCfg = Cfg;
+        VCfg.Bench.Program = Name;
+        tune_bitonic_variant<Ty>(
+            Q, VCfg,
+            [&](const Config &C) {
+              return Registry<Ty>::instance().create(Name, Q, C);
+            },
+            Input);
+        auto Sorter = Registry<Ty>::instance().create(Name, Q, VCfg);
+        auto Bench = bench_bitonic_variant<Ty>(
+            Q, VCfg, *Sorter, Input,
+            HostRef.empty() ? nullptr : HostRef.data());
+        if (Cfg.Quiet) {
+          qout.set(!Cfg.Quiet);
+          qout << Name << " " << Cfg.Size << " "
+               << SecFmt{Bench.EvtStats.Median} << "\n";
+          qout.set(Cfg.Quiet);
+        }
+        Results.emplace_back(Name, Bench);
+      }
+      dump_comparison(qout, Results);
     }
   } catch (sycl::exception const &err) {
     std::cerr << "SYCL ERROR: " << err.what() << "\n";
@@ -272,4 +475,17 @@ template <typename BitonicChildT> void test_sequence(int argc, char **argv) {
   qout << "Everything is correct\n";
 }
 
+// used through REGISTER_VARIANT(bitonicsort, "name", Class)
+template <typename BitonicChildT> bool register_variant(std::string Name) {
+  using Ty = typename BitonicChildT::type;
+  auto Variants = [] { return Registry<Ty>::instance().names(); };
+  FamilyRegistry::instance().add("bitonicsort", {bench_sequence<Ty>, Variants});
+  return Registry<Ty>::instance().add(
+      Name, [](sycl::queue &Q, const Config &Cfg) {
+        return std::make_unique<BitonicChildT>(Q, Cfg);
+      });
+}
+
+} // namespace bitonicsort
+
 } // namespace sycltesters
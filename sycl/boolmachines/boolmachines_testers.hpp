@@ -21,6 +21,9 @@
 // -novis : switch off visualization
 // -quiet : measurement (quiet) mode
 // -detailed : detailed report from event
+// -reps=<n>, -warmup=<w> : measured and warmup runs (see testers.hpp)
+//   every run is one more step of machine
+// numeric options may be lists or ranges: -lsz=8,16,32
 //
 // Machine format:
 // E0 F1 2C ... 13 (64 bytes, 512 bits, 3x3 boolean function)
@@ -96,11 +99,10 @@ struct Config {
   int LocSz, ImW, ImH;
   std::string BoolMachinePath, ImagePath;
   Starting InitType;
+  BenchConfig Bench;
 };
 
-inline Config read_config(int argc, char **argv) {
-  Config Cfg;
-  options::Parser OptParser;
+inline void add_options(options::Parser &OptParser) {
   OptParser.template add<int>("imw", DEF_IMW, "image width");
   OptParser.template add<int>("imh", DEF_IMH, "image height");
   OptParser.template add<std::string>("img", "", "image file to apply machine or (randboxes | dots | singledot)");
@@ -113,7 +115,13 @@ inline Config read_config(int argc, char **argv) {
   OptParser.template add<int>("novis", DEF_NOVIS,
                               "disable graphic visualization");
   OptParser.template add<int>("quiet", DEF_QUIET, "quiet mode for bulk runs");
-  OptParser.parse(argc, argv);
+  add_bench_options(OptParser);
+}
+
+// for currently selected sweep point
+inline Config read_config(const options::Parser &OptParser,
+                          std::string Program) {
+  Config Cfg;
 
   Cfg.ImW = OptParser.template get<int>("imw");
   Cfg.ImH = OptParser.template get<int>("imh");
@@ -134,6 +142,7 @@ inline Config read_config(int argc, char **argv) {
   Cfg.Detailed = OptParser.exists("detailed");
   Cfg.Visualize = !OptParser.exists("novis");
   Cfg.Quiet = OptParser.exists("quiet");
+  Cfg.Bench = read_bench_options(OptParser, Program);
 
   if (Cfg.Quiet) {
     Cfg.Visualize = false; // quiet implies novis of course
@@ -158,6 +167,20 @@ inline void dump_config_info(Config &Cfg) {
     qout << "Screen visualization\n";
 }
 
+inline void record_config(const Config &Cfg, ResultRecord &Rec) {
+  Rec.add("config", "lsz", Cfg.LocSz);
+  Rec.add("config", "width", Cfg.ImW);
+  Rec.add("config", "height", Cfg.ImH);
+  Rec.add("config", "machine", Cfg.RandMachine ? "" : Cfg.BoolMachinePath);
+  Rec.add("config", "img", Cfg.ImagePath);
+  Rec.add("config", "init", static_cast<int>(Cfg.InitType));
+}
+
+// table lookup per cell: only machine field traffic counted
+inline WorkCount work_count(int ImW, int ImH) {
+  return {0, double(ImW) * ImH * sizeof(MachineCellTy) * 2};
+}
+
 class BoolMachineTy {
 public:
   static constexpr int NELTS = 64;
@@ -377,7 +400,7 @@ public:
     Disp.display(ResImg);
   }
 
-  using CalcDataTy = std::pair<unsigned, unsigned long long>;
+  using CalcDataTy = Timing_t;
 
   // Double buffering. Next calculation uses buffer from previous one.
   CalcDataTy calculate(boolmachine::BoolMachineTy &BM) {
@@ -404,89 +427,107 @@ public:
 template <typename BoolMachineChildT>
 void test_sequence(int argc, char **argv) {
   try {
-    auto Cfg = boolmachine::read_config(argc, argv);
+    options::Parser OptParser;
+    boolmachine::add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return boolmachine::read_config(Parser, argv[0]);
+    });
     qout << "Welcome to image boolmachineing!\n";
-    dump_config_info(Cfg);
     auto Q = set_queue();
     print_info(qout, Q.get_device());
 
-    boolmachine::BoolMachineTy BM = boolmachine::init_boolmachine(Cfg);
-    boolmachine::check_device_props(Q.get_device(), Cfg, BM);
+    for (size_t Pt = 0; Pt < Cfgs.size(); ++Pt) {
+      auto &Cfg = Cfgs[Pt];
+      dump_sweep_point(Pt, Cfgs.size());
+      dump_config_info(Cfg);
+
+      reseed(Cfg.Bench);
+      boolmachine::BoolMachineTy BM = boolmachine::init_boolmachine(Cfg);
+      boolmachine::check_device_props(Q.get_device(), Cfg, BM);
 
 #if defined(MEASURE_NORMAL)
-    qout << "Calculating host\n";
-    BoolMachineHost BoolMachineHost{Q}; // arg unused
-    BoolMachineTester TesterH{BoolMachineHost, Cfg};
-    auto ElapsedH = TesterH.calculate(BM);
-    qout << "Measured host time: " << ElapsedH.first / msec_per_sec << "\n";
+      qout << "Calculating host\n";
+      BoolMachineHost BoolMachineHost{Q}; // arg unused
+      BoolMachineTester TesterH{BoolMachineHost, Cfg};
+      measure_host(Cfg.Bench, [&] { return TesterH.calculate(BM); });
 #endif
 
-    BoolMachineChildT BoolMachineGPU{Q, Cfg};
-    BoolMachineTester Tester{BoolMachineGPU, Cfg};
-    qout << "Calculating GPU\n";
-    auto Elapsed = Tester.calculate(BM);
-    qout << "Measured time: " << Elapsed.first / msec_per_sec << "\n";
-    auto ExecTime = Elapsed.second / nsec_per_sec;
-    qout << "Pure execution time: " << ExecTime << "\n";
-
-    // Quiet mode output: image size, elapsed time
-    if (Cfg.Quiet) {
-      qout.set(!Cfg.Quiet);
-      qout << Tester.width() << " " << ExecTime << "\n";
-      qout.set(Cfg.Quiet);
-    }
+      BoolMachineChildT BoolMachineGPU{Q, Cfg};
+      BoolMachineTester Tester{BoolMachineGPU, Cfg};
+      qout << "Calculating GPU\n";
+      auto Bench = run_bench(Cfg.Bench, [&] { return Tester.calculate(BM); });
+      attach_work(Q, Cfg.Bench, Bench,
+                  boolmachine::work_count(Tester.width(), Tester.height()));
+      qout << "Measured time: " << SecFmt{Bench.WallStats.Median} << "\n";
+      auto ExecTime = Bench.EvtStats.Median;
+      qout << "Pure execution time: " << SecFmt{ExecTime} << "\n";
+      dump_bench(qout, Bench);
+      report_result("boolmachine", Cfg, Q.get_device(), Bench);
+
+      // Quiet mode output: image size, elapsed time
+      if (Cfg.Quiet) {
+        qout.set(!Cfg.Quiet);
+        qout << Tester.width() << " " << SecFmt{ExecTime} << "\n";
+        qout.set(Cfg.Quiet);
+      }
 
 #if defined(MEASURE_NORMAL) && defined(VERIFY)
-// TODO: check here
+      // every run is one more step, host made exactly one
+      if (Cfg.Bench.Reps + Cfg.Bench.Warmup == 1)
+        check_result("boolmachine", TesterH.data(), Tester.data(),
+                     size_t(Tester.width()) * Tester.height(), Cfg.Bench);
+      else
+        qout << "Verification skipped: more than one step done\n";
 #endif
 
-    if (Cfg.Visualize) {
+      if (Cfg.Visualize) {
 #if defined(SHOW_ORIG)
-      cimg_library::CImgDisplay MainDisp(Image, "BoolMachine image source");
+        cimg_library::CImgDisplay MainDisp(Image, "BoolMachine image source");
 #endif
 #if defined(MEASURE_NORMAL)
-      cimg_library::CImgDisplay ResDispH(TesterH.width(), TesterH.height(),
-                                         "BoolMachine host result", 0);
-      TesterH.disp_dst(ResDispH);
+        cimg_library::CImgDisplay ResDispH(TesterH.width(), TesterH.height(),
+                                           "BoolMachine host result", 0);
+        TesterH.disp_dst(ResDispH);
 #endif
-      cimg_library::CImgDisplay ResDisp(Tester.width(), Tester.height(),
-                                        "BoolMachine image result", 0);
-      Tester.disp_dst(ResDisp);
-      while (!ResDisp.is_closed()) {
-        cimg_library::cimg::wait(50);
-        bool Updated = false;
-        // key down for one calcualtion
-        if (ResDisp.is_keyARROWDOWN()) {
-          Tester.calculate(BM);
-          Updated = true;
-        }
-        // 'r' for bool machine re-generate
-        // image also re-inited
-        if (ResDisp.is_key(cimg_library::cimg::keyR)) {
-          BM = boolmachine::init_boolmachine(Cfg);
-          Tester.reinit();
-          Tester.calculate(BM);
-          Updated = true;
-        }
-        // 'i' for image reload with same machine
-        if (ResDisp.is_key(cimg_library::cimg::keyI)) {
-          Tester.reinit();
-          Tester.calculate(BM);
-          Updated = true;
-        }
-        // 'f' for 'fast forward'
-        if (ResDisp.is_key(cimg_library::cimg::keyF)) {
-          for (int I = 0; I < boolmachine::FF_ITER_COUNT; ++I)
+        cimg_library::CImgDisplay ResDisp(Tester.width(), Tester.height(),
+                                          "BoolMachine image result", 0);
+        Tester.disp_dst(ResDisp);
+        while (!ResDisp.is_closed()) {
+          cimg_library::cimg::wait(50);
+          bool Updated = false;
+          // key down for one calcualtion
+          if (ResDisp.is_keyARROWDOWN()) {
             Tester.calculate(BM);
-          Updated = true;
-        }
-        if (Updated) {
-          Tester.disp_dst(ResDisp);
-          ResDisp.flush();
+            Updated = true;
+          }
+          // 'r' for bool machine re-generate
+          // image also re-inited
+          if (ResDisp.is_key(cimg_library::cimg::keyR)) {
+            BM = boolmachine::init_boolmachine(Cfg);
+            Tester.reinit();
+            Tester.calculate(BM);
+            Updated = true;
+          }
+          // 'i' for image reload with same machine
+          if (ResDisp.is_key(cimg_library::cimg::keyI)) {
+            Tester.reinit();
+            Tester.calculate(BM);
+            Updated = true;
+          }
+          // 'f' for 'fast forward'
+          if (ResDisp.is_key(cimg_library::cimg::keyF)) {
+            for (int I = 0; I < boolmachine::FF_ITER_COUNT; ++I)
+              Tester.calculate(BM);
+            Updated = true;
+          }
+          if (Updated) {
+            Tester.disp_dst(ResDisp);
+            ResDisp.flush();
+          }
         }
       }
     }
-
   } catch (sycl::exception const &err) {
     std::cerr << "SYCL ERROR: " << err.what() << "\n";
     abort();
@@ -30,6 +30,9 @@ endif()
 if(INORD)
   target_compile_definitions(${KERNEL} PRIVATE INORD=1)
 endif()
+if(USE_SYCL_GRAPH)
+  target_compile_definitions(${KERNEL} PRIVATE USE_SYCL_GRAPH=1)
+endif()
 if(MEASURE_NORMAL)
   target_compile_definitions(${KERNEL} PRIVATE MEASURE_NORMAL=1)
 endif()
@@ -4,6 +4,7 @@
 #
 # buildv function: builds kernel executable with some additional defines
 # expect 2-4 arguments: target source [define] [define]
+# source may be list of sources (as for sycl_bench driver)
 #
 #------------------------------------------------------------------------------
 #
@@ -34,7 +35,9 @@ endif()
 if(USE_CIMG)
   target_link_libraries(${KERNEL} jpeg)
 endif()
-if(DUMP_SPIRV)
+# spirv dump goes to single file, so only for single source targets
+list(LENGTH SRC NSRC)
+if(DUMP_SPIRV AND NSRC EQUAL 1)
   # object library to prevent linking
   add_library(${KSPV} OBJECT ${SRC})
   target_compile_options(${KSPV} PUBLIC "-fsycl" "-fsycl-device-only" "-fno-sycl-use-bitcode" "-fsycl-unnamed-lambda" "-o" "${KERNEL}.spv")
@@ -0,0 +1,27 @@
+#------------------------------------------------------------------------------
+#
+# CMake script for negative tests: runs EXE with ARGS (space separated) and
+# passes only if it fails with output matching EXPECT
+# testers abort on errors, so WILL_FAIL can not be used for them
+#
+# cmake -DEXE=<exe> -DARGS=<args> -DEXPECT=<regex> -P expect_fail.cmake
+#
+#------------------------------------------------------------------------------
+#
+# This file is licensed after LGPL v3
+# Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+#
+#------------------------------------------------------------------------------
+
+separate_arguments(ARGS)
+execute_process(COMMAND ${EXE} ${ARGS}
+                RESULT_VARIABLE Res
+                OUTPUT_VARIABLE Out
+                ERROR_VARIABLE Out)
+
+if(Res EQUAL 0)
+  message(FATAL_ERROR "Expected failure, but run succeeded:\n${Out}")
+endif()
+if(NOT Out MATCHES "${EXPECT}")
+  message(FATAL_ERROR "Failed without expected \"${EXPECT}\":\n${Out}")
+endif()
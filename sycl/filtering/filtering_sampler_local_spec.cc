@@ -90,16 +90,10 @@ public:
     using ImWriteTy = sycl::accessor<sycl::float4, 2, sycl_write, sycl_image>;
     using LTy = sycl::accessor<sycl::float4, 2, sycl_read_write, sycl_local>;
 
-    sycl::kernel_id KId = sycl::get_kernel_id<filter_2d_local_spec>();
-    sycl::kernel_bundle KbSrc =
-        sycl::get_kernel_bundle<sycl::bundle_state::input>(
-            DeviceQueue.get_context(), {KId});
-    KbSrc.template set_specialization_constant<HalfWidthC>(HalfWidth);
-    KbSrc.template set_specialization_constant<LMEMC>(LMEM);
-    KbSrc.template set_specialization_constant<LSZC>(LSZ);
-    KbSrc.template set_specialization_constant<ImWC>(ImW);
-    KbSrc.template set_specialization_constant<ImHC>(ImH);
-    sycl::kernel_bundle Kb = sycl::build(KbSrc);
+    // built once per filter and image sizes, then taken from cache
+    auto Kb = sycltesters::build_cached<filter_2d_local_spec, HalfWidthC, LMEMC,
+                                        LSZC, ImWC, ImHC>(
+        DeviceQueue, HalfWidth, LMEM, LSZ, ImW, ImH);
 
     auto Evt = DeviceQueue.submit([&](sycl::handler &Cgh) {
       Cgh.use_kernel_bundle(Kb);
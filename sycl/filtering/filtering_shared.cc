@@ -39,8 +39,10 @@ public:
     sycl::range<2> Dims(ImW, ImH);
 
     const int NumData = ImW * ImH;
-    sycl::float4 *OutPtr = malloc_shared<sycl::float4>(NumData, DeviceQueue);
-    sycl::float4 *InPtr = malloc_shared<sycl::float4>(NumData, DeviceQueue);
+    sycl::float4 *OutPtr =
+        sycltesters::pool_malloc_shared<sycl::float4>(NumData, DeviceQueue);
+    sycl::float4 *InPtr =
+        sycltesters::pool_malloc_shared<sycl::float4>(NumData, DeviceQueue);
     auto EvtCpyData = DeviceQueue.copy(SrcData, InPtr, NumData);
     ProfInfo.emplace_back(EvtCpyData, "Copy to device");
 
@@ -49,7 +51,8 @@ public:
     int HalfWidth = FiltSize / 2;
 
     // vectorize filter
-    sycl::float4 *FiltPtr = malloc_shared<sycl::float4>(DataSize, DeviceQueue);
+    sycl::float4 *FiltPtr =
+        sycltesters::pool_malloc_shared<sycl::float4>(DataSize, DeviceQueue);
     const float *FiltData = Filt.data();
     for (int I = 0; I < DataSize; ++I) {
       float FiltChannel = FiltData[I];
@@ -87,9 +90,9 @@ public:
     auto EvtCpyBack = DeviceQueue.copy(OutPtr, DstData, NumData, Evt);
     ProfInfo.emplace_back(EvtCpyBack, "Copy Back");
     DeviceQueue.wait();
-    sycl::free(InPtr, DeviceQueue);
-    sycl::free(OutPtr, DeviceQueue);
-    sycl::free(FiltPtr, DeviceQueue);
+    sycltesters::pool_free(InPtr, DeviceQueue);
+    sycltesters::pool_free(OutPtr, DeviceQueue);
+    sycltesters::pool_free(FiltPtr, DeviceQueue);
     return ProfInfo;
   }
 };
@@ -15,6 +15,9 @@
 // -novis : switch off visualization
 // -quiet : measurement (quiet) mode
 // -detailed : detailed report from event
+// -reps=<n>, -warmup=<w> : measured and warmup runs (see testers.hpp)
+// -tune : tune lsz for device, tuned lsz is default afterwards (tuner.hpp)
+// numeric options may be lists or ranges: -lsz=8,16,32
 //
 // Filter format:
 // N, K, x1, x2, .... xN*N
@@ -85,11 +88,10 @@ struct Config {
                  Quiet = false, LocOverflow = false;
   int LocSz, RandImSz, RandFiltSz;
   std::string ImagePath, FilterPath;
+  BenchConfig Bench;
 };
 
-inline Config read_config(int argc, char **argv) {
-  Config Cfg;
-  options::Parser OptParser;
+inline void add_options(options::Parser &OptParser) {
   OptParser.template add<std::string>("img", "", "image to apply filter");
   OptParser.template add<int>("randboxes", DEF_IMSZ, "random boxes image");
   OptParser.template add<std::string>("filt", "", "filter to apply");
@@ -100,7 +102,13 @@ inline Config read_config(int argc, char **argv) {
   OptParser.template add<int>("novis", DEF_NOVIS,
                               "disable graphic visualization");
   OptParser.template add<int>("quiet", DEF_QUIET, "quiet mode for bulk runs");
-  OptParser.parse(argc, argv);
+  add_bench_options(OptParser);
+}
+
+// for currently selected sweep point
+inline Config read_config(const options::Parser &OptParser,
+                          std::string Program) {
+  Config Cfg;
 
   Cfg.ImagePath = OptParser.template get<std::string>("img");
   Cfg.FilterPath = OptParser.template get<std::string>("filt");
@@ -110,6 +118,8 @@ inline Config read_config(int argc, char **argv) {
   Cfg.RandFiltSz = OptParser.template get<int>("randfilter");
   Cfg.RandImage = OptParser.exists("randboxes");
   Cfg.RandImSz = OptParser.template get<int>("randboxes");
+  Cfg.Bench = read_bench_options(OptParser, Program);
+  Cfg.Bench.Given = given_options(OptParser, {"lsz"});
   if (OptParser.exists("novis"))
     Cfg.Visualize = false;
   if (OptParser.exists("quiet")) {
@@ -138,6 +148,24 @@ inline void dump_config_info(Config &Cfg) {
     qout << "Screen visualization\n";
 }
 
+inline void record_config(const Config &Cfg, ResultRecord &Rec) {
+  Rec.add("config", "lsz", Cfg.LocSz);
+  Rec.add("config", "img", Cfg.RandImage ? "" : Cfg.ImagePath);
+  Rec.add("config", "filter", Cfg.RandFilter ? "" : Cfg.FilterPath);
+  if (Cfg.RandImage)
+    Rec.add("config", "randboxes", Cfg.RandImSz);
+  if (Cfg.RandFilter)
+    Rec.add("config", "randfilter", Cfg.RandFiltSz);
+}
+
+// multiply-add per filter element per channel, image read and written once
+inline WorkCount work_count(int ImW, int ImH, const drawer::Filter &Filt) {
+  double Pixels = double(ImW) * ImH;
+  double Area = Filt.sqrt_size() * Filt.sqrt_size();
+  return {Pixels * Area * 4 * 2,
+          Pixels * sizeof(sycl::float4) * 2 + Area * sizeof(float)};
+}
+
 inline void check_device_props(sycl::device D, Config &Cfg,
                                drawer::Filter &Filt) {
   if (!D.has(sycl::aspect::image))
@@ -171,6 +199,21 @@ inline void check_device_props(sycl::device D, Config &Cfg,
   }
 }
 
+// LocSz x LocSz work-groups, tile with filter halo in local memory
+// (same limits as in check_device_props, but overflow is not legal here)
+inline TuneSpace tune_space(sycl::device D, Config &Cfg,
+                            const drawer::Filter &Filt) {
+  auto Lim = device_limits(D);
+  int HalfWidth = Filt.sqrt_size() / 2;
+  auto Legal = [Lim, HalfWidth, &Cfg] {
+    size_t L = Cfg.LocSz;
+    size_t LocMem = L + HalfWidth * 2;
+    return L * L <= Lim.MaxWG &&
+           LocMem * LocMem * sizeof(sycl::float4) <= Lim.LocalMem;
+  };
+  return {{tune_param("lsz", Cfg.LocSz, pow2_candidates(2, 32))}, Legal};
+}
+
 inline drawer::Filter init_filter(filter::Config Cfg) {
   if (!Cfg.FilterPath.empty()) {
     qout << "Reading filter: " << Cfg.FilterPath << "\n";
@@ -275,7 +318,7 @@ public:
   FilterTester(Filter &Filt, filter::Config Cfg, int ImW, int ImH)
       : Filter_(Filt), Cfg_(Cfg), ImW_(ImW), ImH_(ImH), DstBuffer_(ImW * ImH) {}
 
-  using CalcDataTy = std::pair<unsigned, unsigned long long>;
+  using CalcDataTy = Timing_t;
   CalcDataTy calculate(sycl::float4 *SrcData, drawer::Filter &Filt) {
     Timer Tm;
     Tm.start();
@@ -297,77 +340,87 @@ FilterTester single_filter_sequence(sycl::queue &Q, filter::Config Cfg,
   qout << "Calculating host\n";
   FilterHost FilterHost{Q}; // arg unused
   FilterTester TesterH{FilterHost, Cfg, ImW, ImH};
-  auto ElapsedH = TesterH.calculate(SrcData, Filt);
-  qout << "Measured host time: " << ElapsedH.first / msec_per_sec << "\n";
+  measure_host(Cfg.Bench, [&] { return TesterH.calculate(SrcData, Filt); });
 #endif
 
   FilterChildT FilterGPU{Q, Cfg};
   FilterTester Tester{FilterGPU, Cfg, ImW, ImH};
   qout << "Calculating GPU\n";
-  auto Elapsed = Tester.calculate(SrcData, Filt);
-  qout << "Measured time: " << Elapsed.first / msec_per_sec << "\n";
-  auto ExecTime = Elapsed.second / nsec_per_sec;
-  qout << "Pure execution time: " << ExecTime << "\n";
+  auto Bench =
+      run_bench(Cfg.Bench, [&] { return Tester.calculate(SrcData, Filt); });
+  attach_work(Q, Cfg.Bench, Bench, filter::work_count(ImW, ImH, Filt));
+  qout << "Measured time: " << SecFmt{Bench.WallStats.Median} << "\n";
+  auto ExecTime = Bench.EvtStats.Median;
+  qout << "Pure execution time: " << SecFmt{ExecTime} << "\n";
+  dump_bench(qout, Bench);
+  report_result("filter", Cfg, Q.get_device(), Bench);
 
   // Quiet mode output: filter size, elapsed time
   if (Cfg.Quiet) {
     qout.set(!Cfg.Quiet);
-    qout << ImW << " " << ExecTime << "\n";
+    qout << ImW << " " << SecFmt{ExecTime} << "\n";
     qout.set(Cfg.Quiet);
   }
 
 #if defined(MEASURE_NORMAL) && defined(VERIFY)
-  auto *DataH = TesterH.data();
-  auto *DataG = Tester.data();
-  for (int Row = 0; Row < ImH; ++Row)
-    for (int Column = 0; Column < ImW; ++Column) {
-      sycl::float4 H = DataH[Row * ImW + Column];
-      sycl::float4 G = DataG[Row * ImW + Column];
-      if (!sycl::all(H - G < 0.0001f)) {
-        qout << "Mismatch at: (" << Column << ", " << Row << ")\n";
-        qout << "Host: [" << H[0] << ", " << H[1] << ", " << H[2] << ", "
-             << H[3] << "]\n";
-        qout << "GPU: [" << G[0] << ", " << G[1] << ", " << G[2] << ", " << G[3]
-             << "]\n";
-        throw std::runtime_error("Mismath");
-      }
-    }
+  // per channel: index I is pixel I / 4 (row-major), channel I % 4
+  auto *DataH = reinterpret_cast<const float *>(TesterH.data());
+  auto *DataG = reinterpret_cast<const float *>(Tester.data());
+  check_result("filter", DataH, DataG, size_t(ImW) * ImH * 4, Cfg.Bench,
+               Tolerance{0.0001, 0, 0});
 #endif
   return Tester;
 }
 
 template <typename FilterChildT> void test_sequence(int argc, char **argv) {
   try {
-    auto Cfg = filter::read_config(argc, argv);
+    options::Parser OptParser;
+    filter::add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return filter::read_config(Parser, argv[0]);
+    });
     qout << "Welcome to image filtering!\n";
-    dump_config_info(Cfg);
     auto Q = set_queue();
     print_info(qout, Q.get_device());
 
-    auto Image = filter::init_image(Cfg);
-    const auto ImW = Image.width();
-    const auto ImH = Image.height();
-    qout << "Range: " << ImW << " x " << ImH << "\n";
-    std::vector<sycl::float4> SrcBuffer(ImW * ImH);
-    drawer::img_to_float4(Image, SrcBuffer.data());
-    drawer::Filter Filt = filter::init_filter(Cfg);
-
-    filter::check_device_props(Q.get_device(), Cfg, Filt);
-
-    auto Tester = single_filter_sequence<FilterChildT>(Q, Cfg, SrcBuffer.data(),
-                                                       ImW, ImH, Filt);
-
-    // display source and result pictures
-    if (Cfg.Visualize) {
-      cimg_library::CImgDisplay MainDisp(Image, "Filtering image source");
-      cimg_library::CImgDisplay ResDisp(ImW, ImH, "Filtering image result", 0);
-
-      ImageTy ResImg(ImW, ImH, 1, 3, 255);
-      drawer::float4_to_img(Tester.data(), ResImg);
-      ResDisp.display(ResImg);
-
-      while (!MainDisp.is_closed())
-        cimg_library::cimg::wait(20);
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      auto &Cfg = Cfgs[I];
+      dump_sweep_point(I, Cfgs.size());
+      dump_config_info(Cfg);
+      reseed(Cfg.Bench);
+      auto Image = filter::init_image(Cfg);
+      const auto ImW = Image.width();
+      const auto ImH = Image.height();
+      qout << "Range: " << ImW << " x " << ImH << "\n";
+      std::vector<sycl::float4> SrcBuffer(ImW * ImH);
+      drawer::img_to_float4(Image, SrcBuffer.data());
+      drawer::Filter Filt = filter::init_filter(Cfg);
+
+      auto Space = filter::tune_space(Q.get_device(), Cfg, Filt);
+      tune_config(Q, Cfg.Bench, Space, [&] {
+        FilterChildT FilterGPU{Q, Cfg};
+        FilterTester Tester{FilterGPU, Cfg, ImW, ImH};
+        return Tester.calculate(SrcBuffer.data(), Filt);
+      });
+      filter::check_device_props(Q.get_device(), Cfg, Filt);
+
+      auto Tester = single_filter_sequence<FilterChildT>(
+          Q, Cfg, SrcBuffer.data(), ImW, ImH, Filt);
+
+      // display source and result pictures
+      if (Cfg.Visualize) {
+        cimg_library::CImgDisplay MainDisp(Image, "Filtering image source");
+        cimg_library::CImgDisplay ResDisp(ImW, ImH, "Filtering image result",
+                                          0);
+
+        ImageTy ResImg(ImW, ImH, 1, 3, 255);
+        drawer::float4_to_img(Tester.data(), ResImg);
+        ResDisp.display(ResImg);
+
+        while (!MainDisp.is_closed())
+          cimg_library::cimg::wait(20);
+      }
     }
   } catch (sycl::exception const &err) {
     std::cerr << "SYCL ERROR: " << err.what() << "\n";
@@ -0,0 +1,213 @@
+//------------------------------------------------------------------------------
+//
+// Performance baselines: store timing samples, compare later runs with them
+//
+// -savebase=<file> stores samples of every run (exec time, or measured
+// time if there are no events), keyed by device name, family, variant and
+// config.
+// -checkbase=<file> compares run with stored samples: run regressed if its
+// median is slower by more than -regress=<pct> percent and one-sided
+// Mann-Whitney test says slowdown is significant (p < BASE_ALPHA).
+// Regression is error, so test with -checkbase fails.
+//
+// Driver version is not in key: baseline saved with one compiler or driver
+// is meant to be checked with other one. Significance needs at least
+// BASE_MIN_SAMPLES samples on both sides, so use -reps (say -reps=10).
+//
+// File is text, one line per run, tab separated:
+//   <device>\t<family>\t<variant>\t<config>\t<samples>
+// Many testers may save to one file at once (ctest -jN): store takes lock
+// on <file>.lock, re-reads file under it and replaces it by rename.
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+#include "stats.hpp"
+#include "timers.hpp"
+
+namespace sycltesters {
+
+constexpr double DEF_REGRESS_PCT = 5.0;
+constexpr double BASE_ALPHA = 0.05;
+constexpr size_t BASE_MIN_SAMPLES = 5;
+
+// exclusive lock between processes, held while object lives;
+// lock file is created if missing and never removed
+class FileLock {
+#ifdef _WIN32
+  HANDLE File_ = INVALID_HANDLE_VALUE;
+#else
+  int Fd_ = -1;
+#endif
+
+public:
+  explicit FileLock(const std::string &FileName) {
+#ifdef _WIN32
+    File_ = CreateFileA(FileName.c_str(), GENERIC_READ | GENERIC_WRITE,
+                        FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                        OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    OVERLAPPED Ov = {};
+    if (File_ == INVALID_HANDLE_VALUE ||
+        !LockFileEx(File_, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD,
+                    &Ov)) {
+      if (File_ != INVALID_HANDLE_VALUE)
+        CloseHandle(File_);
+      throw std::runtime_error("Can not lock: " + FileName);
+    }
+#else
+    Fd_ = open(FileName.c_str(), O_RDWR | O_CREAT, 0644);
+    if (Fd_ < 0)
+      throw std::runtime_error("Can not lock: " + FileName);
+    while (flock(Fd_, LOCK_EX) != 0)
+      if (errno != EINTR) {
+        close(Fd_);
+        throw std::runtime_error("Can not lock: " + FileName);
+      }
+#endif
+  }
+
+  FileLock(const FileLock &) = delete;
+  FileLock &operator=(const FileLock &) = delete;
+
+  ~FileLock() {
+#ifdef _WIN32
+    OVERLAPPED Ov = {};
+    UnlockFileEx(File_, 0, MAXDWORD, MAXDWORD, &Ov);
+    CloseHandle(File_);
+#else
+    flock(Fd_, LOCK_UN);
+    close(Fd_);
+#endif
+  }
+};
+
+class BaselineStore {
+  using EntriesTy = std::map<std::string, std::vector<double>>;
+  std::string File_;
+  EntriesTy Entries_;
+
+  // missing file is no entries
+  static EntriesTy read_entries(const std::string &File) {
+    EntriesTy Entries;
+    std::ifstream Is{File};
+    std::string Line;
+    while (std::getline(Is, Line)) {
+      auto Pos = Line.rfind('\t');
+      if (Line.empty() || Pos == Line.npos)
+        continue;
+      std::istringstream Vals{Line.substr(Pos + 1)};
+      std::vector<double> Samples;
+      double V;
+      while (Vals >> V)
+        Samples.push_back(V);
+      Entries[Line.substr(0, Pos)] = std::move(Samples);
+    }
+    return Entries;
+  }
+
+public:
+  explicit BaselineStore(std::string File)
+      : File_(std::move(File)), Entries_(read_entries(File_)) {}
+
+  std::optional<std::vector<double>> find(const std::string &Key) const {
+    auto It = Entries_.find(Key);
+    if (It == Entries_.end())
+      return std::nullopt;
+    return It->second;
+  }
+
+  // replaces stored samples of Key, other entries are kept, including
+  // ones stored by other processes since this store was read
+  void store(const std::string &Key, const std::vector<double> &Samples) {
+    FileLock Lock{File_ + ".lock"};
+    Entries_ = read_entries(File_);
+    Entries_[Key] = Samples;
+    // readers without lock see either old or new file, never partial one
+    auto Tmp = File_ + ".tmp";
+    {
+      std::ofstream Os{Tmp};
+      if (!Os)
+        throw std::runtime_error("Can not write baseline file: " + Tmp);
+      Os.precision(12);
+      for (auto &&[K, Vals] : Entries_) {
+        Os << K << '\t';
+        for (auto V : Vals)
+          Os << V << ' ';
+        Os << '\n';
+      }
+      if (!Os)
+        throw std::runtime_error("Can not write baseline file: " + Tmp);
+    }
+    std::filesystem::rename(Tmp, File_);
+  }
+};
+
+struct BaselineVerdict {
+  double BaseMedian = 0, Median = 0;
+  double PValue = 1;
+  bool Tested = false; // enough samples for significance test
+  bool Regressed = false;
+};
+
+inline BaselineVerdict compare_baseline(const std::vector<double> &Base,
+                                        const std::vector<double> &Samples,
+                                        double RegressPct) {
+  BaselineVerdict V;
+  V.BaseMedian = compute_stats(Base).Median;
+  V.Median = compute_stats(Samples).Median;
+  V.Tested =
+      Base.size() >= BASE_MIN_SAMPLES && Samples.size() >= BASE_MIN_SAMPLES;
+  if (!V.Tested)
+    return V;
+  V.PValue = mann_whitney_greater(Base, Samples);
+  V.Regressed = V.PValue < BASE_ALPHA &&
+                V.Median > V.BaseMedian * (1.0 + RegressPct / 100.0);
+  return V;
+}
+
+template <typename OsTy>
+OsTy &dump_verdict(OsTy &Os, const BaselineVerdict &V) {
+  Os << "Baseline: median " << SecFmt{V.BaseMedian} << " -> "
+     << SecFmt{V.Median};
+  if (V.BaseMedian > 0)
+    Os << " (" << std::showpos << (V.Median / V.BaseMedian - 1.0) * 100.0
+       << std::noshowpos << "%)";
+  if (!V.Tested) {
+    Os << ", too few samples to test (need " << BASE_MIN_SAMPLES << ")\n";
+    return Os;
+  }
+  Os << ", p = " << V.PValue << (V.Regressed ? ": REGRESSION" : ": ok")
+     << "\n";
+  return Os;
+}
+
+} // namespace sycltesters
@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------------
+//
+// Cache of executable kernel bundles for specialization constant variants
+//
+// Building bundle (get_kernel_bundle<input> -> set_specialization_constant
+// -> build) is JIT compilation, so doing it on every operator() call makes
+// repeated runs measure compiler. Cache keeps executable bundles within
+// process keyed by context, kernel and specialization values:
+//
+//   auto Kb = sycltesters::build_cached<mmult_spec<T>, AYC, BYC>(Q, AY, BY);
+//
+// Between processes DPC++ persistent cache does the job: see -kcache option
+// in testers.hpp, it is enabled before runtime initialization
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+#include "syclconst.hpp"
+
+namespace sycltesters {
+
+class BundleCache {
+  mutable std::mutex Mutex_;
+  // contexts are few (usually one): linear search is fine
+  std::vector<std::pair<sycl::context, std::map<std::string, EBundleTy>>>
+      Bundles_;
+  unsigned Hits_ = 0, Builds_ = 0;
+
+  std::map<std::string, EBundleTy> &bundles(const sycl::context &Ctx) {
+    for (auto &&[C, B] : Bundles_)
+      if (C == Ctx)
+        return B;
+    Bundles_.emplace_back(Ctx, std::map<std::string, EBundleTy>{});
+    return Bundles_.back().second;
+  }
+
+public:
+  // Build(IBundleTy &) sets specialization constants of input bundle,
+  // Key shall identify all values it sets
+  template <typename BuildF>
+  EBundleTy get(const sycl::context &Ctx, sycl::kernel_id KId,
+                const std::string &Key, BuildF Build) {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    auto &Bundles = bundles(Ctx);
+    std::string FullKey = std::string(KId.get_name()) + '\0' + Key;
+    auto It = Bundles.find(FullKey);
+    if (It != Bundles.end()) {
+      Hits_ += 1;
+      return It->second;
+    }
+    IBundleTy KbSrc =
+        sycl::get_kernel_bundle<sycl::bundle_state::input>(Ctx, {KId});
+    Build(KbSrc);
+    EBundleTy Kb = sycl::build(KbSrc);
+    Builds_ += 1;
+    Bundles.emplace(FullKey, Kb);
+    return Kb;
+  }
+
+  unsigned hits() const {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    return Hits_;
+  }
+
+  unsigned builds() const {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    return Builds_;
+  }
+};
+
+inline BundleCache &bundle_cache() {
+  static BundleCache Cache;
+  return Cache;
+}
+
+namespace detail {
+
+// raw bytes of value: specialization constants are trivially copyable
+template <typename T> void append_key(std::string &Key, const T &Val) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  char Bytes[sizeof(T)];
+  std::memcpy(Bytes, &Val, sizeof(T));
+  Key.append(Bytes, sizeof(T));
+}
+
+template <auto &SpecId>
+using spec_value_t =
+    typename std::remove_reference_t<decltype(SpecId)>::value_type;
+
+} // namespace detail
+
+// executable bundle for KernelName with SpecIds set to Vals (in order)
+template <typename KernelName, auto &...SpecIds, typename... ValTs>
+EBundleTy build_cached(sycl::queue &Q, ValTs... Vals) {
+  static_assert(sizeof...(SpecIds) == sizeof...(ValTs),
+                "Expect one value per specialization constant");
+  std::string Key;
+  (detail::append_key(Key, static_cast<detail::spec_value_t<SpecIds>>(Vals)),
+   ...);
+  return bundle_cache().get(
+      Q.get_context(), sycl::get_kernel_id<KernelName>(), Key,
+      [&](IBundleTy &KbSrc) {
+        (KbSrc.template set_specialization_constant<SpecIds>(
+             static_cast<detail::spec_value_t<SpecIds>>(Vals)),
+         ...);
+      });
+}
+
+// DPC++ persistent cache of built programs, shall be set up before first
+// runtime call; empty Dir leaves environment as is
+inline void enable_persistent_cache(const std::string &Dir) {
+  if (Dir.empty())
+    return;
+#ifdef _WIN32
+  _putenv_s("SYCL_CACHE_PERSISTENT", "1");
+  _putenv_s("SYCL_CACHE_DIR", Dir.c_str());
+#else
+  setenv("SYCL_CACHE_PERSISTENT", "1", 1);
+  setenv("SYCL_CACHE_DIR", Dir.c_str(), 1);
+#endif
+}
+
+} // namespace sycltesters
@@ -0,0 +1,266 @@
+//------------------------------------------------------------------------------
+//
+// Binary datasets: small header and raw array, loaded through mmap
+//
+// Layout (native byte order):
+//   DatasetHeader (64 bytes) : magic, version, element type, shape, seed
+//   Shape[0] * ... * Shape[Rank - 1] elements, row-major
+//
+// Dataset<T> maps file read-only and gives pointer into mapping, so input
+// of several GB is used without parsing or copying
+// Files are written by tools/gen_dataset or by write_dataset
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sycltesters {
+
+enum class DataType : std::uint32_t { Int32 = 1, Float32 = 2 };
+
+template <typename T> struct DataTypeOf;
+template <> struct DataTypeOf<int> {
+  static constexpr DataType value = DataType::Int32;
+};
+template <> struct DataTypeOf<float> {
+  static constexpr DataType value = DataType::Float32;
+};
+
+inline const char *data_type_name(DataType Type) {
+  switch (Type) {
+  case DataType::Int32:
+    return "int";
+  case DataType::Float32:
+    return "float";
+  }
+  return "unknown";
+}
+
+constexpr char DATASET_MAGIC[8] = {'S', 'Y', 'C', 'L', 'D', 'A', 'T', 'A'};
+constexpr std::uint32_t DATASET_VERSION = 1;
+constexpr int DATASET_MAX_RANK = 4;
+
+struct DatasetHeader {
+  char Magic[8];
+  std::uint32_t Version;
+  std::uint32_t Type; // DataType
+  std::uint32_t Rank;
+  std::uint32_t Reserved;
+  std::uint64_t Shape[DATASET_MAX_RANK]; // unused dimensions are 1
+  std::uint64_t Seed;                    // generator seed if generated
+
+  std::uint64_t elements() const {
+    std::uint64_t N = 1;
+    for (std::uint32_t I = 0; I < Rank; ++I)
+      N *= Shape[I];
+    return N;
+  }
+};
+
+// data starts right after header, aligned for all element types
+static_assert(sizeof(DatasetHeader) == 64);
+
+template <typename T>
+DatasetHeader make_dataset_header(const std::vector<std::uint64_t> &Shape,
+                                  std::uint64_t Seed = 0) {
+  if (Shape.empty() || Shape.size() > DATASET_MAX_RANK)
+    throw std::runtime_error("Dataset rank shall be 1 .. 4");
+  DatasetHeader Hdr{};
+  std::memcpy(Hdr.Magic, DATASET_MAGIC, sizeof(Hdr.Magic));
+  Hdr.Version = DATASET_VERSION;
+  Hdr.Type = static_cast<std::uint32_t>(DataTypeOf<T>::value);
+  Hdr.Rank = Shape.size();
+  for (std::size_t I = 0; I < DATASET_MAX_RANK; ++I)
+    Hdr.Shape[I] = (I < Shape.size()) ? Shape[I] : 1;
+  Hdr.Seed = Seed;
+  return Hdr;
+}
+
+inline void check_header(const DatasetHeader &Hdr, const std::string &Name) {
+  if (std::memcmp(Hdr.Magic, DATASET_MAGIC, sizeof(Hdr.Magic)) != 0)
+    throw std::runtime_error("Not a dataset file: " + Name);
+  if (Hdr.Version != DATASET_VERSION)
+    throw std::runtime_error("Unsupported dataset version: " + Name);
+  if (Hdr.Rank < 1 || Hdr.Rank > DATASET_MAX_RANK)
+    throw std::runtime_error("Wrong dataset rank: " + Name);
+}
+
+// header only: for configs to take sizes before data is mapped
+inline DatasetHeader read_dataset_header(const std::string &FileName) {
+  std::ifstream Is{FileName, std::ios::binary};
+  if (!Is.is_open())
+    throw std::runtime_error("Can not open dataset: " + FileName);
+  DatasetHeader Hdr;
+  if (!Is.read(reinterpret_cast<char *>(&Hdr), sizeof(Hdr)))
+    throw std::runtime_error("Dataset too short: " + FileName);
+  check_header(Hdr, FileName);
+  return Hdr;
+}
+
+// header and elements in one go, for big data see tools/gen_dataset
+template <typename T>
+void write_dataset(const std::string &FileName, const DatasetHeader &Hdr,
+                   const T *Data) {
+  std::ofstream Os{FileName, std::ios::binary};
+  if (!Os.is_open())
+    throw std::runtime_error("Can not create dataset: " + FileName);
+  Os.write(reinterpret_cast<const char *>(&Hdr), sizeof(Hdr));
+  Os.write(reinterpret_cast<const char *>(Data), Hdr.elements() * sizeof(T));
+  if (!Os)
+    throw std::runtime_error("Write failed: " + FileName);
+}
+
+// read-only mapping of whole file
+class MappedFile {
+  const char *Ptr_ = nullptr;
+  std::size_t Size_ = 0;
+#ifdef _WIN32
+  HANDLE File_ = INVALID_HANDLE_VALUE, Mapping_ = nullptr;
+#endif
+
+  void release() noexcept {
+#ifdef _WIN32
+    if (Ptr_)
+      UnmapViewOfFile(Ptr_);
+    if (Mapping_)
+      CloseHandle(Mapping_);
+    if (File_ != INVALID_HANDLE_VALUE)
+      CloseHandle(File_);
+#else
+    if (Ptr_)
+      munmap(const_cast<char *>(Ptr_), Size_);
+#endif
+  }
+
+public:
+  explicit MappedFile(const std::string &FileName) {
+#ifdef _WIN32
+    File_ = CreateFileA(FileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER Sz;
+    if (File_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(File_, &Sz)) {
+      release();
+      throw std::runtime_error("Can not open dataset: " + FileName);
+    }
+    Size_ = Sz.QuadPart;
+    Mapping_ = CreateFileMappingA(File_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (Mapping_)
+      Ptr_ = static_cast<const char *>(
+          MapViewOfFile(Mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!Ptr_) {
+      release();
+      throw std::runtime_error("Can not map dataset: " + FileName);
+    }
+#else
+    int Fd = open(FileName.c_str(), O_RDONLY);
+    struct stat St;
+    if (Fd < 0 || fstat(Fd, &St) != 0) {
+      if (Fd >= 0)
+        close(Fd);
+      throw std::runtime_error("Can not open dataset: " + FileName);
+    }
+    Size_ = St.st_size;
+    void *Ptr = mmap(nullptr, Size_, PROT_READ, MAP_PRIVATE, Fd, 0);
+    close(Fd); // mapping keeps file alive
+    if (Ptr == MAP_FAILED)
+      throw std::runtime_error("Can not map dataset: " + FileName);
+    Ptr_ = static_cast<const char *>(Ptr);
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&Rhs) noexcept
+      : Ptr_(std::exchange(Rhs.Ptr_, nullptr)),
+        Size_(std::exchange(Rhs.Size_, 0)) {
+#ifdef _WIN32
+    File_ = std::exchange(Rhs.File_, INVALID_HANDLE_VALUE);
+    Mapping_ = std::exchange(Rhs.Mapping_, nullptr);
+#endif
+  }
+  MappedFile &operator=(MappedFile &&) = delete;
+  ~MappedFile() { release(); }
+
+  const char *data() const { return Ptr_; }
+  std::size_t size() const { return Size_; }
+};
+
+// typed view of mapped dataset, element type shall match exactly
+template <typename T> class Dataset {
+  MappedFile File_;
+  const DatasetHeader *Hdr_;
+
+public:
+  explicit Dataset(const std::string &FileName) : File_(FileName) {
+    if (File_.size() < sizeof(DatasetHeader))
+      throw std::runtime_error("Dataset too short: " + FileName);
+    Hdr_ = reinterpret_cast<const DatasetHeader *>(File_.data());
+    check_header(*Hdr_, FileName);
+    if (Hdr_->Type != static_cast<std::uint32_t>(DataTypeOf<T>::value))
+      throw std::runtime_error(
+          "Dataset " + FileName + " has elements of type " +
+          data_type_name(static_cast<DataType>(Hdr_->Type)) + ", expected " +
+          data_type_name(DataTypeOf<T>::value));
+    if (File_.size() < sizeof(DatasetHeader) + Hdr_->elements() * sizeof(T))
+      throw std::runtime_error("Dataset truncated: " + FileName);
+  }
+
+  const DatasetHeader &header() const { return *Hdr_; }
+  const T *data() const {
+    return reinterpret_cast<const T *>(File_.data() + sizeof(DatasetHeader));
+  }
+  std::size_t size() const { return Hdr_->elements(); }
+};
+
+// input of tester: mapped dataset or array generated in memory
+template <typename T> class InputArray {
+  std::optional<Dataset<T>> Mapped_;
+  std::vector<T> Owned_;
+
+public:
+  explicit InputArray(std::vector<T> Data) : Owned_(std::move(Data)) {}
+  explicit InputArray(const std::string &FileName) : Mapped_(FileName) {}
+
+  const T *data() const { return Mapped_ ? Mapped_->data() : Owned_.data(); }
+  std::size_t size() const { return Mapped_ ? Mapped_->size() : Owned_.size(); }
+};
+
+// element count of 1D dataset checked to fit int sizes of configs
+template <typename T> int dataset_elements(const std::string &FileName) {
+  auto Hdr = read_dataset_header(FileName);
+  if (Hdr.Type != static_cast<std::uint32_t>(DataTypeOf<T>::value))
+    throw std::runtime_error("Dataset " + FileName + " expected to be of " +
+                             data_type_name(DataTypeOf<T>::value));
+  if (Hdr.elements() > static_cast<std::uint64_t>(INT32_MAX))
+    throw std::runtime_error("Dataset too big for this tester: " + FileName);
+  return static_cast<int>(Hdr.elements());
+}
+
+} // namespace sycltesters
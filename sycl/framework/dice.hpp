@@ -2,6 +2,13 @@
 //
 // Simplify work with randomness
 //
+// Counter-based generator (Philox4x32-10): value for element I of stream S
+// is pure function of (seed, S, I), so arrays are filled in parallel and
+// the same seed gives the same data in every run and every variant
+//
+// Every Dice and every rand_initialize call takes next stream, so with fixed
+// seed (-seed option, see testers.hpp) the whole sequence is reproducible
+//
 //------------------------------------------------------------------------------
 //
 // This file is licensed after LGPL v3
@@ -12,25 +19,140 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
 #include <random>
+#include <thread>
+#include <vector>
 
 namespace sycltesters {
 
-struct Dice {
-  std::uniform_int_distribution<int> Uid;
+using RandBlock = std::array<std::uint32_t, 4>;
+
+namespace detail {
+
+inline std::uint32_t mulhilo(std::uint32_t A, std::uint32_t B,
+                             std::uint32_t &Hi) {
+  std::uint64_t Prod = std::uint64_t{A} * B;
+  Hi = static_cast<std::uint32_t>(Prod >> 32);
+  return static_cast<std::uint32_t>(Prod);
+}
+
+// state is seed (key) and next stream number
+struct RandState {
+  std::atomic<std::uint64_t> Seed{std::random_device{}()};
+  std::atomic<std::uint32_t> Stream{0};
+};
+
+inline RandState &rand_state() {
+  static RandState State;
+  return State;
+}
+
+} // namespace detail
+
+// Philox4x32 with 10 rounds (Salmon et al, "Parallel random numbers: as easy
+// as 1, 2, 3"), constants as in Random123
+inline RandBlock philox4x32(RandBlock Ctr, std::uint64_t Seed) {
+  constexpr std::uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+  constexpr std::uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+  std::uint32_t K0 = static_cast<std::uint32_t>(Seed);
+  std::uint32_t K1 = static_cast<std::uint32_t>(Seed >> 32);
+  for (int Round = 0; Round < 10; ++Round) {
+    std::uint32_t Hi0, Hi1;
+    std::uint32_t Lo0 = detail::mulhilo(M0, Ctr[0], Hi0);
+    std::uint32_t Lo1 = detail::mulhilo(M1, Ctr[2], Hi1);
+    Ctr = {Hi1 ^ Ctr[1] ^ K0, Lo1, Hi0 ^ Ctr[3] ^ K1, Lo0};
+    K0 += W0;
+    K1 += W1;
+  }
+  return Ctr;
+}
+
+// block of random bits for element Idx of stream Stream
+inline RandBlock rand_block(std::uint64_t Seed, std::uint32_t Stream,
+                            std::uint64_t Idx) {
+  return philox4x32({static_cast<std::uint32_t>(Idx),
+                     static_cast<std::uint32_t>(Idx >> 32), Stream, 0},
+                    Seed);
+}
+
+// 32 random bits to [Min, Max] (multiply-shift, bias below 2^-32 * range)
+inline int uniform_int(std::uint32_t Bits, int Min, int Max) {
+  std::uint64_t Range = std::int64_t{Max} - Min + 1;
+  return static_cast<int>(Min + ((Bits * Range) >> 32));
+}
+
+// restarts stream numbering: same seed gives same sequence of datasets
+inline void set_seed(std::uint64_t Seed) {
+  detail::rand_state().Seed = Seed;
+  detail::rand_state().Stream = 0;
+}
+
+inline std::uint64_t get_seed() { return detail::rand_state().Seed; }
+
+inline std::uint32_t next_stream() {
+  return detail::rand_state().Stream.fetch_add(1);
+}
+
+// serial generator for small things, each Dice is separate stream
+class Dice {
+  std::uint64_t Seed_ = get_seed();
+  std::uint32_t Stream_ = next_stream();
+  std::uint64_t Idx_ = 0;
+  RandBlock Block_;
+  int Min_, Max_;
 
-  Dice(int Min, int Max) : Uid(Min, Max) {}
+public:
+  Dice(int Min, int Max) : Min_(Min), Max_(Max) {}
   int operator()() {
-    static std::random_device Rd;
-    static std::mt19937 Rng{Rd()};
-    return Uid(Rng);
+    // four values from every block
+    if ((Idx_ % 4) == 0)
+      Block_ = rand_block(Seed_, Stream_, Idx_ / 4);
+    return uniform_int(Block_[Idx_++ % 4], Min_, Max_);
   }
 };
 
+// fills [Begin, End) in parallel: element I is Gen(rand_block(.., First + I))
+// so big array may be generated piece by piece; random access iterators
+template <typename It, typename GenF>
+void parallel_generate_at(It Begin, It End, GenF Gen, std::uint64_t Seed,
+                          std::uint32_t Stream, std::uint64_t First) {
+  constexpr std::size_t MinChunk = 1 << 16;
+  const std::size_t Sz = std::distance(Begin, End);
+  auto Fill = [=](std::size_t From, std::size_t To) {
+    for (std::size_t I = From; I < To; ++I)
+      Begin[I] = Gen(rand_block(Seed, Stream, First + I));
+  };
+
+  std::size_t NThreads = std::max(1u, std::thread::hardware_concurrency());
+  NThreads = std::min(NThreads, Sz / MinChunk + 1);
+  if (NThreads == 1) {
+    Fill(0, Sz);
+    return;
+  }
+
+  std::vector<std::thread> Workers;
+  const std::size_t Chunk = (Sz + NThreads - 1) / NThreads;
+  for (std::size_t From = 0; From < Sz; From += Chunk)
+    Workers.emplace_back(Fill, From, std::min(From + Chunk, Sz));
+  for (auto &&W : Workers)
+    W.join();
+}
+
+// whole array from next stream
+template <typename It, typename GenF>
+void parallel_generate(It Begin, It End, GenF Gen) {
+  parallel_generate_at(Begin, End, Gen, get_seed(), next_stream(), 0);
+}
+
 template <typename It>
 void rand_initialize(It Begin, It End, int Min, int Max) {
-  Dice D(Min, Max);
-  std::generate(Begin, End, [&] { return D(); });
+  parallel_generate(Begin, End, [Min, Max](const RandBlock &R) {
+    return uniform_int(R[0], Min, Max);
+  });
 }
 
-} // namespace sycltesters
\ No newline at end of file
+} // namespace sycltesters
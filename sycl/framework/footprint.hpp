@@ -0,0 +1,128 @@
+//------------------------------------------------------------------------------
+//
+// Memory footprint: estimate before run, peak host RSS after run
+//
+// Family declares footprint of configuration (next to work_count): bytes
+// held on host (tester vectors, input, host reference) and on device
+// (buffers or USM of one variant run). preflight checks estimate against
+// global_mem_size, max_mem_alloc_size and available host memory, and
+// refuses configuration which will not fit instead of running into OOM:
+//
+//   preflight(Q.get_device(), sgemm::footprint<Ty>(Cfg));
+//
+// Buffer allocations are not visible to framework, so device side is
+// estimate; actually allocated USM is reported by pool (usmpool.hpp).
+// Peak RSS (VmHWM) is reset at start of measurement where kernel allows
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <CL/sycl.hpp>
+
+#include "qstream.hpp"
+#include "syclconst.hpp"
+
+namespace sycltesters {
+
+// part of global_mem_size left for runtime and driver
+constexpr double DEVICE_MEM_RESERVE = 0.1;
+
+// host reference keeps own copies of data (see MEASURE_NORMAL)
+#if defined(MEASURE_NORMAL)
+constexpr double HOST_REF_COPIES = 1;
+#else
+constexpr double HOST_REF_COPIES = 0;
+#endif
+
+struct Footprint {
+  double Host = 0;     // bytes
+  double Device = 0;   // bytes
+  double MaxAlloc = 0; // largest single device allocation
+};
+
+// bytes in MiB with two digits, stream format not affected
+struct MemFmt {
+  double Bytes;
+};
+
+inline std::ostream &operator<<(std::ostream &Os, MemFmt M) {
+  auto Flags = Os.flags();
+  auto Prec = Os.precision();
+  Os << std::fixed << std::setprecision(2) << M.Bytes / (1024.0 * 1024.0)
+     << " MiB";
+  Os.flags(Flags);
+  Os.precision(Prec);
+  return Os;
+}
+
+namespace detail {
+
+// "<Key>: <N> kB" line of /proc file, nullopt if not found
+inline std::optional<double> proc_kb_field(const char *File,
+                                           const std::string &Key) {
+  std::ifstream Is{File};
+  std::string Line;
+  while (std::getline(Is, Line))
+    if (Line.compare(0, Key.size() + 1, Key + ":") == 0) {
+      std::istringstream Fields{Line.substr(Key.size() + 1)};
+      double Kb;
+      if (Fields >> Kb)
+        return Kb * 1024.0;
+    }
+  return std::nullopt;
+}
+
+} // namespace detail
+
+// zero if unknown (not Linux)
+inline double peak_rss() {
+  return detail::proc_kb_field("/proc/self/status", "VmHWM").value_or(0);
+}
+
+// peak becomes current RSS, silently nothing if not supported
+inline void reset_peak_rss() {
+  std::ofstream Os{"/proc/self/clear_refs"};
+  if (Os)
+    Os << "5";
+}
+
+inline std::optional<double> available_host_memory() {
+  return detail::proc_kb_field("/proc/meminfo", "MemAvailable");
+}
+
+// throws if configuration does not fit
+inline void preflight(sycl::device D, const Footprint &Fp) {
+  double Global = D.template get_info<info::device::global_mem_size>();
+  double MaxAlloc = D.template get_info<info::device::max_mem_alloc_size>();
+  qout << "Footprint estimate: host " << MemFmt{Fp.Host} << ", device "
+       << MemFmt{Fp.Device} << " of " << MemFmt{Global} << "\n";
+  auto Refuse = [](std::string What, double Need, double Have) {
+    std::ostringstream Os;
+    Os << "Configuration does not fit: " << What << " needs " << MemFmt{Need}
+       << ", limit is " << MemFmt{Have};
+    throw std::runtime_error(Os.str());
+  };
+  if (Fp.Device > Global * (1.0 - DEVICE_MEM_RESERVE))
+    Refuse("device memory", Fp.Device, Global * (1.0 - DEVICE_MEM_RESERVE));
+  if (Fp.MaxAlloc > MaxAlloc)
+    Refuse("single allocation", Fp.MaxAlloc, MaxAlloc);
+  auto Avail = available_host_memory();
+  if (Avail && Fp.Host > *Avail)
+    Refuse("host memory", Fp.Host, *Avail);
+}
+
+} // namespace sycltesters
@@ -2,6 +2,9 @@
 //
 // Option parsing to use in testing system
 //
+// All values are kept as strings and converted on get, so numeric options
+// accept lists and ranges (see sweep.hpp) as non-boost version does
+//
 //------------------------------------------------------------------------------
 //
 // This file is licensed after LGPL v3
@@ -13,10 +16,16 @@
 
 #include <cassert>
 #include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 
 #include <boost/program_options.hpp>
 
+#include "sweep.hpp"
+
 namespace options {
 
 namespace po = boost::program_options;
@@ -30,25 +39,69 @@ class Parser final {
   bool quiet_ = false;
   bool parsed_ = false;
 
+  // name -> is numeric (may be swept)
+  std::map<std::string, bool> numeric_;
+
+  // values fixed by select for swept options
+  std::map<std::string, std::string> selected_;
+
+  template <typename T> static std::string to_string(const T &val) {
+    std::ostringstream os;
+    os << val;
+    return os.str();
+  }
+
+  std::string raw(const std::string &name) const {
+    auto it = selected_.find(name);
+    if (it != selected_.end())
+      return it->second;
+    return vm_[name].as<std::string>();
+  }
+
+  bool is_sweep(const std::string &name) const {
+    auto it = numeric_.find(name);
+    return it != numeric_.end() && it->second && !selected_.count(name) &&
+           is_sweep_value(vm_[name].as<std::string>());
+  }
+
 public:
   Parser() {
     desc_.add_options()("help", "Produce help message");
-    desc_.add_options()("size", po::value<int>()->default_value(0),
-                        "workload main size");
-    desc_.add_options()("nreps", po::value<int>()->default_value(0),
-                        "workload number of repetitions");
+    add<int>("size", 0, "workload main size");
+    add<int>("nreps", 0, "workload number of repetitions");
   }
 
   template <typename T>
   void add(std::string name, T defval, std::string description = "") {
     assert(!parsed_ && "Please do not add options after they are parsed");
-    desc_.add_options()(name.c_str(), po::value<T>()->default_value(defval),
+    auto defstr = to_string(defval);
+    desc_.add_options()(name.c_str(),
+                        po::value<std::string>()
+                            ->default_value(defstr)
+                            ->implicit_value(defstr),
                         description.c_str());
+    numeric_[name] = std::is_arithmetic_v<T>;
   }
 
   template <typename T> T get(std::string name) const {
     assert(parsed_ && "Please do not query options before they are parsed");
-    return vm_[name].as<T>();
+    if (is_sweep(name))
+      throw std::runtime_error("Option " + name +
+                               " is list or range, use sweep_points/select");
+    if constexpr (std::is_same_v<T, std::string>) {
+      return raw(name);
+    } else {
+      std::istringstream is{raw(name)};
+      T ret;
+      is >> ret;
+      return ret;
+    }
+  }
+
+  // option was given in command line
+  bool exists(std::string name) const {
+    assert(parsed_ && "Please do not query options before they are parsed");
+    return vm_.count(name) > 0 && !vm_[name].defaulted();
   }
 
   void parse(int argc, char **argv) {
@@ -63,9 +116,29 @@ public:
       std::cout << desc_ << std::endl;
       exit(0);
     }
+
+    for (auto &&[name, numeric] : numeric_)
+      if (is_sweep(name))
+        expand_values(raw(name)); // validate early
+  }
+
+  // all points of cartesian product of list/range options (sorted by name)
+  std::vector<SweepPoint> sweep_points() const {
+    std::vector<std::pair<std::string, std::vector<std::string>>> axes;
+    for (auto &&[name, numeric] : numeric_)
+      if (is_sweep(name))
+        axes.emplace_back(name, expand_values(raw(name)));
+    return cartesian(axes);
+  }
+
+  // fix swept options to given point, may be called many times
+  void select(const SweepPoint &point) {
+    assert(parsed_ && "Please do not select before options are parsed");
+    for (auto &&[name, val] : point)
+      selected_[name] = val;
   }
 
   bool parsed() const noexcept { return parsed_; }
 };
 
-} // namespace options
\ No newline at end of file
+} // namespace options
@@ -3,6 +3,9 @@
 // Option parsing to use in testing system
 // Alternative version (without boost)
 //
+// Numeric options accept lists and ranges (see sweep.hpp), such options
+// can not be queried before select() fixes them to one point of sweep
+//
 //------------------------------------------------------------------------------
 //
 // This file is licensed after LGPL v3
@@ -12,13 +15,17 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 
+#include "sweep.hpp"
+
 namespace options {
 
 // Basic information about option (except name)
@@ -26,6 +33,8 @@ struct ValDesc {
   std::string value;
   std::string description;
   bool exists;
+  bool numeric = false;
+  bool sweep = false; // list or range, not yet selected
 };
 
 // Option parser incapsulates logic. This is non-boost version.
@@ -35,6 +44,9 @@ class Parser final {
   // name -> value + description + exists
   std::unordered_map<std::string, ValDesc> Values_;
 
+  // options that were list or range before select
+  std::unordered_map<std::string, bool> Swept_;
+
   // process -help option and illegal cases
   void process_help_notfound(std::string Opt) {
     bool IsHelp = (Opt.find("help") != Opt.npos);
@@ -66,6 +78,7 @@ public:
     Desc.value = Os.str();
     Desc.description = Description;
     Desc.exists = false;
+    Desc.numeric = std::is_arithmetic_v<T>;
   }
 
   template <typename T> T get(std::string Name) const {
@@ -75,6 +88,9 @@ public:
     if (!Values_.count(Name))
       throw std::runtime_error("Option not present in list, use add");
     const auto &Desc = Values_.find(Name)->second;
+    if (Desc.sweep)
+      throw std::runtime_error("Option " + Name +
+                               " is list or range, use sweep_points/select");
     const auto &Val = Desc.value;
     std::istringstream Is{Val};
     T Ret;
@@ -109,9 +125,38 @@ public:
         Values_[Opt].value = Valview;
       }
     }
+    for (auto &&[Name, Desc] : Values_)
+      if (Desc.numeric && is_sweep_value(Desc.value)) {
+        expand_values(Desc.value); // validate early
+        Desc.sweep = true;
+      }
     Parsed_ = true;
   }
 
+  // all points of cartesian product of list/range options (sorted by name)
+  std::vector<SweepPoint> sweep_points() const {
+    std::vector<std::pair<std::string, std::vector<std::string>>> Axes;
+    for (auto &&[Name, Desc] : Values_)
+      if (Desc.sweep)
+        Axes.emplace_back(Name, expand_values(Desc.value));
+    std::sort(Axes.begin(), Axes.end());
+    return cartesian(Axes);
+  }
+
+  // fix swept options to given point, may be called many times
+  void select(const SweepPoint &Point) {
+    if (!Parsed_)
+      throw std::runtime_error("Please do not select before options parsed");
+    for (auto &&[Name, Val] : Point) {
+      auto &Desc = Values_.at(Name);
+      if (!Desc.sweep && !Swept_.count(Name))
+        throw std::runtime_error("Option " + Name + " is not swept");
+      Swept_[Name] = true;
+      Desc.value = Val;
+      Desc.sweep = false;
+    }
+  }
+
   bool parsed() const noexcept { return Parsed_; }
 };
 
@@ -0,0 +1,219 @@
+//------------------------------------------------------------------------------
+//
+// Hardware counters of host CPU around timed regions (Linux perf_event)
+//
+// Counts cycles, instructions, LLC and dTLB load misses and branch misses
+// of all threads of process: threads existing at start (say TBB workers of
+// CPU device) and threads created later. For CPU device kernel time is
+// host CPU time, so counters tell IPC and cache behaviour of variant:
+//
+//   PerfCounters Hw;
+//   Hw.start();
+//   ... region ...
+//   Hw.stop();
+//   dump_hw_counts(qout, Hw.read());
+//
+// Counters are unavailable on other systems, without kernel support or if
+// /proc/sys/kernel/perf_event_paranoid forbids them: then read() gives
+// counts with Valid unset and dump says so. Counters multiplexed by kernel
+// are scaled by enabled/running time.
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <cstring>
+#include <filesystem>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace sycltesters {
+
+enum HwEvent {
+  HW_CYCLES,
+  HW_INSTR,
+  HW_LLC_MISS,
+  HW_DTLB_MISS,
+  HW_BR_MISS,
+  HW_NUM_EVENTS
+};
+
+inline const char *hw_event_name(int E) {
+  static const char *Names[HW_NUM_EVENTS] = {
+      "cycles", "instructions", "llc_misses", "dtlb_misses", "branch_misses"};
+  return Names[E];
+}
+
+struct HwCounts {
+  std::array<std::uint64_t, HW_NUM_EVENTS> Values{};
+  std::array<bool, HW_NUM_EVENTS> Valid{};
+
+  bool any() const {
+    for (bool V : Valid)
+      if (V)
+        return true;
+    return false;
+  }
+
+  // per run average over Runs runs
+  HwCounts per_run(unsigned Runs) const {
+    HwCounts Ret = *this;
+    if (Runs > 1)
+      for (auto &&V : Ret.Values)
+        V /= Runs;
+    return Ret;
+  }
+};
+
+#if defined(__linux__)
+
+namespace detail {
+
+struct HwEventDesc {
+  std::uint32_t Type;
+  std::uint64_t Config;
+};
+
+inline HwEventDesc hw_event_desc(int E) {
+  constexpr auto LoadMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  switch (E) {
+  case HW_CYCLES:
+    return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+  case HW_INSTR:
+    return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+  case HW_LLC_MISS:
+    return {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | LoadMiss};
+  case HW_DTLB_MISS:
+    return {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | LoadMiss};
+  default:
+    return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+  }
+}
+
+// disabled counter of one event for thread Tid and threads it creates
+inline int open_counter(int E, pid_t Tid) {
+  perf_event_attr Attr;
+  std::memset(&Attr, 0, sizeof(Attr));
+  auto Desc = hw_event_desc(E);
+  Attr.size = sizeof(Attr);
+  Attr.type = Desc.Type;
+  Attr.config = Desc.Config;
+  Attr.disabled = 1;
+  Attr.inherit = 1;
+  Attr.exclude_kernel = 1;
+  Attr.exclude_hv = 1;
+  Attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(
+      syscall(SYS_perf_event_open, &Attr, Tid, -1, -1, 0));
+}
+
+inline std::vector<pid_t> process_threads() {
+  std::vector<pid_t> Tids;
+  std::error_code Ec;
+  for (auto &&Entry :
+       std::filesystem::directory_iterator{"/proc/self/task", Ec})
+    Tids.push_back(std::stoi(Entry.path().filename().string()));
+  if (Tids.empty())
+    Tids.push_back(0); // calling thread
+  return Tids;
+}
+
+} // namespace detail
+
+class PerfCounters {
+  // per event: counters of all threads
+  std::array<std::vector<int>, HW_NUM_EVENTS> Fds_;
+
+  void for_all(unsigned long Request) {
+    for (auto &&Fds : Fds_)
+      for (int Fd : Fds)
+        ioctl(Fd, Request, 0);
+  }
+
+public:
+  PerfCounters() {
+    // threads which exited meanwhile are just not counted
+    for (auto Tid : detail::process_threads())
+      for (int E = 0; E < HW_NUM_EVENTS; ++E) {
+        int Fd = detail::open_counter(E, Tid);
+        if (Fd >= 0)
+          Fds_[E].push_back(Fd);
+      }
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  ~PerfCounters() {
+    for (auto &&Fds : Fds_)
+      for (int Fd : Fds)
+        close(Fd);
+  }
+
+  void start() {
+    for_all(PERF_EVENT_IOC_RESET);
+    for_all(PERF_EVENT_IOC_ENABLE);
+  }
+
+  void stop() { for_all(PERF_EVENT_IOC_DISABLE); }
+
+  HwCounts read() const {
+    HwCounts Counts;
+    for (int E = 0; E < HW_NUM_EVENTS; ++E)
+      for (int Fd : Fds_[E]) {
+        std::uint64_t Buf[3]; // value, time enabled, time running
+        if (::read(Fd, Buf, sizeof(Buf)) != sizeof(Buf) || Buf[2] == 0)
+          continue;
+        double Scale = Buf[1] > Buf[2] ? double(Buf[1]) / Buf[2] : 1.0;
+        Counts.Values[E] += static_cast<std::uint64_t>(Buf[0] * Scale);
+        Counts.Valid[E] = true;
+      }
+    return Counts;
+  }
+};
+
+#else // no perf_event
+
+class PerfCounters {
+public:
+  void start() {}
+  void stop() {}
+  HwCounts read() const { return {}; }
+};
+
+#endif
+
+template <typename OsTy>
+OsTy &dump_hw_counts(OsTy &Os, const HwCounts &Counts,
+                     std::string What = "Host counters") {
+  Os << What << ":";
+  if (!Counts.any())
+    return Os << " unavailable (see perf_event_paranoid)\n";
+  for (int E = 0; E < HW_NUM_EVENTS; ++E)
+    if (Counts.Valid[E])
+      Os << " " << hw_event_name(E) << " = " << Counts.Values[E];
+  if (Counts.Valid[HW_CYCLES] && Counts.Valid[HW_INSTR] &&
+      Counts.Values[HW_CYCLES] > 0)
+    Os << ", IPC = "
+       << double(Counts.Values[HW_INSTR]) / Counts.Values[HW_CYCLES];
+  Os << "\n";
+  return Os;
+}
+
+} // namespace sycltesters
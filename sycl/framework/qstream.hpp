@@ -2,6 +2,12 @@
 //
 // Quietable stream
 //
+// Output is collected in buffer of writing thread and goes to std::cout in
+// bulk: when buffer is full, on flush (std::endl), at thread exit and before
+// any output to std::cout or std::cerr of same thread (they are tied to
+// qout), so order of lines is kept.
+// Quiet stream is in bad state: operator<< skips formatting altogether.
+//
 //------------------------------------------------------------------------------
 //
 // This file is licensed after LGPL v3
@@ -13,21 +19,68 @@
 
 #include <atomic>
 #include <iostream>
+#include <mutex>
+#include <string>
 
 namespace sycltesters {
 
 enum class QSState { Quiet = 0, Loud = 1 };
 
-// we need to have MT guarantees, because qout is shared global object
+constexpr size_t QSTREAM_BUFSZ = 1 << 16;
+
+// we need to have MT guarantees, because qout is shared global object:
+// there is no put area, every character goes to buffer of its thread, and
+// buffer goes to std::cout (under lock) by whole lines unless flushed, so
+// lines written by different threads never mix
 class QuietStream : private std::streambuf, public std::ostream {
   std::atomic<QSState> State_;
+  std::mutex FlushMutex_;
+
+  // pending output of one thread, written out when thread ends
+  struct ThreadBuf {
+    QuietStream *Owner = nullptr;
+    std::string Data;
+    ~ThreadBuf() {
+      if (Owner != nullptr && !Data.empty())
+        Owner->write_raw(Data.data(), Data.size());
+    }
+  };
+
+  // qout is only QuietStream, so one buffer per thread is enough
+  ThreadBuf &thread_buf() {
+    thread_local ThreadBuf Buf;
+    if (Buf.Owner == nullptr) {
+      Buf.Owner = this;
+      Buf.Data.reserve(QSTREAM_BUFSZ);
+    }
+    return Buf;
+  }
 
 public:
   QuietStream(QSState State = QSState::Loud)
-      : std::ostream(this), State_(State) {}
+      : std::ostream(this), State_(State) {
+    apply(State);
+    std::cout.tie(this);
+    std::cerr.tie(this);
+  }
+
+  QuietStream(const QuietStream &) = delete;
+  QuietStream &operator=(const QuietStream &) = delete;
+
+  // no sync here: thread buffers (of main thread too) are already written
+  // out, thread_local objects are destroyed before static ones
+  ~QuietStream() {
+    if (std::cout.tie() == this)
+      std::cout.tie(nullptr);
+    if (std::cerr.tie() == this)
+      std::cerr.tie(&std::cout);
+  }
+
   QSState state() const { return State_.load(); }
   QSState set(QSState State) {
+    sync(); // what was written loud goes out
     QSState Old = State_.exchange(State);
+    apply(State);
     return Old;
   }
 
@@ -37,15 +90,69 @@ public:
   }
 
 private:
+  // bad stream fails sentry, so nothing is formatted nor buffered
+  void apply(QSState State) {
+    if (State == QSState::Quiet)
+      setstate(std::ios::badbit);
+    else
+      clear();
+  }
+
+  // to buffer of std::cout directly: its sentry would flush qout again
+  void write_raw(const char *S, std::streamsize N) {
+    std::lock_guard<std::mutex> Lock{FlushMutex_};
+    std::cout.rdbuf()->sputn(S, N);
+  }
+
+  void write_out(ThreadBuf &Buf) {
+    write_raw(Buf.Data.data(), Buf.Data.size());
+    Buf.Data.clear();
+  }
+
+  // full buffer keeps its unfinished line, so lines of threads do not mix
+  void write_lines(ThreadBuf &Buf) {
+    auto Pos = Buf.Data.rfind('\n');
+    if (Pos == std::string::npos) {
+      write_out(Buf);
+      return;
+    }
+    write_raw(Buf.Data.data(), Pos + 1);
+    Buf.Data.erase(0, Pos + 1);
+  }
+
+  // single characters: without put area every sputc comes here
   int overflow(int c) override {
-    if (State_.load() == QSState::Loud) {
-      std::cout.put(c);
-      return 0;
+    if (c != std::streambuf::traits_type::eof()) {
+      char Ch = static_cast<char>(c);
+      xsputn(&Ch, 1);
+    }
+    return std::streambuf::traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char *S, std::streamsize N) override {
+    auto &Buf = thread_buf();
+    // large pieces go directly, bypassing buffer
+    if (N >= static_cast<std::streamsize>(QSTREAM_BUFSZ)) {
+      write_out(Buf);
+      write_raw(S, N);
+      return N;
     }
-    return c;
+    Buf.Data.append(S, N);
+    if (Buf.Data.size() >= QSTREAM_BUFSZ)
+      write_lines(Buf);
+    return N;
+  }
+
+  int sync() override {
+    auto &Buf = thread_buf();
+    if (!Buf.Data.empty())
+      write_out(Buf);
+    std::lock_guard<std::mutex> Lock{FlushMutex_};
+    std::cout.rdbuf()->pubsync();
+    return 0;
   }
 };
 
 inline QuietStream qout;
 
-} // namespace sycltesters
\ No newline at end of file
+} // namespace sycltesters
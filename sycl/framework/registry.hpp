@@ -0,0 +1,128 @@
+//------------------------------------------------------------------------------
+//
+// Variant registry: every variant registers itself by name in its family
+//
+//   REGISTER_VARIANT(sgemm, "matmult_local", MatrixMultLocalBuf<float>);
+//
+// Family (namespace inside sycltesters) provides register_variant<ChildT>
+// which adds factory to VariantRegistry and family entry to FamilyRegistry
+//
+// Variant sources compiled with -DSYCL_BENCH have no main and are linked
+// together into sycl_bench driver (see bench folder), which runs any subset
+// of variants of one family side by side on identical input and one queue
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+namespace sycltesters {
+
+// name -> factory for variants with common base and config
+template <typename BaseT, typename CfgT> class VariantRegistry {
+public:
+  using FactoryT =
+      std::function<std::unique_ptr<BaseT>(sycl::queue &, const CfgT &)>;
+
+private:
+  std::map<std::string, FactoryT> Factories_;
+  VariantRegistry() = default;
+
+public:
+  // function-local static: safe to use from static initializers
+  static VariantRegistry &instance() {
+    static VariantRegistry Registry;
+    return Registry;
+  }
+
+  bool add(std::string Name, FactoryT Factory) {
+    if (!Factories_.emplace(Name, std::move(Factory)).second)
+      throw std::logic_error("Variant registered twice: " + Name);
+    return true;
+  }
+
+  std::unique_ptr<BaseT> create(const std::string &Name, sycl::queue &Q,
+                                const CfgT &Cfg) const {
+    auto It = Factories_.find(Name);
+    if (It == Factories_.end())
+      throw std::runtime_error("Unknown variant: " + Name);
+    return It->second(Q, Cfg);
+  }
+
+  // sorted by name
+  std::vector<std::string> names() const {
+    std::vector<std::string> Ret;
+    for (auto &&Entry : Factories_)
+      Ret.push_back(Entry.first);
+    return Ret;
+  }
+
+  // all variants if nothing requested, fail early on unknown names
+  std::vector<std::string>
+  select(const std::vector<std::string> &Requested) const {
+    if (Requested.empty())
+      return names();
+    for (auto &&Name : Requested)
+      if (Factories_.count(Name) == 0)
+        throw std::runtime_error("Unknown variant: " + Name);
+    return Requested;
+  }
+};
+
+// driver entry for kernel family
+struct FamilyEntry {
+  // Run(argc, argv, variants): argv has only family options left
+  std::function<void(int, char **, const std::vector<std::string> &)> Run;
+  std::function<std::vector<std::string>()> Variants;
+};
+
+class FamilyRegistry {
+  std::map<std::string, FamilyEntry> Families_;
+  FamilyRegistry() = default;
+
+public:
+  static FamilyRegistry &instance() {
+    static FamilyRegistry Registry;
+    return Registry;
+  }
+
+  // every variant of family adds the same entry, first one is kept
+  void add(std::string Family, FamilyEntry Entry) {
+    Families_.emplace(std::move(Family), std::move(Entry));
+  }
+
+  const FamilyEntry *find(const std::string &Family) const {
+    auto It = Families_.find(Family);
+    return (It == Families_.end()) ? nullptr : &It->second;
+  }
+
+  std::vector<std::string> names() const {
+    std::vector<std::string> Ret;
+    for (auto &&Entry : Families_)
+      Ret.push_back(Entry.first);
+    return Ret;
+  }
+};
+
+} // namespace sycltesters
+
+#define SYCLTESTERS_CAT_(A, B) A##B
+#define SYCLTESTERS_CAT(A, B) SYCLTESTERS_CAT_(A, B)
+
+// variadic to allow commas in template arguments
+#define REGISTER_VARIANT(Family, Name, ...)                                    \
+  static const bool SYCLTESTERS_CAT(VariantRegistered_, __LINE__) =            \
+      sycltesters::Family::register_variant<__VA_ARGS__>(Name)
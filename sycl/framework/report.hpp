@@ -0,0 +1,216 @@
+//------------------------------------------------------------------------------
+//
+// Machine-readable results: one record per benchmark run
+//
+// Record consists of sections: "run" (family, program, ...), "device",
+// "config" (family-specific, see <family>::record_config), "wall" and
+// "exec" (timing statistics in seconds)
+//
+// Report file is appended, so many runs may go to one file:
+//   *.csv : CSV, header written when file is empty, raw samples omitted.
+//           Columns vary (family config, optional sections as -hwc), so
+//           row whose columns differ from header of file goes to first of
+//           <name>.1.csv, <name>.2.csv, ... which is empty or has same
+//           header: rows never shift under wrong columns
+//   other : JSON lines, one object per run with raw samples included
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+#include "stats.hpp"
+#include "syclconst.hpp"
+#include "trace.hpp"
+
+namespace sycltesters {
+
+class ResultRecord {
+  enum class Kind { Number, String, Array };
+
+  struct Field {
+    std::string Section, Key, Value;
+    Kind K;
+  };
+
+  std::vector<Field> Fields_;
+
+  static std::string csv_escape(const std::string &S) {
+    if (S.find_first_of(",\"\n") == S.npos)
+      return S;
+    std::string Ret = "\"";
+    for (char C : S) {
+      if (C == '"')
+        Ret += '"';
+      Ret += C;
+    }
+    return Ret + "\"";
+  }
+
+public:
+  template <typename T>
+  void add(std::string Section, std::string Key, const T &Val) {
+    if constexpr (std::is_same_v<T, bool>) {
+      Fields_.push_back({Section, Key, Val ? "true" : "false", Kind::Number});
+    } else if constexpr (std::is_arithmetic_v<T>) {
+      std::ostringstream Os;
+      Os.precision(12);
+      Os << Val;
+      Fields_.push_back({Section, Key, Os.str(), Kind::Number});
+    } else {
+      Fields_.push_back({Section, Key, std::string(Val), Kind::String});
+    }
+  }
+
+  void add_array(std::string Section, std::string Key,
+                 const std::vector<double> &Vals) {
+    std::ostringstream Os;
+    Os.precision(12);
+    Os << "[";
+    for (size_t I = 0; I < Vals.size(); ++I)
+      Os << (I ? "," : "") << Vals[I];
+    Os << "]";
+    Fields_.push_back({Section, Key, Os.str(), Kind::Array});
+  }
+
+  void add_stats(std::string Section, const SampleStats &Stats) {
+    add(Section, "count", Stats.Count);
+    add(Section, "min", Stats.Min);
+    add(Section, "max", Stats.Max);
+    add(Section, "mean", Stats.Mean);
+    add(Section, "median", Stats.Median);
+    add(Section, "p95", Stats.P95);
+    add(Section, "stddev", Stats.StdDev);
+  }
+
+  // "key=value key=value" of one section, say to identify config
+  std::string section(const std::string &Section) const {
+    std::string Ret;
+    for (auto &&F : Fields_)
+      if (F.Section == Section && F.K != Kind::Array)
+        Ret += (Ret.empty() ? "" : " ") + F.Key + "=" + F.Value;
+    return Ret;
+  }
+
+  // {"run":{...},"device":{...},...} in one line
+  void write_json(std::ostream &Os) const {
+    Os << "{";
+    for (size_t I = 0; I < Fields_.size(); ++I) {
+      const auto &F = Fields_[I];
+      bool NewSection = (I == 0) || (Fields_[I - 1].Section != F.Section);
+      if (NewSection)
+        Os << (I ? "}," : "") << "\"" << json_escape(F.Section) << "\":{";
+      else
+        Os << ",";
+      Os << "\"" << json_escape(F.Key) << "\":";
+      if (F.K == Kind::String)
+        Os << "\"" << json_escape(F.Value) << "\"";
+      else
+        Os << F.Value;
+    }
+    Os << (Fields_.empty() ? "}\n" : "}}\n");
+  }
+
+  // columns are section.key
+  void write_csv_header(std::ostream &Os) const {
+    bool First = true;
+    for (auto &&F : Fields_) {
+      if (F.K == Kind::Array)
+        continue;
+      Os << (First ? "" : ",") << csv_escape(F.Section + "." + F.Key);
+      First = false;
+    }
+    Os << "\n";
+  }
+
+  void write_csv_row(std::ostream &Os) const {
+    bool First = true;
+    for (auto &&F : Fields_) {
+      if (F.K == Kind::Array)
+        continue;
+      Os << (First ? "" : ",") << csv_escape(F.Value);
+      First = false;
+    }
+    Os << "\n";
+  }
+};
+
+inline void record_device(ResultRecord &Rec, sycl::device D) {
+  Rec.add("device", "name", D.template get_info<info::device::name>());
+  Rec.add("device", "version", D.template get_info<info::device::version>());
+  Rec.add("device", "vendor", D.template get_info<info::device::vendor>());
+  Rec.add("device", "driver",
+          D.template get_info<info::device::driver_version>());
+  Rec.add("device", "opencl",
+          D.template get_info<info::device::opencl_c_version>());
+}
+
+inline bool is_csv_file(const std::string &FileName) {
+  const std::string Ext = ".csv";
+  return FileName.size() >= Ext.size() &&
+         FileName.compare(FileName.size() - Ext.size(), Ext.size(), Ext) == 0;
+}
+
+// first line of file, empty if file is missing or empty
+inline std::string read_first_line(const std::string &FileName) {
+  std::ifstream Is{FileName};
+  std::string Line;
+  if (Is.is_open())
+    std::getline(Is, Line);
+  return Line;
+}
+
+// FileName or its numbered sibling, which is empty or has same Header
+inline std::string csv_target(const std::string &FileName,
+                              const std::string &Header) {
+  const std::string Stem = FileName.substr(0, FileName.size() - 4);
+  std::string Target = FileName;
+  for (int I = 1;; ++I) {
+    auto Line = read_first_line(Target);
+    if (Line.empty() || Line == Header)
+      return Target;
+    Target = Stem + "." + std::to_string(I) + ".csv";
+  }
+}
+
+inline void write_report(const std::string &FileName,
+                         const ResultRecord &Rec) {
+  if (!is_csv_file(FileName)) {
+    std::ofstream Os{FileName, std::ios::app};
+    if (!Os.is_open())
+      throw std::runtime_error("Can not open report file: " + FileName);
+    Rec.write_json(Os);
+    return;
+  }
+  std::ostringstream HdrOs;
+  Rec.write_csv_header(HdrOs);
+  auto Header = HdrOs.str();
+  Header.pop_back(); // newline
+  auto Target = csv_target(FileName, Header);
+  if (Target != FileName)
+    qout << "Report columns differ from " << FileName << ", written to "
+         << Target << "\n";
+  bool Empty = read_first_line(Target).empty();
+  std::ofstream Os{Target, std::ios::app};
+  if (!Os.is_open())
+    throw std::runtime_error("Can not open report file: " + Target);
+  if (Empty)
+    Os << Header << "\n";
+  Rec.write_csv_row(Os);
+}
+
+} // namespace sycltesters
@@ -0,0 +1,195 @@
+//------------------------------------------------------------------------------
+//
+// Roofline: achieved GFLOP/s and GB/s of kernel against device peaks
+//
+// Family declares work of one measured run in its namespace:
+//   sgemm::work_count(Cfg) -> {2 * AX * AY * BY flops, bytes of A, B, C}
+// Flops are arithmetic operations of kernel (integer adds for reductions),
+// bytes are memory traffic of algorithm, not of particular variant
+//
+// Peaks are measured once per device with built-in probes on the same queue
+// (see -roofline option in testers.hpp):
+//   * triad a[i] = b[i] + s * c[i] over big device arrays: bandwidth
+//   * independent fma chains, no memory traffic in loop: compute
+//
+// Kernel with intensity (flops per byte) below ridge point (peak flops per
+// peak byte) is memory-bound: percent of bandwidth peak is what matters
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include <CL/sycl.hpp>
+
+#include "report.hpp"
+#include "syclconst.hpp"
+#include "timers.hpp"
+
+namespace sycltesters {
+
+// work of one measured run
+struct WorkCount {
+  double Flops = 0, Bytes = 0;
+  bool empty() const { return Flops == 0 && Bytes == 0; }
+};
+
+// zero if not measured
+struct DevicePeaks {
+  double GFlops = 0, GBs = 0;
+  bool empty() const { return GFlops == 0 && GBs == 0; }
+};
+
+namespace detail {
+
+constexpr int PROBE_REPS = 5;           // best of
+constexpr size_t STREAM_ELTS = 1 << 24; // per array, capped by alloc size
+constexpr size_t FMA_ITEMS = 1 << 18;
+constexpr int FMA_ITERS = 1024;
+constexpr int FMA_CHAINS = 8; // independent chains hide fma latency
+
+inline double event_sec(sycl::event Evt) {
+  Evt.wait();
+  nsec_t Start = Evt.template get_profiling_info<EvtStart>();
+  nsec_t End = Evt.template get_profiling_info<EvtEnd>();
+  return (End - Start) / nsec_per_sec;
+}
+
+// best of runs: probes estimate peak, not typical
+template <typename SubmitF> double best_sec(SubmitF Submit) {
+  Submit().wait(); // warmup, JIT
+  double Best = event_sec(Submit());
+  for (int I = 1; I < PROBE_REPS; ++I)
+    Best = std::min(Best, event_sec(Submit()));
+  return Best;
+}
+
+inline double probe_bandwidth(sycl::queue &Q) {
+  auto MaxAlloc =
+      Q.get_device().template get_info<info::device::max_mem_alloc_size>();
+  auto GlobMem =
+      Q.get_device().template get_info<info::device::global_mem_size>();
+  size_t N = std::min<size_t>(STREAM_ELTS, MaxAlloc / sizeof(float));
+  N = std::min<size_t>(N, GlobMem / sizeof(float) / 4);
+  float *A = sycl::malloc_device<float>(N, Q);
+  float *B = sycl::malloc_device<float>(N, Q);
+  float *C = sycl::malloc_device<float>(N, Q);
+  if (!A || !B || !C) {
+    sycl::free(A, Q);
+    sycl::free(B, Q);
+    sycl::free(C, Q);
+    return 0;
+  }
+  Q.fill(B, 1.0f, N).wait();
+  Q.fill(C, 2.0f, N).wait();
+  double Sec = best_sec([&] {
+    return Q.parallel_for(sycl::range<1>{N}, [=](sycl::id<1> I) {
+      A[I] = B[I] + 3.0f * C[I];
+    });
+  });
+  sycl::free(A, Q);
+  sycl::free(B, Q);
+  sycl::free(C, Q);
+  return 3.0 * N * sizeof(float) / Sec / 1e9;
+}
+
+inline double probe_compute(sycl::queue &Q) {
+  float *Out = sycl::malloc_device<float>(FMA_ITEMS, Q);
+  if (!Out)
+    return 0;
+  double Sec = best_sec([&] {
+    return Q.parallel_for(sycl::range<1>{FMA_ITEMS}, [=](sycl::id<1> I) {
+      float Acc[FMA_CHAINS];
+      for (int C = 0; C < FMA_CHAINS; ++C)
+        Acc[C] = I[0] + C;
+      // values stay bounded: multiplier below one
+      for (int It = 0; It < FMA_ITERS; ++It)
+        for (int C = 0; C < FMA_CHAINS; ++C)
+          Acc[C] = sycl::fma(Acc[C], 0.999f, 0.001f);
+      float Sum = 0;
+      for (int C = 0; C < FMA_CHAINS; ++C)
+        Sum += Acc[C];
+      Out[I] = Sum; // keeps chains alive
+    });
+  });
+  sycl::free(Out, Q);
+  return 2.0 * FMA_ITEMS * FMA_ITERS * FMA_CHAINS / Sec / 1e9;
+}
+
+} // namespace detail
+
+// probes run once per device name within process
+inline DevicePeaks device_peaks(sycl::queue &Q) {
+  static std::mutex Mutex;
+  static std::map<std::string, DevicePeaks> Cache;
+  auto Name = Q.get_device().template get_info<info::device::name>();
+  std::lock_guard<std::mutex> Lock{Mutex};
+  auto It = Cache.find(Name);
+  if (It != Cache.end())
+    return It->second;
+  DevicePeaks Peaks;
+  Peaks.GBs = detail::probe_bandwidth(Q);
+  Peaks.GFlops = detail::probe_compute(Q);
+  Cache.emplace(Name, Peaks);
+  return Peaks;
+}
+
+template <typename OsTy>
+OsTy &dump_peaks(OsTy &Os, const DevicePeaks &Peaks) {
+  Os << "Device peaks: " << Peaks.GFlops << " GFLOP/s (fma), " << Peaks.GBs
+     << " GB/s (triad)\n";
+  return Os;
+}
+
+// Sec is median execution time of one run
+template <typename OsTy>
+OsTy &dump_roofline(OsTy &Os, const WorkCount &Work, double Sec,
+                    const DevicePeaks &Peaks) {
+  if (Work.empty() || Sec <= 0)
+    return Os;
+  double GFlops = Work.Flops / Sec / 1e9;
+  double GBs = Work.Bytes / Sec / 1e9;
+  Os << "Achieved:";
+  if (Work.Flops > 0)
+    Os << " " << GFlops << " GFLOP/s";
+  if (Work.Bytes > 0)
+    Os << " " << GBs << " GB/s";
+  Os << "\n";
+  if (Peaks.empty())
+    return Os;
+  if (Work.Flops > 0 && Peaks.GFlops > 0)
+    Os << "Compute: " << 100.0 * GFlops / Peaks.GFlops << "% of peak\n";
+  if (Work.Bytes > 0 && Peaks.GBs > 0)
+    Os << "Bandwidth: " << 100.0 * GBs / Peaks.GBs << "% of peak\n";
+  if (Work.Bytes > 0 && Peaks.GBs > 0 && Peaks.GFlops > 0) {
+    double Intensity = Work.Flops / Work.Bytes;
+    double Ridge = Peaks.GFlops / Peaks.GBs;
+    Os << "Intensity: " << Intensity << " flop/byte, ridge " << Ridge << ": "
+       << (Intensity < Ridge ? "memory" : "compute") << "-bound\n";
+  }
+  return Os;
+}
+
+inline void record_roofline(ResultRecord &Rec, const WorkCount &Work,
+                            double Sec, const DevicePeaks &Peaks) {
+  Rec.add("roofline", "flops", Work.Flops);
+  Rec.add("roofline", "bytes", Work.Bytes);
+  Rec.add("roofline", "gflops", Sec > 0 ? Work.Flops / Sec / 1e9 : 0.0);
+  Rec.add("roofline", "gbs", Sec > 0 ? Work.Bytes / Sec / 1e9 : 0.0);
+  Rec.add("roofline", "peak_gflops", Peaks.GFlops);
+  Rec.add("roofline", "peak_gbs", Peaks.GBs);
+}
+
+} // namespace sycltesters
@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+//
+// Simple statistics over repeated measurements
+// and rank test to compare two sets of them
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace sycltesters {
+
+struct SampleStats {
+  size_t Count = 0;
+  double Min = 0.0, Max = 0.0, Mean = 0.0, Median = 0.0, P95 = 0.0,
+         StdDev = 0.0;
+};
+
+// nearest-rank percentile, expects sorted non-empty sequence
+inline double percentile(const std::vector<double> &Sorted, double Pct) {
+  assert(!Sorted.empty());
+  assert(Pct >= 0.0 && Pct <= 100.0);
+  auto Rank = static_cast<size_t>(std::ceil(Pct / 100.0 * Sorted.size()));
+  if (Rank > 0)
+    Rank -= 1;
+  return Sorted[std::min(Rank, Sorted.size() - 1)];
+}
+
+// median is average of two middle elements for even count
+inline double median(const std::vector<double> &Sorted) {
+  assert(!Sorted.empty());
+  auto Half = Sorted.size() / 2;
+  if (Sorted.size() % 2 == 1)
+    return Sorted[Half];
+  return (Sorted[Half - 1] + Sorted[Half]) / 2.0;
+}
+
+inline SampleStats compute_stats(std::vector<double> Samples) {
+  SampleStats Stats;
+  if (Samples.empty())
+    return Stats;
+  std::sort(Samples.begin(), Samples.end());
+  Stats.Count = Samples.size();
+  Stats.Min = Samples.front();
+  Stats.Max = Samples.back();
+  Stats.Mean = std::accumulate(Samples.begin(), Samples.end(), 0.0) /
+               Stats.Count;
+  Stats.Median = median(Samples);
+  Stats.P95 = percentile(Samples, 95.0);
+
+  // sample (n - 1) standard deviation, zero for single sample
+  if (Stats.Count > 1) {
+    double SqSum = 0.0;
+    for (auto S : Samples)
+      SqSum += (S - Stats.Mean) * (S - Stats.Mean);
+    Stats.StdDev = std::sqrt(SqSum / (Stats.Count - 1));
+  }
+  return Stats;
+}
+
+// one-sided Mann-Whitney U test: p-value for "samples of Y tend to be
+// greater than samples of X", normal approximation with tie correction and
+// continuity correction (reasonable from about 5 samples each)
+inline double mann_whitney_greater(const std::vector<double> &X,
+                                   const std::vector<double> &Y) {
+  const size_t NX = X.size(), NY = Y.size(), N = NX + NY;
+  if (NX == 0 || NY == 0)
+    return 1.0;
+  // (value, is from Y), ranks averaged over ties
+  std::vector<std::pair<double, bool>> All;
+  for (auto V : X)
+    All.emplace_back(V, false);
+  for (auto V : Y)
+    All.emplace_back(V, true);
+  std::sort(All.begin(), All.end());
+  double RankSumY = 0.0, TieSum = 0.0;
+  for (size_t I = 0; I < N;) {
+    size_t J = I;
+    while (J < N && All[J].first == All[I].first)
+      ++J;
+    double Rank = (I + 1 + J) / 2.0; // ranks I + 1 .. J
+    for (size_t K = I; K < J; ++K)
+      if (All[K].second)
+        RankSumY += Rank;
+    double T = J - I;
+    TieSum += T * T * T - T;
+    I = J;
+  }
+  double U = RankSumY - NY * (NY + 1) / 2.0;
+  double Mean = NX * NY / 2.0;
+  double Var = NX * NY / 12.0 * ((N + 1) - TieSum / (double(N) * (N - 1)));
+  if (Var <= 0.0)
+    return 1.0; // all samples equal
+  double Z = (U - Mean - 0.5) / std::sqrt(Var);
+  return 0.5 * std::erfc(Z / std::sqrt(2.0));
+}
+
+} // namespace sycltesters
@@ -0,0 +1,161 @@
+//------------------------------------------------------------------------------
+//
+// Out-of-core streaming: process host data in chunks through few device
+// staging buffers, so data size is not capped by device memory
+//
+// Chunk K goes to staging slot K % NBuf. Copies of chunk K are submitted
+// while chunks K - NBuf + 1 ... K - 1 still compute, so on out-of-order
+// queue host to device transfer hides behind compute (double buffering for
+// two slots, triple for three). Before slot is reused its previous chunk is
+// retired: host waits for its last event and merges its partial result
+// (bins, partial sums, output slice), chunks are merged in order:
+//
+//   auto Chunk = stream_chunk<T>(Q, BCfg.StreamChunk, BCfg.StreamBufs, 2, N);
+//   ChunkStream<T, 2> Stream{Q, Chunk, BCfg.StreamBufs};
+//   auto Evts = Stream.run({A, B}, N,
+//       [&](const ChunkInfo &C, auto &Dev, auto &Copies) {
+//         EvtVec_t Evts; // wrap each event right after its submit
+//         ... kernel on Dev[0], Dev[1] depending on Copies ...
+//         Evts.emplace_back(KernEvt, "Add");
+//         ... copy out ...
+//         Evts.emplace_back(CopyEvt, "Copy out");
+//         return Evts; // last event ends chunk
+//       },
+//       [&](const ChunkInfo &C) { ... merge partial result of C ... });
+//
+// Compute may use its own per slot buffers (ChunkInfo::Slot): slot is not
+// reused before its chunk is merged. With in-order queue it all still
+// works, but without overlap.
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+#include "footprint.hpp"
+#include "syclconst.hpp"
+#include "timers.hpp"
+#include "usmpool.hpp"
+
+namespace sycltesters {
+
+constexpr size_t DEF_STREAM_CHUNK = 1 << 22; // elements
+constexpr unsigned DEF_STREAM_NBUF = 2;
+
+struct ChunkInfo {
+  size_t Idx, Offset, Size; // Offset and Size in elements
+  unsigned Slot;
+};
+
+// Requested elements per chunk, or default which fits NBuf slots of NIn
+// inputs into device memory (minus reserve) and single allocation limit
+template <typename T>
+size_t stream_chunk(sycl::queue &Q, size_t Requested, unsigned NBuf,
+                    unsigned NIn, size_t N) {
+  if (Requested > 0)
+    return std::min(Requested, std::max<size_t>(N, 1));
+  auto D = Q.get_device();
+  double Global = D.template get_info<info::device::global_mem_size>();
+  double MaxAlloc = D.template get_info<info::device::max_mem_alloc_size>();
+  double Fit = Global * (1.0 - DEVICE_MEM_RESERVE) / (NBuf * NIn * sizeof(T));
+  Fit = std::min(Fit, MaxAlloc / sizeof(T));
+  size_t Chunk = std::min<size_t>(DEF_STREAM_CHUNK, static_cast<size_t>(Fit));
+  return std::max<size_t>(1, std::min(Chunk, N));
+}
+
+// footprint of streamed run: device holds only NBuf slots of NIn inputs
+template <typename T>
+Footprint stream_footprint(double Host, size_t Chunk, unsigned NBuf,
+                           unsigned NIn, size_t N) {
+  double Slot = double(std::min(Chunk, N)) * sizeof(T);
+  double Device = std::min(NBuf * Slot, double(N) * sizeof(T)) * NIn;
+  return {Host, Device, Slot};
+}
+
+template <typename T, size_t NIn> class ChunkStream {
+public:
+  using DevPtrs = std::array<T *, NIn>;
+  using HostPtrs = std::array<const T *, NIn>;
+
+private:
+  sycl::queue Q_;
+  size_t Chunk_;
+  std::vector<DevPtrs> Slots_;
+
+public:
+  ChunkStream(sycl::queue &Q, size_t Chunk, unsigned NBuf)
+      : Q_(Q), Chunk_(Chunk), Slots_(NBuf) {
+    if (Chunk_ < 1 || NBuf < 1)
+      throw std::runtime_error("Expect chunk >= 1 and nbuf >= 1");
+    for (auto &&Slot : Slots_)
+      for (auto &&Ptr : Slot)
+        Ptr = pool_malloc_device<T>(Chunk_, Q_);
+  }
+
+  ChunkStream(const ChunkStream &) = delete;
+  ChunkStream &operator=(const ChunkStream &) = delete;
+
+  // reverse order: pool is LIFO, next stream gets same blocks
+  ~ChunkStream() {
+    for (auto S = Slots_.rbegin(); S != Slots_.rend(); ++S)
+      for (auto P = S->rbegin(); P != S->rend(); ++P)
+        pool_free(*P, Q_);
+  }
+
+  size_t chunk() const { return Chunk_; }
+  unsigned slots() const { return Slots_.size(); }
+
+  // Compute(ChunkInfo, DevPtrs, vector<event> Copies) -> events of chunk,
+  // last one completes it; Merge(ChunkInfo) on host after that event, in
+  // chunk order
+  template <typename ComputeF, typename MergeF>
+  EvtVec_t run(HostPtrs Host, size_t N, ComputeF Compute, MergeF Merge) {
+    EvtVec_t ProfInfo;
+    std::deque<std::pair<ChunkInfo, sycl::event>> InFlight;
+    auto Retire = [&] {
+      auto [C, Evt] = InFlight.front();
+      InFlight.pop_front();
+      Evt.wait();
+      Merge(C);
+    };
+
+    size_t Idx = 0;
+    for (size_t Offset = 0; Offset < N; Offset += Chunk_, ++Idx) {
+      // oldest chunk in flight holds slot of this one
+      if (InFlight.size() == Slots_.size())
+        Retire();
+      ChunkInfo C{Idx, Offset, std::min(Chunk_, N - Offset),
+                  static_cast<unsigned>(Idx % Slots_.size())};
+      std::vector<sycl::event> Copies;
+      for (size_t I = 0; I < NIn; ++I) {
+        auto Evt = Q_.memcpy(Slots_[C.Slot][I], Host[I] + Offset,
+                             C.Size * sizeof(T));
+        ProfInfo.emplace_back(Evt, "Copy chunk");
+        Copies.push_back(Evt);
+      }
+      EvtVec_t Evts = Compute(C, Slots_[C.Slot], Copies);
+      if (Evts.empty())
+        throw std::runtime_error("Chunk compute shall return its events");
+      InFlight.emplace_back(C, Evts.back().Evt_);
+      ProfInfo.insert(ProfInfo.end(), Evts.begin(), Evts.end());
+    }
+    while (!InFlight.empty())
+      Retire();
+    return ProfInfo;
+  }
+};
+
+} // namespace sycltesters
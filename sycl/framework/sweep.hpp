@@ -0,0 +1,129 @@
+//------------------------------------------------------------------------------
+//
+// List and range syntax for numeric options, shared by both option parsers
+//
+//   -lsz=8,16,32     : list
+//   -ax=4..20:2      : range with step, both ends included
+//   -ax=4..8         : range with step 1
+//   -lsz=1,4..16:4   : lists and ranges may be mixed
+//
+// Options given this way make a sweep: test sequence runs every point of
+// cartesian product of all such options in one process
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace options {
+
+// option name -> value for every swept option
+using SweepPoint = std::vector<std::pair<std::string, std::string>>;
+
+inline bool is_sweep_value(const std::string &Val) {
+  return Val.find(',') != Val.npos || Val.find("..") != Val.npos;
+}
+
+namespace detail {
+
+inline bool is_integer(const std::string &S) {
+  return S.find_first_of(".eE") == S.npos;
+}
+
+template <typename T> T to_number(const std::string &S) {
+  std::istringstream Is{S};
+  T Ret;
+  Is >> Ret;
+  if (Is.fail() || !Is.eof())
+    throw std::invalid_argument("Not a number in sweep: " + S);
+  return Ret;
+}
+
+template <typename T>
+void expand_range(T Lo, T Hi, T Step, std::vector<std::string> &Out) {
+  if (!(Step > 0) || Hi < Lo)
+    throw std::invalid_argument("Sweep range expects lo <= hi and step > 0");
+  // count instead of accumulation: no drift for floating point steps
+  auto N = static_cast<long long>(std::floor((Hi - Lo) / Step + 1e-9)) + 1;
+  for (long long I = 0; I < N; ++I) {
+    std::ostringstream Os;
+    Os << Lo + static_cast<T>(I * Step);
+    Out.push_back(Os.str());
+  }
+}
+
+// "lo..hi" or "lo..hi:step"
+inline void expand_item(const std::string &Item,
+                        std::vector<std::string> &Out) {
+  auto Dots = Item.find("..");
+  if (Dots == Item.npos) {
+    Out.push_back(Item);
+    return;
+  }
+  auto Colon = Item.find(':', Dots);
+  std::string Lo = Item.substr(0, Dots);
+  std::string Hi = Item.substr(Dots + 2, Colon == Item.npos ? Item.npos
+                                                            : Colon - Dots - 2);
+  std::string Step = (Colon == Item.npos) ? "1" : Item.substr(Colon + 1);
+  if (is_integer(Lo) && is_integer(Hi) && is_integer(Step))
+    expand_range(to_number<long long>(Lo), to_number<long long>(Hi),
+                 to_number<long long>(Step), Out);
+  else
+    expand_range(to_number<double>(Lo), to_number<double>(Hi),
+                 to_number<double>(Step), Out);
+}
+
+} // namespace detail
+
+inline std::vector<std::string> expand_values(const std::string &Val) {
+  std::vector<std::string> Ret;
+  std::string::size_type Pos = 0;
+  for (;;) {
+    auto Comma = Val.find(',', Pos);
+    auto Item = Val.substr(Pos, Comma == Val.npos ? Val.npos : Comma - Pos);
+    if (Item.empty())
+      throw std::invalid_argument("Empty item in option list: " + Val);
+    detail::expand_item(Item, Ret);
+    if (Comma == Val.npos)
+      break;
+    Pos = Comma + 1;
+  }
+  return Ret;
+}
+
+// first axis varies slowest; no axes gives single empty point
+inline std::vector<SweepPoint> cartesian(
+    const std::vector<std::pair<std::string, std::vector<std::string>>> &Axes) {
+  std::vector<SweepPoint> Points(1);
+  for (auto &&[Name, Vals] : Axes) {
+    std::vector<SweepPoint> Next;
+    for (auto &&P : Points)
+      for (auto &&V : Vals) {
+        Next.push_back(P);
+        Next.back().emplace_back(Name, V);
+      }
+    Points.swap(Next);
+  }
+  return Points;
+}
+
+// "-lsz=8 -ax=4" to print
+inline std::string describe(const SweepPoint &P) {
+  std::string Ret;
+  for (auto &&[Name, Val] : P)
+    Ret += (Ret.empty() ? "-" : " -") + Name + "=" + Val;
+  return Ret;
+}
+
+} // namespace options
@@ -38,6 +38,7 @@ using EBundleTy = sycl::kernel_bundle<sycl::bundle_state::executable>;
 constexpr auto host_ptr = sycl::property::buffer::use_host_ptr{};
 
 // event and profiling aliases
+constexpr auto EvtSubmit = sycl::info::event_profiling::command_submit;
 constexpr auto EvtStart = sycl::info::event_profiling::command_start;
 constexpr auto EvtEnd = sycl::info::event_profiling::command_end;
 constexpr auto EvtStatus = sycl::info::event::command_execution_status;
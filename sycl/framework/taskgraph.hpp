@@ -0,0 +1,189 @@
+//------------------------------------------------------------------------------
+//
+// Task graph: record submissions with dependencies once, replay many times
+//
+// Multi-kernel algorithm (bitonic stages, DAG of kernels) is recorded as
+// nodes: command group function plus indices of nodes it depends on. Replay
+// submits all nodes back to back with event dependencies between them, so
+// there is no host wait between nodes and only one wait at the end:
+//
+//   if (Graph_.rebind(A, Sz)) {
+//     auto X = Graph_.add("X", [=](sycl::handler &Cgh) { ... });
+//     auto Y = Graph_.add("Y", [=](sycl::handler &Cgh) { ... });
+//     Graph_.add("C", [=](sycl::handler &Cgh) { ... }, {X, Y});
+//   }
+//   auto Evts = Graph_.replay(Q, {EvtCopyIn});
+//
+// Command groups capture device pointers by value, so new inputs are new
+// data in same USM blocks (pool gives them back on next call). rebind
+// tells if bindings (pointers, sizes) changed and graph shall be recorded
+// again.
+//
+// On in-order queue dependencies are implied and not set at all. With
+// USE_SYCL_GRAPH and sycl_ext_oneapi_graph support, graph is finalized once
+// into executable command graph and replay is single submission; per node
+// profiling is lost then, replay gives one event for whole graph.
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+#include "timers.hpp"
+
+#if defined(USE_SYCL_GRAPH) && defined(SYCL_EXT_ONEAPI_GRAPH)
+#define SYCLTESTERS_NATIVE_GRAPH 1
+#endif
+
+namespace sycltesters {
+
+class TaskGraph {
+public:
+  using NodeId = size_t;
+  using CgfTy = std::function<void(sycl::handler &)>;
+  // called after node completes in step-by-step replay
+  using StepHookTy = std::function<void(NodeId, const std::string &)>;
+
+private:
+  struct Node {
+    std::string Name;
+    CgfTy Cgf;
+    std::vector<NodeId> Deps;
+  };
+  std::vector<Node> Nodes_;
+  std::vector<std::uintptr_t> Bindings_;
+  std::vector<sycl::event> Evts_; // of last replay, reused
+
+#ifdef SYCLTESTERS_NATIVE_GRAPH
+  using ExecGraphTy = sycl::ext::oneapi::experimental::command_graph<
+      sycl::ext::oneapi::experimental::graph_state::executable>;
+  std::optional<ExecGraphTy> Exec_;
+
+  void finalize(sycl::queue &Q) {
+    namespace exp = sycl::ext::oneapi::experimental;
+    exp::command_graph<exp::graph_state::modifiable> G{Q.get_context(),
+                                                       Q.get_device()};
+    std::vector<exp::node> GNodes;
+    GNodes.reserve(Nodes_.size());
+    for (auto &&N : Nodes_) {
+      GNodes.push_back(G.add(N.Cgf));
+      for (auto D : N.Deps)
+        G.make_edge(GNodes[D], GNodes.back());
+    }
+    Exec_ = G.finalize();
+  }
+#endif
+
+  template <typename T> static std::uintptr_t binding(const T &V) {
+    if constexpr (std::is_pointer_v<T>)
+      return reinterpret_cast<std::uintptr_t>(V);
+    else
+      return static_cast<std::uintptr_t>(V);
+  }
+
+public:
+  size_t size() const { return Nodes_.size(); }
+  bool empty() const { return Nodes_.empty(); }
+
+  void clear() {
+    Nodes_.clear();
+    Evts_.clear();
+#ifdef SYCLTESTERS_NATIVE_GRAPH
+    Exec_.reset();
+#endif
+  }
+
+  // true if graph is empty or was recorded for other bindings; then it is
+  // cleared and caller shall record it again
+  template <typename... Ts> bool rebind(const Ts &...Bindings) {
+    std::vector<std::uintptr_t> New{binding(Bindings)...};
+    if (!empty() && New == Bindings_)
+      return false;
+    clear();
+    Bindings_ = std::move(New);
+    return true;
+  }
+
+  // Deps are ids of nodes added before
+  NodeId add(std::string Name, CgfTy Cgf, std::vector<NodeId> Deps = {}) {
+    for (auto D : Deps)
+      if (D >= Nodes_.size())
+        throw std::runtime_error("Task graph: dependency on unknown node");
+    Nodes_.push_back({std::move(Name), std::move(Cgf), std::move(Deps)});
+#ifdef SYCLTESTERS_NATIVE_GRAPH
+    Exec_.reset();
+#endif
+    return Nodes_.size() - 1;
+  }
+
+  // node after last added one: linear chain of kernels
+  NodeId then(std::string Name, CgfTy Cgf) {
+    if (empty())
+      return add(std::move(Name), std::move(Cgf));
+    return add(std::move(Name), std::move(Cgf), {Nodes_.size() - 1});
+  }
+
+  // submits whole graph without waiting; nodes without dependencies wait
+  // for After (say copies of new inputs)
+  EvtVec_t replay(sycl::queue &Q, std::vector<sycl::event> After = {}) {
+    EvtVec_t ProfInfo;
+#ifdef SYCLTESTERS_NATIVE_GRAPH
+    if (!Exec_)
+      finalize(Q);
+    ProfInfo.emplace_back(Q.submit([&](sycl::handler &Cgh) {
+      Cgh.depends_on(After);
+      Cgh.ext_oneapi_graph(*Exec_);
+    }),
+                          "Task graph");
+#else
+    const bool InOrder = Q.is_in_order();
+    Evts_.resize(Nodes_.size());
+    ProfInfo.reserve(Nodes_.size());
+    for (NodeId I = 0; I < Nodes_.size(); ++I) {
+      auto &&N = Nodes_[I];
+      Evts_[I] = Q.submit([&](sycl::handler &Cgh) {
+        if (!InOrder) {
+          if (N.Deps.empty())
+            Cgh.depends_on(After);
+          for (auto D : N.Deps)
+            Cgh.depends_on(Evts_[D]);
+        }
+        N.Cgf(Cgh);
+      });
+      ProfInfo.emplace_back(Evts_[I], N.Name);
+    }
+#endif
+    return ProfInfo;
+  }
+
+  // node by node with wait after each, for debugging and visualization
+  EvtVec_t replay_stepwise(sycl::queue &Q, StepHookTy Hook,
+                           std::vector<sycl::event> After = {}) {
+    EvtVec_t ProfInfo;
+    sycl::event::wait(After);
+    for (NodeId I = 0; I < Nodes_.size(); ++I) {
+      auto Evt = Q.submit(Nodes_[I].Cgf);
+      ProfInfo.emplace_back(Evt, Nodes_[I].Name);
+      Evt.wait();
+      Hook(I, Nodes_[I].Name);
+    }
+    return ProfInfo;
+  }
+};
+
+} // namespace sycltesters
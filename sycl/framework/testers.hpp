@@ -5,6 +5,29 @@
 //
 // Macros to control things: see comment in CMakeLists.txt
 //
+// Options common for all kernel families (see add_bench_options):
+// -reps=<n> : number of measured runs, statistics reported if n > 1
+// -warmup=<w> : number of unmeasured runs before measurement (JIT, caches)
+// -latency : per-command queued/launch/exec breakdown of measured runs
+// -trace=<file> : write host regions and device commands as chrome trace
+//                 (all measurements of process, see trace.hpp)
+// -report=<file> : append machine-readable result record (see report.hpp)
+// -kcache=<dir> : keep JIT-built kernels on disk between runs (bundles.hpp)
+// -seed=<s> : seed for random input data, same seed gives same data
+// -roofline : probe device peaks, report percent of peak (roofline.hpp)
+//             throughput is from kernel time: events except "Copy ..." ones
+// -hwc : host CPU hardware counters of measured runs and of host reference,
+//   for CPU device it is kernel itself (perfcount.hpp)
+// -tune : search work-group sizes, store winners in tuning database
+// -tunedb=<file> : tuning database, tuned sizes are defaults (tuner.hpp)
+// -vabs=<x>, -vrel=<x>, -vulp=<n> : tolerances of result verification, if
+//   built with VERIFY, override family defaults (verify.hpp)
+// -savebase=<file> : store timing samples as performance baseline
+// -checkbase=<file> : fail if slower than baseline by more than
+//   -regress=<pct> percent, significantly (baseline.hpp)
+//
+// Any numeric option may be list or range to sweep over (see sweep.hpp)
+//
 //------------------------------------------------------------------------------
 //
 // This file is licensed after LGPL v3
@@ -17,20 +40,433 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <filesystem>
 #include <iostream>
 #include <iterator>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <CL/sycl.hpp>
 
+#include "baseline.hpp"
+#include "bundles.hpp"
+#include "dataset.hpp"
 #include "dice.hpp"
+#include "footprint.hpp"
+#include "perfcount.hpp"
 #include "qstream.hpp"
+#include "registry.hpp"
+#include "report.hpp"
+#include "roofline.hpp"
 #include "simplemath.hpp"
+#include "stats.hpp"
+#include "streaming.hpp"
 #include "syclconst.hpp"
+#include "taskgraph.hpp"
 #include "timers.hpp"
+#include "trace.hpp"
+#include "tuner.hpp"
+#include "usmpool.hpp"
+#include "verify.hpp"
 
 namespace sycltesters {
 
+constexpr int DEF_REPS = 1;
+constexpr int DEF_WARMUP = 0;
+
+// benchmarking setup shared by all kernel families
+struct BenchConfig {
+  int Reps = DEF_REPS, Warmup = DEF_WARMUP;
+  bool Latency = false;
+  std::string TraceFile;  // empty if no trace requested
+  std::string ReportFile; // empty if no report requested
+  std::string Program;    // executable name identifies variant in reports
+  std::string KernelCache; // empty if no persistent kernel cache
+  std::uint64_t Seed = 0;  // seed of input data (random unless -seed given)
+  bool Roofline = false;
+  bool HwCounters = false;
+  bool Tune = false;
+  std::string TuneDb;          // empty if tuned defaults are not used
+  std::set<std::string> Given; // tunable options given in command line
+  // verification tolerances, negative is family default
+  double VerifyAbs = -1, VerifyRel = -1;
+  long long VerifyUlp = -1;
+  std::string SaveBase, CheckBase; // empty if no baseline requested
+  double RegressPct = DEF_REGRESS_PCT;
+  // streaming variants: elements per chunk (0 is default) and slots
+  size_t StreamChunk = 0;
+  unsigned StreamBufs = DEF_STREAM_NBUF;
+};
+
+// templated on parser: testers include boost or non-boost one
+template <typename ParserT> void add_bench_options(ParserT &OptParser) {
+  OptParser.template add<int>("reps", DEF_REPS, "number of measured runs");
+  OptParser.template add<int>("warmup", DEF_WARMUP,
+                              "number of warmup (not measured) runs");
+  OptParser.template add<int>("latency", 0, "per-command latency breakdown");
+  OptParser.template add<std::string>("trace", "",
+                                      "chrome trace output file");
+  OptParser.template add<std::string>("report", "",
+                                      "append results to file (json or csv)");
+  OptParser.template add<std::string>("kcache", "",
+                                      "persistent kernel cache directory");
+  // string, not number: empty means random seed
+  OptParser.template add<std::string>("seed", "",
+                                      "seed for random input data");
+  OptParser.template add<int>("roofline", 0,
+                              "measure device peaks for percent of peak");
+  OptParser.template add<int>("hwc", 0, "host hardware counters");
+  OptParser.template add<int>("tune", 0, "tune work-group sizes");
+  OptParser.template add<std::string>("tunedb", DEF_TUNEDB,
+                                      "tuning database file");
+  OptParser.template add<double>("vabs", -1, "absolute verify tolerance");
+  OptParser.template add<double>("vrel", -1, "relative verify tolerance");
+  OptParser.template add<long long>("vulp", -1, "verify tolerance in ulps");
+  OptParser.template add<std::string>("savebase", "",
+                                      "save timings to baseline file");
+  OptParser.template add<std::string>("checkbase", "",
+                                      "compare timings with baseline file");
+  OptParser.template add<double>("regress", DEF_REGRESS_PCT,
+                                 "regression threshold, percent");
+  OptParser.template add<long long>("chunk", 0,
+                                    "elements per chunk for streaming");
+  OptParser.template add<int>("nbuf", DEF_STREAM_NBUF,
+                              "device buffers for streaming");
+}
+
+template <typename ParserT>
+BenchConfig read_bench_options(const ParserT &OptParser, std::string Program) {
+  BenchConfig BCfg;
+  BCfg.Program = std::move(Program);
+  BCfg.Reps = OptParser.template get<int>("reps");
+  BCfg.Warmup = OptParser.template get<int>("warmup");
+  BCfg.Latency = OptParser.exists("latency");
+  BCfg.TraceFile = OptParser.template get<std::string>("trace");
+  BCfg.ReportFile = OptParser.template get<std::string>("report");
+  BCfg.KernelCache = OptParser.template get<std::string>("kcache");
+  BCfg.Roofline = OptParser.exists("roofline");
+  BCfg.HwCounters = OptParser.exists("hwc");
+  BCfg.Tune = OptParser.exists("tune");
+  BCfg.TuneDb = OptParser.template get<std::string>("tunedb");
+  if (BCfg.Tune && BCfg.TuneDb.empty())
+    throw std::runtime_error("Expect tuning database for -tune");
+  BCfg.VerifyAbs = OptParser.template get<double>("vabs");
+  BCfg.VerifyRel = OptParser.template get<double>("vrel");
+  BCfg.VerifyUlp = OptParser.template get<long long>("vulp");
+  BCfg.SaveBase = OptParser.template get<std::string>("savebase");
+  BCfg.CheckBase = OptParser.template get<std::string>("checkbase");
+  BCfg.RegressPct = OptParser.template get<double>("regress");
+  auto Chunk = OptParser.template get<long long>("chunk");
+  auto NBuf = OptParser.template get<int>("nbuf");
+  if (Chunk < 0 || NBuf < 1)
+    throw std::runtime_error("Expect chunk >= 0 and nbuf >= 1");
+  BCfg.StreamChunk = Chunk;
+  BCfg.StreamBufs = NBuf;
+  // only recorded here: all sweep points are read before any input is made
+  auto Seed = OptParser.template get<std::string>("seed");
+  BCfg.Seed = Seed.empty() ? get_seed() : std::stoull(Seed);
+  if (BCfg.Reps < 1 || BCfg.Warmup < 0)
+    throw std::runtime_error("Expect reps >= 1 and warmup >= 0");
+  // options are read before set_queue, so runtime is not initialized yet
+  enable_persistent_cache(BCfg.KernelCache);
+  return BCfg;
+}
+
+// all samples are in seconds, Events are from measured runs only
+struct BenchResult {
+  std::vector<double> Wall, Evt;
+  std::vector<double> Kernel; // events except copies
+  SampleStats WallStats, EvtStats, KernelStats;
+  std::vector<EvtRecord> Events;
+  WorkCount Work;    // of one run, declared by family
+  DevicePeaks Peaks; // empty unless -roofline
+  std::optional<HwCounts> Hw; // per measured run, if -hwc
+  double PeakRss = 0;         // bytes, over warmup and measured runs
+};
+
+// execution time for throughput: kernel events if any, otherwise all events
+// (variant of copies only), otherwise host time
+inline double run_seconds(const BenchResult &Res) {
+  if (Res.KernelStats.Median > 0)
+    return Res.KernelStats.Median;
+  return Res.EvtStats.Median > 0 ? Res.EvtStats.Median
+                                 : Res.WallStats.Median;
+}
+
+// per run sums of events which are not copies
+inline std::vector<double> kernel_seconds(const std::vector<EvtRecord> &Recs,
+                                          int Reps) {
+  std::vector<double> Kernel(Reps, 0.0);
+  for (auto &&R : Recs)
+    if (!is_copy(R.Name) && R.Run < Kernel.size())
+      Kernel[R.Run] += (R.End - R.Start) / nsec_per_sec;
+  return Kernel;
+}
+
+// Work is family work_count, peaks are probed after measurement, so probe
+// kernels do not disturb it (and only once per device, see roofline.hpp)
+inline void attach_work(sycl::queue &Q, const BenchConfig &BCfg,
+                        BenchResult &Res, WorkCount Work) {
+  Res.Work = Work;
+  if (BCfg.Roofline)
+    Res.Peaks = device_peaks(Q);
+}
+
+// Calc is tester calculate: returns Timing_t {host nsec, summed event nsec}
+template <typename CalcF>
+BenchResult run_bench(const BenchConfig &BCfg, CalcF Calc) {
+  BenchResult Res;
+  bool Trace = !BCfg.TraceFile.empty();
+  auto &Log = event_log();
+  Log.enable(false);
+  region_log().clear();
+  reset_peak_rss();
+  for (int I = 0; I < BCfg.Warmup; ++I) {
+    ScopedTimer Region{"Warmup " + std::to_string(I)};
+    Calc();
+  }
+  Log.clear();
+  // always on: kernel time is taken from it
+  Log.enable(true);
+  // opened after warmup: runtime worker threads exist by then
+  std::optional<PerfCounters> Hw;
+  if (BCfg.HwCounters) {
+    Hw.emplace();
+    Hw->start();
+  }
+  for (int I = 0; I < BCfg.Reps; ++I) {
+    ScopedTimer Region{"Run " + std::to_string(I)};
+    auto Elapsed = Calc();
+    Res.Wall.push_back(Elapsed.first / nsec_per_sec);
+    Res.Evt.push_back(Elapsed.second / nsec_per_sec);
+    Log.next_run();
+  }
+  if (Hw) {
+    Hw->stop();
+    Res.Hw = Hw->read().per_run(BCfg.Reps);
+  }
+  Res.PeakRss = peak_rss();
+  Log.enable(false);
+  auto Records = Log.records();
+  if (Trace)
+    trace_file(BCfg.TraceFile)
+        .append(BCfg.Program, region_log().records(), Records);
+  Res.Kernel = kernel_seconds(Records, BCfg.Reps);
+  if (BCfg.Latency)
+    Res.Events = std::move(Records);
+  Res.WallStats = compute_stats(Res.Wall);
+  Res.EvtStats = compute_stats(Res.Evt);
+  Res.KernelStats = compute_stats(Res.Kernel);
+  return Res;
+}
+
+// host reference run: Calc as for run_bench, prints time and counters
+template <typename CalcF>
+Timing_t measure_host(const BenchConfig &BCfg, CalcF Calc) {
+  std::optional<PerfCounters> Hw;
+  if (BCfg.HwCounters) {
+    Hw.emplace();
+    Hw->start();
+  }
+  auto Elapsed = Calc();
+  qout << "Measured host time: " << sec_fmt(Elapsed.first) << "\n";
+  if (Hw) {
+    Hw->stop();
+    dump_hw_counts(qout, Hw->read(), "Host reference counters");
+  }
+  return Elapsed;
+}
+
+// Space is family tune_space, Calc as for run_bench: measures variant with
+// current values of config, so it shall not cache anything derived from them
+template <typename CalcF>
+void tune_config(sycl::queue &Q, const BenchConfig &BCfg, TuneSpace Space,
+                 CalcF Calc) {
+  if (BCfg.TuneDb.empty())
+    return;
+  auto Key = tuning_key(Q.get_device(), BCfg.Program);
+  apply_tuning(std::move(Space), BCfg.Given, BCfg.Tune, BCfg.TuneDb, Key,
+               [&] {
+                 BenchConfig TuneCfg;
+                 TuneCfg.Reps = TUNE_REPS;
+                 TuneCfg.Warmup = 1;
+                 auto Res = run_bench(TuneCfg, Calc);
+                 if (Res.KernelStats.Min > 0)
+                   return Res.KernelStats.Min;
+                 return Res.EvtStats.Min > 0 ? Res.EvtStats.Min
+                                             : Res.WallStats.Min;
+               });
+}
+
+template <typename OsTy>
+OsTy &dump_stats(OsTy &Os, std::string Name, const SampleStats &Stats) {
+  Os << Name << ": min = " << SecFmt{Stats.Min}
+     << ", median = " << SecFmt{Stats.Median} << ", p95 = " << SecFmt{Stats.P95}
+     << ", stddev = " << SecFmt{Stats.StdDev} << "\n";
+  return Os;
+}
+
+// nothing to say about statistics of single run
+template <typename OsTy> OsTy &dump_bench(OsTy &Os, const BenchResult &Res) {
+  if (!Res.Peaks.empty())
+    dump_peaks(Os, Res.Peaks);
+  dump_roofline(Os, Res.Work, run_seconds(Res), Res.Peaks);
+  if (!Res.Events.empty())
+    dump_latency(Os, Res.Events);
+  dump_pool_stats(Os);
+  if (Res.PeakRss > 0)
+    Os << "Peak host RSS: " << MemFmt{Res.PeakRss} << "\n";
+  if (Res.Hw)
+    dump_hw_counts(Os, *Res.Hw, "Host counters per run");
+  if (Res.Wall.size() < 2)
+    return Os;
+  Os << "Statistics over " << Res.Wall.size() << " runs (seconds)\n";
+  dump_stats(Os, "Measured time", Res.WallStats);
+  dump_stats(Os, "Pure execution time", Res.EvtStats);
+  // only if copies are part of execution time
+  if (Res.KernelStats.Median > 0 &&
+      Res.KernelStats.Median < Res.EvtStats.Median)
+    dump_stats(Os, "Kernel time (no copies)", Res.KernelStats);
+  return Os;
+}
+
+// variants of one family run side by side on same data (see registry.hpp)
+using VariantResults = std::vector<std::pair<std::string, BenchResult>>;
+
+// relative is execution time to execution time of first variant
+template <typename OsTy>
+OsTy &dump_comparison(OsTy &Os, const VariantResults &Results) {
+  if (Results.size() < 2)
+    return Os;
+  double Base = Results.front().second.EvtStats.Median;
+  Os << "Variants comparison (median seconds)\n";
+  for (auto &&[Name, Res] : Results) {
+    Os << Name << ": measured = " << SecFmt{Res.WallStats.Median}
+       << ", exec = " << SecFmt{Res.EvtStats.Median};
+    if (Base > 0)
+      Os << ", relative = " << Res.EvtStats.Median / Base;
+    Os << "\n";
+  }
+  return Os;
+}
+
+// Parsed options with lists or ranges (see sweep.hpp) give many configs,
+// test sequence runs all of them in one process with one queue
+// Read(OptParser) shall read config for currently selected point
+template <typename ParserT, typename ReadF>
+auto sweep_configs(ParserT &OptParser, ReadF Read) {
+  std::vector<decltype(Read(OptParser))> Cfgs;
+  for (auto &&Point : OptParser.sweep_points()) {
+    OptParser.select(Point);
+    Cfgs.push_back(Read(OptParser));
+  }
+  return Cfgs;
+}
+
+inline void dump_sweep_point(size_t Idx, size_t Total) {
+  if (Total > 1)
+    qout << "Sweep point " << Idx + 1 << " of " << Total << "\n";
+}
+
+// called right before input of sweep point is made: its data depends only
+// on its own seed, not on points before it
+inline void reseed(const BenchConfig &BCfg) { set_seed(BCfg.Seed); }
+
+// tolerances from command line over family default
+inline Tolerance verify_tolerance(const BenchConfig &BCfg, Tolerance Default) {
+  if (BCfg.VerifyAbs >= 0)
+    Default.Abs = BCfg.VerifyAbs;
+  if (BCfg.VerifyRel >= 0)
+    Default.Rel = BCfg.VerifyRel;
+  if (BCfg.VerifyUlp >= 0)
+    Default.Ulp = BCfg.VerifyUlp;
+  return Default;
+}
+
+// Ref is host result, compares all N elements and reports before throwing
+template <typename T>
+void check_result(std::string Name, const T *Ref, const T *Res, size_t N,
+                  const BenchConfig &BCfg, Tolerance Default = {}) {
+  auto R = verify(Ref, Res, N, verify_tolerance(BCfg, Default));
+  dump_verify(qout, Name, R);
+  if (!R.ok())
+    throw std::runtime_error("Verification failed: " + Name + ", " +
+                             std::to_string(R.Mismatches) + " mismatches");
+}
+
+// saves or checks baseline, throws on regression after report
+// Key is device name, family, variant and config (see baseline.hpp)
+inline void baseline_step(const BenchConfig &BCfg, const std::string &Key,
+                          const BenchResult &Res) {
+  const auto &Samples = Res.EvtStats.Median > 0 ? Res.Evt : Res.Wall;
+  if (!BCfg.SaveBase.empty()) {
+    BaselineStore{BCfg.SaveBase}.store(Key, Samples);
+    qout << "Baseline saved to " << BCfg.SaveBase << "\n";
+  }
+  if (BCfg.CheckBase.empty())
+    return;
+  auto Base = BaselineStore{BCfg.CheckBase}.find(Key);
+  if (!Base) {
+    qout << "Baseline: no entry for this run\n";
+    return;
+  }
+  auto Verdict = compare_baseline(*Base, Samples, BCfg.RegressPct);
+  dump_verdict(qout, Verdict);
+  if (Verdict.Regressed)
+    throw std::runtime_error(
+        "Performance regression against " + BCfg.CheckBase + ": median " +
+        std::to_string(Verdict.Median / Verdict.BaseMedian) + "x of baseline");
+}
+
+// Cfg is family config with Bench member, record_config(Cfg, Rec) is found
+// in family namespace by ADL
+template <typename CfgT>
+void report_result(std::string Family, const CfgT &Cfg, sycl::device D,
+                   const BenchResult &Res) {
+  const BenchConfig &BCfg = Cfg.Bench;
+  if (BCfg.ReportFile.empty() && BCfg.SaveBase.empty() &&
+      BCfg.CheckBase.empty())
+    return;
+  ResultRecord Rec;
+  Rec.add("run", "family", Family);
+  Rec.add("run", "program", BCfg.Program);
+  Rec.add("run", "reps", BCfg.Reps);
+  Rec.add("run", "warmup", BCfg.Warmup);
+  Rec.add("run", "seed", BCfg.Seed);
+  record_device(Rec, D);
+  record_config(Cfg, Rec);
+  Rec.add_stats("wall", Res.WallStats);
+  Rec.add_stats("exec", Res.EvtStats);
+  Rec.add_stats("kernel", Res.KernelStats);
+  record_roofline(Rec, Res.Work, run_seconds(Res), Res.Peaks);
+  auto Pool = usm_pool().stats(); // cumulative within process
+  Rec.add("pool", "hits", Pool.Hits);
+  Rec.add("pool", "misses", Pool.Misses);
+  Rec.add("pool", "peak_bytes", Pool.PeakBytes);
+  Rec.add("memory", "peak_rss", Res.PeakRss);
+  if (Res.Hw)
+    for (int E = 0; E < HW_NUM_EVENTS; ++E)
+      if (Res.Hw->Valid[E])
+        Rec.add("hwc", hw_event_name(E), Res.Hw->Values[E]);
+  Rec.add_array("samples", "wall", Res.Wall);
+  Rec.add_array("samples", "exec", Res.Evt);
+  Rec.add_array("samples", "kernel", Res.Kernel);
+  if (!BCfg.ReportFile.empty())
+    write_report(BCfg.ReportFile, Rec);
+  if (BCfg.SaveBase.empty() && BCfg.CheckBase.empty())
+    return;
+  auto Variant = std::filesystem::path(BCfg.Program).stem().string();
+  baseline_step(BCfg,
+                D.template get_info<info::device::name>() + '\t' + Family +
+                    '\t' + Variant + '\t' + Rec.section("config"),
+                Res);
+}
+
 template <typename OsTy> OsTy &print_info(OsTy &Os, sycl::device D) {
   auto Name = D.template get_info<info::device::name>();
   auto Version = D.template get_info<info::device::version>();
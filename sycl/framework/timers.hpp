@@ -2,6 +2,15 @@
 //
 // Generic code for timer and event timing
 //
+// All durations are nanoseconds in 64-bit unsigned (nsec_t): 2^64 ns is
+// more than 500 years, so neither host nor device accumulation can wrap
+//
+// ScopedTimer is RAII region: it measures lifetime of its scope, regions may
+// nest, finished regions are collected in RegionLog (with nesting depth)
+//
+// EventLog (when enabled) collects every event passed through getTime with
+// host enqueue stamp and device submit/start/end, see dump_latency
+//
 //------------------------------------------------------------------------------
 //
 // This file is licensed after LGPL v3
@@ -11,8 +20,21 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
 #include <CL/sycl.hpp>
 
+#include "qstream.hpp"
 #include "syclconst.hpp"
 
 namespace chrono = std::chrono;
@@ -24,8 +46,22 @@ static const double nsec_per_sec = msec_per_sec * msec_per_sec * msec_per_sec;
 
 namespace sycltesters {
 
+using nsec_t = std::uint64_t;
+
+// what every tester calculate() returns: {host nsec, summed device nsec}
+using Timing_t = std::pair<nsec_t, nsec_t>;
+
+using Clock_t = chrono::steady_clock;
+
+// nanoseconds since first call: common time base for all host regions
+inline nsec_t now_ns() {
+  static const Clock_t::time_point Epoch = Clock_t::now();
+  auto Elps = Clock_t::now() - Epoch;
+  return chrono::duration_cast<chrono::nanoseconds>(Elps).count();
+}
+
 class Timer {
-  chrono::high_resolution_clock::time_point Start, Fin;
+  nsec_t Start = 0, Fin = 0;
   bool Started = false;
 
 public:
@@ -33,33 +69,165 @@ public:
   void start() {
     assert(!Started);
     Started = true;
-    Start = chrono::high_resolution_clock::now();
+    Start = now_ns();
   }
   void stop() {
     assert(Started);
     Started = false;
-    Fin = chrono::high_resolution_clock::now();
+    Fin = now_ns();
   }
-  unsigned elapsed() {
+  nsec_t started_at() const { return Start; }
+  nsec_t elapsed() const {
     assert(!Started);
-    auto Elps = Fin - Start;
-    auto Msec = chrono::duration_cast<chrono::milliseconds>(Elps);
-    return Msec.count();
+    return Fin - Start;
+  }
+};
+
+struct RegionRecord {
+  std::string Name;
+  unsigned Depth; // 0 for outermost
+  nsec_t Start, Duration;
+};
+
+// finished regions from all threads, added and read under lock
+class RegionLog {
+  std::mutex Mutex_;
+  std::vector<RegionRecord> Records_;
+
+public:
+  void add(RegionRecord Rec) {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    Records_.push_back(std::move(Rec));
+  }
+
+  std::vector<RegionRecord> records() {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    return Records_;
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    Records_.clear();
+  }
+
+  static unsigned &depth() {
+    thread_local unsigned Depth = 0;
+    return Depth;
+  }
+};
+
+inline RegionLog &region_log() {
+  static RegionLog Log;
+  return Log;
+}
+
+// Usage: { ScopedTimer T{"init"}; ... } or ScopedTimer T{"x", &Acc}
+// to add region duration to Acc on exit
+class ScopedTimer {
+  std::string Name_;
+  nsec_t *Acc_;
+  unsigned Depth_;
+  Timer Timer_;
+
+public:
+  explicit ScopedTimer(std::string Name, nsec_t *Acc = nullptr)
+      : Name_(std::move(Name)), Acc_(Acc), Depth_(RegionLog::depth()++) {
+    Timer_.start();
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  ~ScopedTimer() {
+    Timer_.stop();
+    RegionLog::depth() -= 1;
+    auto Elapsed = Timer_.elapsed();
+    if (Acc_)
+      *Acc_ += Elapsed;
+    region_log().add({std::move(Name_), Depth_, Timer_.started_at(), Elapsed});
   }
 };
 
+// print seconds with nanosecond resolution, stream format not affected
+struct SecFmt {
+  double Sec;
+};
+
+inline std::ostream &operator<<(std::ostream &Os, SecFmt S) {
+  auto Flags = Os.flags();
+  auto Prec = Os.precision();
+  Os << std::fixed << std::setprecision(9) << S.Sec;
+  Os.flags(Flags);
+  Os.precision(Prec);
+  return Os;
+}
+
+inline SecFmt sec_fmt(nsec_t Nsec) { return {Nsec / nsec_per_sec}; }
+
+// Host_ is host time when event is wrapped, i.e. right after submit returned
 struct NamedEvent {
   sycl::event Evt_;
   std::string Name_;
+  nsec_t Host_;
   NamedEvent(sycl::event Evt, std::string Name = "Unnamed")
-      : Evt_(Evt), Name_(std::move(Name)) {}
+      : Evt_(Evt), Name_(std::move(Name)), Host_(now_ns()) {}
 };
 
 using EvtVec_t = std::vector<NamedEvent>;
+
+// transfers are named "Copy ...", everything else is device work
+inline bool is_copy(const std::string &Name) {
+  return Name.compare(0, 4, "Copy") == 0;
+}
 using EvtRet_t = std::optional<EvtVec_t>;
 
-inline unsigned long long getTime(EvtRet_t Opt, bool Quiet = true) {
-  unsigned long long AccTime = 0;
+// Host is in now_ns() time base, other stamps are in device time base
+struct EvtRecord {
+  std::string Name;
+  unsigned Run;
+  nsec_t Host, Submit, Start, End;
+};
+
+class EventLog {
+  std::mutex Mutex_;
+  std::vector<EvtRecord> Records_;
+  std::atomic<bool> Enabled_ = false;
+  unsigned Run_ = 0;
+
+public:
+  bool enabled() const { return Enabled_.load(); }
+  void enable(bool Enabled) { Enabled_.store(Enabled); }
+
+  // all events added after this call belong to next run
+  void next_run() {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    Run_ += 1;
+  }
+
+  void add(const NamedEvent &NEvt, nsec_t Submit, nsec_t Start, nsec_t End) {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    Records_.push_back({NEvt.Name_, Run_, NEvt.Host_, Submit, Start, End});
+  }
+
+  std::vector<EvtRecord> records() {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    return Records_;
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    Records_.clear();
+    Run_ = 0;
+  }
+};
+
+inline EventLog &event_log() {
+  static EventLog Log;
+  return Log;
+}
+
+inline nsec_t getTime(EvtRet_t Opt, bool Quiet = true) {
+  nsec_t AccTime = 0;
   int EvtIdx = 0;
   if (!Opt.has_value())
     return AccTime;
@@ -74,14 +242,80 @@ inline unsigned long long getTime(EvtRet_t Opt, bool Quiet = true) {
       qout << " [...] ";
       Evt.wait();
     }
-    auto Start = Evt.template get_profiling_info<EvtStart>();
-    auto End = Evt.template get_profiling_info<EvtEnd>();
+    nsec_t Start = Evt.template get_profiling_info<EvtStart>();
+    nsec_t End = Evt.template get_profiling_info<EvtEnd>();
+    if (event_log().enabled())
+      event_log().add(NEvt, Evt.template get_profiling_info<EvtSubmit>(), Start,
+                      End);
     auto Elapsed = End - Start;
     AccTime += Elapsed;
-    qout << Elapsed / nsec_per_sec << " : " << AccTime / nsec_per_sec << "\n";
+    qout << sec_fmt(Elapsed) << " : " << sec_fmt(AccTime) << "\n";
   }
   qout.set(Old);
   return AccTime;
 }
 
+// Per command:
+//   queued = start - submit : total time in device queue (includes waiting
+//                             for dependencies)
+//   launch = start - max(submit, end of all previous commands in this run) :
+//                             part of queued time when device had nothing
+//                             else to do, i.e. pure launch overhead
+//   exec = end - start
+//   host = host enqueue stamp relative to first command in this run
+// Then totals per command name in order of first appearance
+template <typename OsTy>
+OsTy &dump_latency(OsTy &Os, const std::vector<EvtRecord> &Records) {
+  struct Totals {
+    std::string Name;
+    unsigned Count = 0;
+    nsec_t Queued = 0, Launch = 0, Exec = 0;
+  };
+  std::vector<Totals> PerName;
+  Totals All{"All commands"};
+
+  Os << "Latency breakdown (seconds)\n";
+  nsec_t HostBase = 0, PrevEnd = 0;
+  int EvtIdx = 0;
+  for (size_t I = 0; I < Records.size(); ++I) {
+    const auto &Rec = Records[I];
+    bool NewRun = (I == 0) || (Records[I - 1].Run != Rec.Run);
+    if (NewRun) {
+      HostBase = Rec.Host;
+      PrevEnd = 0;
+      EvtIdx = 0;
+    }
+    nsec_t Queued = Rec.Start > Rec.Submit ? Rec.Start - Rec.Submit : 0;
+    nsec_t Ready = std::max(Rec.Submit, PrevEnd);
+    nsec_t Launch = Rec.Start > Ready ? Rec.Start - Ready : 0;
+    nsec_t Exec = Rec.End - Rec.Start;
+    PrevEnd = std::max(PrevEnd, Rec.End);
+
+    Os << Rec.Run << "." << EvtIdx++ << " (" << Rec.Name
+       << "): host = " << sec_fmt(Rec.Host - HostBase)
+       << ", queued = " << sec_fmt(Queued) << ", launch = " << sec_fmt(Launch)
+       << ", exec = " << sec_fmt(Exec) << "\n";
+
+    auto It = std::find_if(PerName.begin(), PerName.end(), [&Rec](auto &&T) {
+      return T.Name == Rec.Name;
+    });
+    if (It == PerName.end())
+      It = PerName.insert(PerName.end(), Totals{Rec.Name});
+    for (auto *T : {&*It, &All}) {
+      T->Count += 1;
+      T->Queued += Queued;
+      T->Launch += Launch;
+      T->Exec += Exec;
+    }
+  }
+
+  Os << "Totals per command name\n";
+  PerName.push_back(All);
+  for (auto &&T : PerName)
+    Os << T.Name << " [" << T.Count << "]: queued = " << sec_fmt(T.Queued)
+       << ", launch = " << sec_fmt(T.Launch) << ", exec = " << sec_fmt(T.Exec)
+       << "\n";
+  return Os;
+}
+
 } // namespace sycltesters
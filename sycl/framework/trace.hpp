@@ -0,0 +1,211 @@
+//------------------------------------------------------------------------------
+//
+// Chrome trace (chrome://tracing, ui.perfetto.dev) export
+//
+// Every measurement (one run_bench) is appended to trace file of process as
+// its own pair of processes: host regions (ScopedTimer) go to "Host", one
+// thread per nesting depth, device commands (EventLog) go to "Device",
+// queued time and execution are separate slices. So sweep points and
+// variants of sycl_bench are separate tracks of one file, written once and
+// closed at exit.
+//
+// Device clock is not host clock, so every run is aligned separately: first
+// command submit of run I is placed at start of host region "Run I"
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "timers.hpp"
+
+namespace sycltesters {
+
+inline std::string json_escape(const std::string &S) {
+  std::string Ret;
+  for (char C : S) {
+    switch (C) {
+    case '"':
+      Ret += "\\\"";
+      break;
+    case '\\':
+      Ret += "\\\\";
+      break;
+    case '\n':
+      Ret += "\\n";
+      break;
+    case '\t':
+      Ret += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(C) < 0x20)
+        continue; // other control chars not expected in names
+      Ret += C;
+    }
+  }
+  return Ret;
+}
+
+enum TracePid { TRACE_HOST = 0, TRACE_DEVICE = 1 };
+enum TraceTid { TRACE_QUEUED = 0, TRACE_EXEC = 1 };
+
+class ChromeTrace {
+  std::ostream &Os_;
+  bool First_ = true;
+
+  // chrome trace wants microseconds, fractional part is allowed
+  static double us(int64_t Nsec) { return Nsec / 1000.0; }
+
+  void sep() {
+    Os_ << (First_ ? "\n" : ",\n");
+    First_ = false;
+  }
+
+public:
+  explicit ChromeTrace(std::ostream &Os) : Os_(Os) {
+    Os_ << "{\"traceEvents\":[";
+  }
+  ~ChromeTrace() { Os_ << "\n]}\n"; }
+
+  ChromeTrace(const ChromeTrace &) = delete;
+  ChromeTrace &operator=(const ChromeTrace &) = delete;
+
+  void name_process(int Pid, const std::string &Name) {
+    sep();
+    Os_ << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << Pid
+        << ",\"tid\":0,\"args\":{\"name\":\"" << json_escape(Name) << "\"}}";
+  }
+
+  void name_thread(int Pid, int Tid, const std::string &Name) {
+    sep();
+    Os_ << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << Pid
+        << ",\"tid\":" << Tid << ",\"args\":{\"name\":\"" << json_escape(Name)
+        << "\"}}";
+  }
+
+  // complete event: Start and Dur in nanoseconds
+  void slice(int Pid, int Tid, const std::string &Name, const std::string &Cat,
+             int64_t Start, int64_t Dur) {
+    sep();
+    Os_ << "{\"name\":\"" << json_escape(Name) << "\",\"cat\":\"" << Cat
+        << "\",\"ph\":\"X\",\"pid\":" << Pid << ",\"tid\":" << Tid
+        << ",\"ts\":" << us(Start) << ",\"dur\":" << us(Dur) << "}";
+  }
+};
+
+// run regions of run_bench are "Run <i>", device commands are aligned to them
+inline std::map<unsigned, int64_t>
+run_starts(const std::vector<RegionRecord> &Regions) {
+  std::map<unsigned, int64_t> Starts;
+  const std::string Prefix = "Run ";
+  for (auto &&Reg : Regions)
+    if (Reg.Name.compare(0, Prefix.size(), Prefix) == 0)
+      Starts[std::stoul(Reg.Name.substr(Prefix.size()))] = Reg.Start;
+  return Starts;
+}
+
+// one measurement as processes HostPid (host) and HostPid + 1 (device)
+inline void append_chrome_trace(ChromeTrace &Trace, int HostPid,
+                                const std::string &Label,
+                                const std::vector<RegionRecord> &Regions,
+                                const std::vector<EvtRecord> &Events) {
+  const int DevPid = HostPid + 1;
+  const std::string Suffix = Label.empty() ? "" : " " + Label;
+  Trace.name_process(HostPid, "Host" + Suffix);
+  Trace.name_process(DevPid, "Device" + Suffix);
+  Trace.name_thread(DevPid, TRACE_QUEUED, "Queued");
+  Trace.name_thread(DevPid, TRACE_EXEC, "Execution");
+
+  for (auto &&Reg : Regions)
+    Trace.slice(HostPid, Reg.Depth, Reg.Name, "host", Reg.Start,
+                Reg.Duration);
+
+  // no run region (not from run_bench): fall back to host enqueue stamp
+  auto Starts = run_starts(Regions);
+  int64_t Offset = 0;
+  for (size_t I = 0; I < Events.size(); ++I) {
+    const auto &Rec = Events[I];
+    if (I == 0 || Events[I - 1].Run != Rec.Run) {
+      auto It = Starts.find(Rec.Run);
+      int64_t Anchor = It != Starts.end() ? It->second
+                                          : static_cast<int64_t>(Rec.Host);
+      Offset = Anchor - static_cast<int64_t>(Rec.Submit);
+    }
+    int64_t Submit = Rec.Submit + Offset;
+    int64_t Start = Rec.Start + Offset;
+    if (Rec.Start > Rec.Submit)
+      Trace.slice(DevPid, TRACE_QUEUED, Rec.Name, "queued", Submit,
+                  Rec.Start - Rec.Submit);
+    Trace.slice(DevPid, TRACE_EXEC, Rec.Name, "exec", Start,
+                Rec.End - Rec.Start);
+  }
+}
+
+inline void write_chrome_trace(std::ostream &Os,
+                               const std::vector<RegionRecord> &Regions,
+                               const std::vector<EvtRecord> &Events) {
+  auto Flags = Os.flags();
+  Os << std::fixed;
+  {
+    ChromeTrace Trace{Os};
+    append_chrome_trace(Trace, TRACE_HOST, "", Regions, Events);
+  }
+  Os.flags(Flags);
+}
+
+// trace file open for whole process, measurements are appended as they
+// finish, closing bracket is written at exit
+class TraceFile {
+  std::mutex Mutex_;
+  std::ofstream Os_;
+  std::optional<ChromeTrace> Trace_; // after Os_: closed before file
+  int Count_ = 0;
+
+public:
+  explicit TraceFile(const std::string &FileName) : Os_(FileName) {
+    if (!Os_.is_open())
+      throw std::runtime_error("Can not open trace file: " + FileName);
+    Os_ << std::fixed;
+    Trace_.emplace(Os_);
+  }
+
+  // Label names tracks, i.e. variant; measurements are also numbered
+  void append(const std::string &Label,
+              const std::vector<RegionRecord> &Regions,
+              const std::vector<EvtRecord> &Events) {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    std::string Name = "#" + std::to_string(Count_);
+    if (!Label.empty())
+      Name += " " + Label;
+    append_chrome_trace(*Trace_, 2 * Count_, Name, Regions, Events);
+    Count_ += 1;
+    Os_.flush();
+  }
+};
+
+inline TraceFile &trace_file(const std::string &FileName) {
+  static std::mutex Mutex;
+  static std::map<std::string, std::unique_ptr<TraceFile>> Files;
+  std::lock_guard<std::mutex> Lock{Mutex};
+  auto &File = Files[FileName];
+  if (!File)
+    File = std::make_unique<TraceFile>(FileName);
+  return *File;
+}
+
+} // namespace sycltesters
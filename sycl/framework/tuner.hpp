@@ -0,0 +1,286 @@
+//------------------------------------------------------------------------------
+//
+// Work-group size tuner with per-device tuning database
+//
+// Family describes its tunable sizes (tune_space in family namespace):
+// parameters bound to config fields with candidate values, and legality
+// check of current values against device limits (max_work_group_size,
+// local_mem_size) and problem sizes:
+//
+//   auto Space = hist::tune_space<Ty>(Q.get_device(), Cfg);
+//   tune_config(Q, Cfg.Bench, Space, [&] { return Tester.calculate(); });
+//
+// (tune_config in testers.hpp measures with run_bench and calls apply_tuning)
+//
+// With -tune every legal combination of candidates is measured (best of
+// TUNE_REPS runs) and winner is stored in tuning database (-tunedb=<file>)
+// keyed by device name, driver version and variant. Without -tune values
+// from database replace built-in defaults. Options given in command line
+// are never tuned nor overridden.
+//
+// Database is text file, one line per device and variant, tab separated:
+//   <device>\t<driver>\t<variant>\tgsz=65536 lsz=32
+// Values are in config units (say gsz is in elements, not in blocks)
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+#include "qstream.hpp"
+#include "syclconst.hpp"
+#include "timers.hpp"
+
+namespace sycltesters {
+
+constexpr const char *DEF_TUNEDB = "sycl_tuning.txt";
+constexpr int TUNE_REPS = 3;
+
+// Get and Set are bound to field of family config
+struct TuneParam {
+  std::string Name; // option name
+  std::function<int()> Get;
+  std::function<void(int)> Set;
+  std::vector<int> Candidates;
+};
+
+template <typename T>
+TuneParam tune_param(std::string Name, T &Field, std::vector<int> Candidates) {
+  return {std::move(Name), [&Field] { return static_cast<int>(Field); },
+          [&Field](int V) { Field = static_cast<T>(V); },
+          std::move(Candidates)};
+}
+
+struct TuneSpace {
+  std::vector<TuneParam> Params;
+  std::function<bool()> Legal; // for current values of params
+};
+
+// powers of two in [Min, Max], multiplied by Scale
+inline std::vector<int> pow2_candidates(int Min, int Max, int Scale = 1) {
+  std::vector<int> Res;
+  for (long long V = Min; V <= Max; V *= 2)
+    Res.push_back(static_cast<int>(V * Scale));
+  return Res;
+}
+
+// device limits to check legality against
+struct DeviceLimits {
+  size_t MaxWG, LocalMem;
+};
+
+inline DeviceLimits device_limits(sycl::device D) {
+  return {D.template get_info<info::device::max_work_group_size>(),
+          static_cast<size_t>(
+              D.template get_info<info::device::local_mem_size>())};
+}
+
+using TunedValues = std::map<std::string, int>;
+
+// device name and driver: other driver may have other winners
+inline std::string tuning_key(sycl::device D, const std::string &Program) {
+  auto Name = D.template get_info<info::device::name>();
+  auto Driver = D.template get_info<info::device::driver_version>();
+  // variant is executable name without path and extension
+  auto Variant = std::filesystem::path(Program).stem().string();
+  return Name + '\t' + Driver + '\t' + Variant;
+}
+
+class TuningDb {
+  std::string File_;
+  std::map<std::string, TunedValues> Entries_;
+
+  static TunedValues parse_values(const std::string &S) {
+    TunedValues Values;
+    std::istringstream Is{S};
+    std::string Item;
+    while (Is >> Item) {
+      auto Eq = Item.find('=');
+      if (Eq == Item.npos)
+        throw std::runtime_error("Malformed tuning entry: " + Item);
+      Values[Item.substr(0, Eq)] = std::stoi(Item.substr(Eq + 1));
+    }
+    return Values;
+  }
+
+public:
+  // missing file is empty database
+  explicit TuningDb(std::string File) : File_(std::move(File)) {
+    std::ifstream Is{File_};
+    std::string Line;
+    while (std::getline(Is, Line)) {
+      auto Pos = Line.rfind('\t');
+      if (Line.empty() || Pos == Line.npos)
+        continue;
+      Entries_[Line.substr(0, Pos)] = parse_values(Line.substr(Pos + 1));
+    }
+  }
+
+  std::optional<TunedValues> find(const std::string &Key) const {
+    auto It = Entries_.find(Key);
+    if (It == Entries_.end())
+      return std::nullopt;
+    return It->second;
+  }
+
+  // merges with stored values (other params may be tuned separately)
+  void store(const std::string &Key, const TunedValues &Values) {
+    for (auto &&[Name, Val] : Values)
+      Entries_[Key][Name] = Val;
+    std::ofstream Os{File_};
+    if (!Os)
+      throw std::runtime_error("Can not write tuning database: " + File_);
+    for (auto &&[K, Vals] : Entries_) {
+      Os << K << '\t';
+      for (auto &&[Name, Val] : Vals)
+        Os << Name << '=' << Val << ' ';
+      Os << '\n';
+    }
+  }
+};
+
+// tunable options given in command line
+template <typename ParserT>
+std::set<std::string> given_options(const ParserT &OptParser,
+                                    std::initializer_list<const char *> Names) {
+  std::set<std::string> Given;
+  for (auto *Name : Names)
+    if (OptParser.exists(Name))
+      Given.insert(Name);
+  return Given;
+}
+
+template <typename OsTy>
+OsTy &dump_tuned(OsTy &Os, const std::vector<TuneParam> &Params) {
+  for (auto &&P : Params)
+    Os << " " << P.Name << "=" << P.Get();
+  return Os;
+}
+
+namespace detail {
+
+inline TunedValues current_values(const std::vector<TuneParam> &Params) {
+  TunedValues Values;
+  for (auto &&P : Params)
+    Values[P.Name] = P.Get();
+  return Values;
+}
+
+inline void set_values(std::vector<TuneParam> &Params,
+                       const TunedValues &Values) {
+  for (auto &&P : Params) {
+    auto It = Values.find(P.Name);
+    if (It != Values.end())
+      P.Set(It->second);
+  }
+}
+
+// odometer over candidates, false when all combinations visited
+inline bool next_point(std::vector<TuneParam> &Params,
+                       std::vector<size_t> &Idx) {
+  for (size_t I = 0; I < Params.size(); ++I) {
+    if (++Idx[I] < Params[I].Candidates.size()) {
+      Params[I].Set(Params[I].Candidates[Idx[I]]);
+      return true;
+    }
+    Idx[I] = 0;
+    Params[I].Set(Params[I].Candidates[0]);
+  }
+  return false;
+}
+
+// Measure() gives seconds for current values, returns winner values
+template <typename MeasureF>
+TunedValues search(std::vector<TuneParam> &Params,
+                   const std::function<bool()> &Legal, MeasureF Measure) {
+  std::vector<size_t> Idx(Params.size(), 0);
+  for (auto &&P : Params)
+    P.Set(P.Candidates.front());
+  double Best = std::numeric_limits<double>::max();
+  TunedValues Winner;
+  do {
+    if (!Legal())
+      continue;
+    dump_tuned(qout << "Trying", Params);
+    try {
+      double Sec = Measure();
+      qout << ": " << SecFmt{Sec} << std::endl;
+      if (Sec < Best) {
+        Best = Sec;
+        Winner = current_values(Params);
+      }
+    } catch (sycl::exception const &Err) {
+      // limits of particular kernel may be below device limits
+      qout << ": failed (" << Err.what() << ")" << std::endl;
+    }
+  } while (next_point(Params, Idx));
+  if (Winner.empty())
+    throw std::runtime_error("No legal work-group sizes to tune");
+  return Winner;
+}
+
+} // namespace detail
+
+// Sets tunable fields of config: tuned if Tune, from database otherwise
+// Given are options from command line, they are left as is
+template <typename MeasureF>
+void apply_tuning(TuneSpace Space, const std::set<std::string> &Given,
+                  bool Tune, const std::string &DbFile, const std::string &Key,
+                  MeasureF Measure) {
+  auto &Params = Space.Params;
+  Params.erase(std::remove_if(Params.begin(), Params.end(),
+                              [&](const TuneParam &P) {
+                                return Given.count(P.Name) > 0 ||
+                                       P.Candidates.empty();
+                              }),
+               Params.end());
+  if (Params.empty())
+    return;
+  TuningDb Db{DbFile};
+
+  if (!Tune) {
+    auto Found = Db.find(Key);
+    if (!Found)
+      return;
+    auto Defaults = detail::current_values(Params);
+    detail::set_values(Params, *Found);
+    if (!Space.Legal()) {
+      qout << "Tuned sizes are not legal for this problem, using defaults"
+           << std::endl;
+      detail::set_values(Params, Defaults);
+      return;
+    }
+    dump_tuned(qout << "Tuned defaults:", Params) << std::endl;
+    return;
+  }
+
+  qout << "Tuning" << std::endl;
+  auto Winner = detail::search(Params, Space.Legal, Measure);
+  detail::set_values(Params, Winner);
+  Db.store(Key, Winner);
+  dump_tuned(qout << "Tuned:", Params)
+      << " (saved to " << DbFile << ")" << std::endl;
+}
+
+} // namespace sycltesters
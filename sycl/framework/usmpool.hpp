@@ -0,0 +1,188 @@
+//------------------------------------------------------------------------------
+//
+// Caching pool of USM allocations
+//
+// Variants allocate and free device, shared or host memory on every call,
+// so repeated runs measure runtime allocator and first touch. Pool keeps
+// freed blocks in free lists per queue and per usm::alloc kind, bucketed
+// by size rounded up to power of two, and gives them back on next request:
+//
+//   T *A = sycltesters::pool_malloc_device<T>(Sz, Q);
+//   ...
+//   sycltesters::pool_free(A, Q);
+//
+// Memory is returned to runtime only by usm_pool().clear() (and at exit).
+// Block content is not preserved nor zeroed, as with plain malloc.
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+namespace sycltesters {
+
+struct PoolStats {
+  unsigned long Hits = 0, Misses = 0;
+  size_t HeldBytes = 0, PeakBytes = 0; // allocated from runtime
+  size_t LiveBytes = 0;                // given out and not yet freed
+};
+
+class UsmPool {
+  static constexpr size_t MIN_BUCKET = 256;
+
+  // bucket size -> free blocks
+  using FreeLists = std::map<size_t, std::vector<void *>>;
+
+  struct Slot {
+    sycl::queue Q;
+    sycl::usm::alloc Kind;
+    FreeLists Free;
+  };
+
+  struct Block {
+    size_t SlotIdx, Bucket;
+  };
+
+  mutable std::mutex Mutex_;
+  // queues are few (usually one): linear search is fine
+  std::vector<Slot> Slots_;
+  std::unordered_map<void *, Block> Live_;
+  PoolStats Stats_;
+
+  size_t slot(const sycl::queue &Q, sycl::usm::alloc Kind) {
+    for (size_t I = 0; I < Slots_.size(); ++I)
+      if (Slots_[I].Q == Q && Slots_[I].Kind == Kind)
+        return I;
+    Slots_.push_back({Q, Kind, {}});
+    return Slots_.size() - 1;
+  }
+
+  static size_t bucket(size_t Bytes) {
+    return std::bit_ceil(std::max(Bytes, MIN_BUCKET));
+  }
+
+public:
+  UsmPool() = default;
+  UsmPool(const UsmPool &) = delete;
+  UsmPool &operator=(const UsmPool &) = delete;
+
+  // nullptr if runtime can not allocate, as sycl::malloc does
+  void *allocate(size_t Bytes, sycl::queue &Q, sycl::usm::alloc Kind) {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    size_t Idx = slot(Q, Kind);
+    size_t Bucket = bucket(Bytes);
+    auto &Free = Slots_[Idx].Free[Bucket];
+    void *Ptr = nullptr;
+    if (!Free.empty()) {
+      Ptr = Free.back();
+      Free.pop_back();
+      Stats_.Hits += 1;
+    } else {
+      Ptr = sycl::malloc(Bucket, Q, Kind);
+      if (Ptr == nullptr)
+        return nullptr;
+      Stats_.Misses += 1;
+      Stats_.HeldBytes += Bucket;
+      Stats_.PeakBytes = std::max(Stats_.PeakBytes, Stats_.HeldBytes);
+    }
+    Stats_.LiveBytes += Bucket;
+    Live_.emplace(Ptr, Block{Idx, Bucket});
+    return Ptr;
+  }
+
+  // block goes to free list of its queue and kind, Q is for symmetry with
+  // sycl::free and is checked against owner
+  void release(void *Ptr, const sycl::queue &Q) {
+    if (Ptr == nullptr)
+      return;
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    auto It = Live_.find(Ptr);
+    if (It == Live_.end())
+      throw std::runtime_error("Pointer was not allocated from USM pool");
+    auto [Idx, Bucket] = It->second;
+    if (!(Slots_[Idx].Q == Q))
+      throw std::runtime_error("Pointer is freed with other queue");
+    Live_.erase(It);
+    Stats_.LiveBytes -= Bucket;
+    Slots_[Idx].Free[Bucket].push_back(Ptr);
+  }
+
+  // returns cached blocks to runtime, live blocks are kept
+  void clear() {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    for (auto &&S : Slots_)
+      for (auto &&[Bucket, Blocks] : S.Free) {
+        for (void *Ptr : Blocks)
+          sycl::free(Ptr, S.Q);
+        Stats_.HeldBytes -= Bucket * Blocks.size();
+        Blocks.clear();
+      }
+  }
+
+  PoolStats stats() const {
+    std::lock_guard<std::mutex> Lock{Mutex_};
+    return Stats_;
+  }
+
+  ~UsmPool() {
+    // runtime may be already shutting down: nothing to do about failures
+    try {
+      clear();
+    } catch (...) {
+    }
+  }
+};
+
+inline UsmPool &usm_pool() {
+  static UsmPool Pool;
+  return Pool;
+}
+
+template <typename T>
+T *pool_malloc(size_t Count, sycl::queue &Q, sycl::usm::alloc Kind) {
+  return static_cast<T *>(usm_pool().allocate(Count * sizeof(T), Q, Kind));
+}
+
+template <typename T> T *pool_malloc_device(size_t Count, sycl::queue &Q) {
+  return pool_malloc<T>(Count, Q, sycl::usm::alloc::device);
+}
+
+template <typename T> T *pool_malloc_shared(size_t Count, sycl::queue &Q) {
+  return pool_malloc<T>(Count, Q, sycl::usm::alloc::shared);
+}
+
+template <typename T> T *pool_malloc_host(size_t Count, sycl::queue &Q) {
+  return pool_malloc<T>(Count, Q, sycl::usm::alloc::host);
+}
+
+inline void pool_free(void *Ptr, const sycl::queue &Q) {
+  usm_pool().release(Ptr, Q);
+}
+
+template <typename OsTy> OsTy &dump_pool_stats(OsTy &Os) {
+  auto Stats = usm_pool().stats();
+  if (Stats.Hits + Stats.Misses == 0)
+    return Os;
+  Os << "USM pool: " << Stats.Hits << " hits, " << Stats.Misses
+     << " misses, peak " << Stats.PeakBytes << " bytes\n";
+  return Os;
+}
+
+} // namespace sycltesters
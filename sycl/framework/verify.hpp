@@ -0,0 +1,200 @@
+//------------------------------------------------------------------------------
+//
+// Result verification: reference vs result with tolerances
+//
+// Element passes if any of tolerances holds:
+//   |Ref - Res| <= Abs
+//   |Ref - Res| <= Rel * max(|Ref|, |Res|)
+//   distance in units in the last place <= Ulp (floating point only)
+// All zero is exact comparison. For integers distance is plain difference.
+//
+// Comparison runs on host threads over chunks and does not stop on first
+// mismatch: result has mismatch count, max errors, first and worst index
+// and histogram of distances (bucket 0 is exact, bucket K is [2^(K-1), 2^K))
+// Failure is for caller to decide after report
+//
+//   auto Res = verify(HostC, GPUC, N, Tolerance{0, 1e-5, 4});
+//   dump_verify(qout, "sgemm", Res);
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sycltesters {
+
+struct Tolerance {
+  double Abs = 0, Rel = 0;
+  std::uint64_t Ulp = 0;
+};
+
+constexpr int VERIFY_BUCKETS = 32;
+
+struct VerifyResult {
+  static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+  size_t Count = 0, Mismatches = 0;
+  size_t First = NONE, Worst = NONE; // mismatch indices
+  double MaxAbs = 0, MaxRel = 0;
+  std::uint64_t MaxUlp = 0;
+  std::array<size_t, VERIFY_BUCKETS> Hist{};
+  bool ok() const { return Mismatches == 0; }
+};
+
+namespace detail {
+
+// monotonic integer image of float: adjacent floats differ by one
+template <typename T> auto ordered_bits(T X) {
+  using UTy = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+  constexpr UTy Sign = UTy(1) << (sizeof(T) * 8 - 1);
+  auto U = std::bit_cast<UTy>(X);
+  return (U & Sign) ? UTy(~U) : UTy(U | Sign);
+}
+
+template <typename T> std::uint64_t distance(T A, T B) {
+  if constexpr (std::is_floating_point_v<T>) {
+    if (std::isnan(A) || std::isnan(B))
+      return (std::isnan(A) && std::isnan(B))
+                 ? 0
+                 : std::numeric_limits<std::uint64_t>::max();
+    auto UA = ordered_bits(A), UB = ordered_bits(B);
+    return UA > UB ? UA - UB : UB - UA;
+  } else {
+    return A > B ? std::uint64_t(A - B) : std::uint64_t(B - A);
+  }
+}
+
+inline int bucket(std::uint64_t Dist) {
+  return std::min(static_cast<int>(std::bit_width(Dist)), VERIFY_BUCKETS - 1);
+}
+
+template <typename T>
+bool within(T Ref, T Res, std::uint64_t Dist, double AbsErr,
+            const Tolerance &Tol) {
+  if (Dist == 0 || AbsErr <= Tol.Abs)
+    return true;
+  double Mag = std::max(std::abs(double(Ref)), std::abs(double(Res)));
+  if (AbsErr <= Tol.Rel * Mag)
+    return true;
+  return std::is_floating_point_v<T> && Dist <= Tol.Ulp;
+}
+
+template <typename T>
+VerifyResult verify_range(const T *Ref, const T *Res, size_t From, size_t To,
+                          const Tolerance &Tol) {
+  VerifyResult R;
+  R.Count = To - From;
+  for (size_t I = From; I < To; ++I) {
+    auto Dist = distance(Ref[I], Res[I]);
+    R.Hist[bucket(Dist)] += 1;
+    if (Dist == 0)
+      continue;
+    double AbsErr = std::abs(double(Ref[I]) - double(Res[I]));
+    if (std::isnan(AbsErr))
+      AbsErr = std::numeric_limits<double>::infinity();
+    double Mag = std::max(std::abs(double(Ref[I])), std::abs(double(Res[I])));
+    double RelErr = Mag > 0 ? AbsErr / Mag : 0;
+    if (Dist > R.MaxUlp)
+      R.MaxUlp = Dist;
+    R.MaxRel = std::max(R.MaxRel, RelErr);
+    if (!within(Ref[I], Res[I], Dist, AbsErr, Tol)) {
+      R.Mismatches += 1;
+      if (R.First == R.NONE)
+        R.First = I;
+    }
+    if (AbsErr > R.MaxAbs || R.Worst == R.NONE) {
+      R.MaxAbs = std::max(R.MaxAbs, AbsErr);
+      R.Worst = I;
+    }
+  }
+  return R;
+}
+
+// chunks are merged in order, so First is first over whole range
+inline void merge(VerifyResult &Acc, const VerifyResult &R) {
+  if (Acc.First == Acc.NONE)
+    Acc.First = R.First;
+  if (R.Worst != R.NONE && (Acc.Worst == Acc.NONE || R.MaxAbs > Acc.MaxAbs))
+    Acc.Worst = R.Worst;
+  Acc.Count += R.Count;
+  Acc.Mismatches += R.Mismatches;
+  Acc.MaxAbs = std::max(Acc.MaxAbs, R.MaxAbs);
+  Acc.MaxRel = std::max(Acc.MaxRel, R.MaxRel);
+  Acc.MaxUlp = std::max(Acc.MaxUlp, R.MaxUlp);
+  for (int B = 0; B < VERIFY_BUCKETS; ++B)
+    Acc.Hist[B] += R.Hist[B];
+}
+
+} // namespace detail
+
+// Ref and Res are N elements of arithmetic type
+template <typename T>
+VerifyResult verify(const T *Ref, const T *Res, size_t N,
+                    const Tolerance &Tol = {}) {
+  static_assert(std::is_arithmetic_v<T>, "Expect arithmetic elements");
+  constexpr size_t MinChunk = 1 << 16;
+  size_t NThreads = std::max(1u, std::thread::hardware_concurrency());
+  NThreads = std::min(NThreads, N / MinChunk + 1);
+  if (NThreads == 1)
+    return detail::verify_range(Ref, Res, 0, N, Tol);
+
+  const size_t Chunk = (N + NThreads - 1) / NThreads;
+  std::vector<VerifyResult> Parts((N + Chunk - 1) / Chunk);
+  std::vector<std::thread> Workers;
+  for (size_t P = 0; P < Parts.size(); ++P)
+    Workers.emplace_back([&, P] {
+      size_t From = P * Chunk;
+      Parts[P] = detail::verify_range(Ref, Res, From,
+                                      std::min(From + Chunk, N), Tol);
+    });
+  for (auto &&W : Workers)
+    W.join();
+  VerifyResult Acc;
+  for (auto &&R : Parts)
+    detail::merge(Acc, R);
+  return Acc;
+}
+
+template <typename OsTy>
+OsTy &dump_verify(OsTy &Os, std::string Name, const VerifyResult &R) {
+  Os << "Verify " << Name << ": " << R.Mismatches << " of " << R.Count
+     << " mismatches";
+  if (R.Worst != R.NONE)
+    Os << ", max abs error " << R.MaxAbs << " at " << R.Worst
+       << ", max rel error " << R.MaxRel << ", max ulp " << R.MaxUlp;
+  if (R.First != R.NONE)
+    Os << ", first at " << R.First;
+  Os << "\n";
+  if (R.Worst == R.NONE)
+    return Os;
+  Os << "Distance histogram:";
+  for (int B = 0; B < VERIFY_BUCKETS; ++B) {
+    if (R.Hist[B] == 0)
+      continue;
+    if (B == 0)
+      Os << " 0: ";
+    else if (B == VERIFY_BUCKETS - 1)
+      Os << " >=2^" << B - 1 << ": ";
+    else
+      Os << " <2^" << B << ": ";
+    Os << R.Hist[B];
+  }
+  Os << "\n";
+  return Os;
+}
+
+} // namespace sycltesters
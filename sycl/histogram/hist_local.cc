@@ -40,8 +40,8 @@ public:
     const auto GSZ = Gsz_;
     sycltesters::EvtVec_t ProfInfo;
     auto &DeviceQueue = Queue();
-    auto *BufferData = sycl::malloc_shared<T>(NumData, DeviceQueue);
-    auto *BufferBins = sycl::malloc_shared<T>(NumBins, DeviceQueue);
+    auto *BufferData = sycltesters::pool_malloc_shared<T>(NumData, DeviceQueue);
+    auto *BufferBins = sycltesters::pool_malloc_shared<T>(NumBins, DeviceQueue);
     std::copy(Data, Data + NumData, BufferData);
     std::fill(BufferBins, BufferBins + NumBins, 0);
 
@@ -82,12 +82,16 @@ public:
     DeviceQueue.wait();
 
     std::copy(BufferBins, BufferBins + NumBins, Bins);
-    sycl::free(BufferData, DeviceQueue);
-    sycl::free(BufferBins, DeviceQueue);
+    sycltesters::pool_free(BufferData, DeviceQueue);
+    sycltesters::pool_free(BufferBins, DeviceQueue);
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(hist, "hist_local", HistogrammLocalShared<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<HistogrammLocalShared<int>>(argc, argv);
 }
+#endif
@@ -85,6 +85,10 @@ public:
   }
 };
 
+REGISTER_VARIANT(hist, "hist_local_acc", HistogrammLocalAcc<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<HistogrammLocalAcc<int>>(argc, argv);
 }
+#endif
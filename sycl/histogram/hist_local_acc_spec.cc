@@ -55,15 +55,10 @@ public:
     sycl::range<1> LocalMemorySize{LMEM};
     sycl::nd_range<1> DataSz{GSZ, LSZ};
 
-    sycl::kernel_id KId = sycl::get_kernel_id<hist_local_shared_spec<T>>();
-    sycl::kernel_bundle KbSrc =
-        sycl::get_kernel_bundle<sycl::bundle_state::input>(
-            DeviceQueue.get_context(), {KId});
-    KbSrc.template set_specialization_constant<LSZC>(LSZ);
-    KbSrc.template set_specialization_constant<GSZC>(GSZ);
-    KbSrc.template set_specialization_constant<NumBinsC>(NumBins);
-    KbSrc.template set_specialization_constant<NumDataC>(NumData);
-    sycl::kernel_bundle Kb = sycl::build(KbSrc);
+    // built once per sizes, then taken from cache
+    auto Kb = sycltesters::build_cached<hist_local_shared_spec<T>, LSZC, GSZC,
+                                        NumBinsC, NumDataC>(
+        DeviceQueue, LSZ, GSZ, NumBins, NumData);
 
     auto Evt = DeviceQueue.submit([&](sycl::handler &Cgh) {
       Cgh.use_kernel_bundle(Kb);
@@ -109,6 +104,10 @@ public:
   }
 };
 
+REGISTER_VARIANT(hist, "hist_local_acc_spec", HistogrammLocalAccSpec<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<HistogrammLocalAccSpec<int>>(argc, argv);
 }
+#endif
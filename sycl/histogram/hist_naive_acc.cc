@@ -71,6 +71,10 @@ public:
   }
 };
 
+REGISTER_VARIANT(hist, "hist_naive_acc", HistogrammNaiveBuf<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<HistogrammNaiveBuf<int>>(argc, argv);
 }
+#endif
@@ -51,8 +51,8 @@ public:
     const auto NGSZ = Gsz_ / NumBins;
     sycltesters::EvtVec_t ProfInfo;
     auto &DeviceQueue = Queue();
-    auto *BufferData = sycl::malloc_shared<T>(NumData, DeviceQueue);
-    auto *BufferBins = sycl::malloc_shared<T>(NumBins, DeviceQueue);
+    auto *BufferData = sycltesters::pool_malloc_shared<T>(NumData, DeviceQueue);
+    auto *BufferBins = sycltesters::pool_malloc_shared<T>(NumBins, DeviceQueue);
     std::copy(Data, Data + NumData, BufferData);
     std::fill(BufferBins, BufferBins + NumBins, 0);
     sycl::range<1> DataSz{NGSZ};
@@ -86,12 +86,16 @@ public:
     ProfInfo.emplace_back(EvtCpyBins, "Copy bins back");
     DeviceQueue.wait();
 
-    sycl::free(BufferData, DeviceQueue);
-    sycl::free(BufferBins, DeviceQueue);
+    sycltesters::pool_free(BufferData, DeviceQueue);
+    sycltesters::pool_free(BufferBins, DeviceQueue);
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(hist, "hist_private", HistogrammPrivateShared<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<HistogrammPrivateShared<int>>(argc, argv);
 }
+#endif
@@ -53,8 +53,8 @@ public:
     const int LSZ = Cfg_.LocSz;
     sycltesters::EvtVec_t ProfInfo;
     auto &DeviceQueue = Queue();
-    auto *BufferData = sycl::malloc_shared<T>(NumData, DeviceQueue);
-    auto *BufferBins = sycl::malloc_shared<T>(NumBins, DeviceQueue);
+    auto *BufferData = sycltesters::pool_malloc_shared<T>(NumData, DeviceQueue);
+    auto *BufferBins = sycltesters::pool_malloc_shared<T>(NumBins, DeviceQueue);
     std::copy(Data, Data + NumData, BufferData);
     std::fill(BufferBins, BufferBins + NumBins, 0);
     sycl::range<1> DataSz{NGSZ}, LocSz{LSZ};
@@ -123,12 +123,16 @@ public:
     ProfInfo.emplace_back(EvtCpyBins, "Copy bins back");
     DeviceQueue.wait();
 
-    sycl::free(BufferData, DeviceQueue);
-    sycl::free(BufferBins, DeviceQueue);
+    sycltesters::pool_free(BufferData, DeviceQueue);
+    sycltesters::pool_free(BufferBins, DeviceQueue);
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(hist, "hist_private_sg", HistogrammSubgroupPrivateShared<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<HistogrammSubgroupPrivateShared<int>>(argc, argv);
 }
+#endif
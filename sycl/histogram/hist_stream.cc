@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------------
+//
+// Histogram with local memory, data streamed through device in chunks.
+// Every chunk makes its own bins, host merges them as chunks finish, so
+// data may be larger than device memory (see framework/streaming.hpp)
+//
+// > histogram\hist_stream.exe -sz=100000 -chunk=1048576 -nbuf=3
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+#include "hist_testers.hpp"
+
+using ConfigTy = sycltesters::hist::Config;
+
+// class is used for kernel name
+template <typename T> class hist_stream;
+
+template <typename T>
+class HistogrammStream : public sycltesters::Histogramm<T> {
+  using sycltesters::Histogramm<T>::Queue;
+  ConfigTy Cfg_;
+
+public:
+  HistogrammStream(sycl::queue &DeviceQueue, ConfigTy Cfg)
+      : sycltesters::Histogramm<T>(DeviceQueue), Cfg_(Cfg) {}
+
+  sycltesters::EvtRet_t operator()(const T *Data, T *Bins, int NumData,
+                                   int NumBins) override {
+    assert(Data != nullptr && Bins != nullptr);
+    const unsigned LSZ = Cfg_.LocSz;
+    const unsigned GSZ = Cfg_.GlobSz;
+    const auto &BCfg = Cfg_.Bench;
+    auto &DeviceQueue = Queue();
+    auto Chunk = sycltesters::stream_chunk<T>(DeviceQueue, BCfg.StreamChunk,
+                                              BCfg.StreamBufs, 1, NumData);
+    sycltesters::ChunkStream<T, 1> Stream{DeviceQueue, Chunk, BCfg.StreamBufs};
+
+    // partial bins per slot: on device and copied back for merge
+    std::vector<T *> DevBins(Stream.slots());
+    std::vector<std::vector<T>> HostBins(Stream.slots());
+    for (unsigned S = 0; S < Stream.slots(); ++S) {
+      DevBins[S] = sycltesters::pool_malloc_device<T>(NumBins, DeviceQueue);
+      HostBins[S].resize(NumBins);
+    }
+    std::fill(Bins, Bins + NumBins, 0);
+
+    using LTy = sycl::accessor<T, 1, sycl_read_write, sycl_local>;
+    sycl::range<1> LocalMemorySize{NumBins};
+    sycl::nd_range<1> DataSz{GSZ, LSZ};
+
+    auto Compute = [&](const sycltesters::ChunkInfo &Ch, auto &Dev,
+                       auto &Copies) {
+      const T *BufferData = Dev[0];
+      T *BufferBins = DevBins[Ch.Slot];
+      const int ChunkData = Ch.Size;
+      // events are wrapped right after submit: host stamp is taken there
+      sycltesters::EvtVec_t Evts;
+      auto EvtZero = DeviceQueue.memset(BufferBins, 0, NumBins * sizeof(T));
+      Evts.emplace_back(EvtZero, "Zero chunk bins");
+      auto Evt = DeviceQueue.submit([&](sycl::handler &Cgh) {
+        Cgh.depends_on(Copies);
+        Cgh.depends_on(EvtZero);
+        LTy LocalHist{LocalMemorySize, Cgh};
+        auto KernHist = [=](sycl::nd_item<1> WorkItem) {
+          const int N = WorkItem.get_global_id(0);
+          const int L = WorkItem.get_local_id(0);
+
+          // zero-out local memory
+          for (int I = L; I < NumBins; I += LSZ)
+            LocalHist[I] = 0;
+          WorkItem.barrier(sycl_local_fence);
+
+          // building local histograms
+          for (int I = N; I < ChunkData; I += GSZ) {
+            const T Data = BufferData[I];
+            local_atomic_ref<T>(LocalHist[Data]).fetch_add(1);
+          }
+          WorkItem.barrier(sycl_local_fence);
+
+          // combining all local histograms
+          for (int I = L; I < NumBins; I += LSZ) {
+            const T Data = LocalHist[I];
+            global_atomic_ref<T>(BufferBins[I]).fetch_add(Data);
+          }
+        };
+
+        Cgh.parallel_for<class hist_stream<T>>(DataSz, KernHist);
+      });
+      Evts.emplace_back(Evt, "Calculate chunk histogramm");
+      auto EvtCpyBins =
+          DeviceQueue.copy(BufferBins, HostBins[Ch.Slot].data(), NumBins, Evt);
+      Evts.emplace_back(EvtCpyBins, "Copy chunk bins back");
+      return Evts;
+    };
+
+    auto Merge = [&](const sycltesters::ChunkInfo &Ch) {
+      auto &Part = HostBins[Ch.Slot];
+      for (int I = 0; I < NumBins; ++I)
+        Bins[I] += Part[I];
+    };
+
+    auto ProfInfo = Stream.run({Data}, NumData, Compute, Merge);
+
+    for (unsigned S = Stream.slots(); S > 0; --S)
+      sycltesters::pool_free(DevBins[S - 1], DeviceQueue);
+    return ProfInfo;
+  }
+};
+
+REGISTER_VARIANT(hist, "hist_stream", HistogrammStream<int>);
+
+#ifndef SYCL_BENCH
+int main(int argc, char **argv) {
+  sycltesters::test_sequence<HistogrammStream<int>>(argc, argv);
+}
+#endif
@@ -13,8 +13,12 @@
 // -gsz=<g> : global iteration space (in bsz-units)
 // -lsz=<l> : local iteration space
 // -zero : fill hist with zeroes for debug
+// -data=<file> : binary int dataset (see dataset.hpp), overrides -sz
 // -vis : visualize hist (use wisely) available only in measure_normal
 // -quiet : quiet mode for bulk runs
+// -reps=<n>, -warmup=<w> : measured and warmup runs (see testers.hpp)
+// -tune : tune gsz and lsz for device, tuned are defaults afterwards
+// numeric options may be lists or ranges: -sz=1024..8192:1024 -lsz=16,32
 //
 // Special visualization part:
 // -img=path : path to image to build realistics hist
@@ -44,6 +48,8 @@
 #include <chrono>
 #include <iostream>
 #include <iterator>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <CL/sycl.hpp>
@@ -77,12 +83,11 @@ constexpr int DEF_QUIET = 0;
 struct Config {
   bool Vis, Zero, Detailed, Quiet;
   int Block, Sz, HistSz, GlobSz, LocSz, BWidth;
-  std::string Image;
+  std::string Image, DataFile;
+  BenchConfig Bench;
 };
 
-inline Config read_config(int argc, char **argv) {
-  Config Cfg;
-  options::Parser OptParser;
+inline void add_options(options::Parser &OptParser) {
   OptParser.template add<int>("bsz", DEF_BSZ, "block size");
   OptParser.template add<int>("sz", DEF_SZ,
                               "data size (in bsz-element blocks)");
@@ -96,13 +101,24 @@ inline Config read_config(int argc, char **argv) {
   OptParser.template add<int>("bwidth", DEF_BWIDTH,
                               "bin width for hist visualization");
   OptParser.template add<int>("zero", DEF_ZEROOUT, "fill data with zeroes");
+  OptParser.template add<std::string>("data", "",
+                                      "binary dataset to map as input");
   OptParser.template add<int>("detailed", DEF_DETAILED, "detailed event view");
   OptParser.template add<int>("quiet", DEF_QUIET, "detailed event view");
-  OptParser.parse(argc, argv);
+  add_bench_options(OptParser);
+}
+
+// for currently selected sweep point
+inline Config read_config(const options::Parser &OptParser,
+                          std::string Program) {
+  Config Cfg;
 
   Cfg.Image = OptParser.template get<std::string>("img");
   Cfg.Block = OptParser.template get<int>("bsz");
   Cfg.Sz = OptParser.template get<int>("sz") * Cfg.Block;
+  Cfg.DataFile = OptParser.template get<std::string>("data");
+  if (!Cfg.DataFile.empty())
+    Cfg.Sz = dataset_elements<int>(Cfg.DataFile);
   Cfg.HistSz = OptParser.template get<int>("hsz");
   Cfg.GlobSz = OptParser.template get<int>("gsz") * Cfg.Block;
   Cfg.LocSz = OptParser.template get<int>("lsz");
@@ -111,6 +127,8 @@ inline Config read_config(int argc, char **argv) {
   Cfg.Zero = OptParser.exists("zero");
   Cfg.Detailed = OptParser.exists("detailed");
   Cfg.Quiet = OptParser.exists("quiet");
+  Cfg.Bench = read_bench_options(OptParser, Program);
+  Cfg.Bench.Given = given_options(OptParser, {"lsz", "gsz"});
 
   if (Cfg.Quiet) {
     Cfg.Vis = false; // quiet implies novis of course
@@ -136,6 +154,8 @@ inline void dump_config_info(Config &Cfg) {
 
   qout << "Block size: " << Cfg.Block << std::endl;
   qout << "Data size: " << Cfg.Sz << std::endl;
+  if (!Cfg.DataFile.empty())
+    qout << "Dataset: " << Cfg.DataFile << std::endl;
   qout << "Histogram size: " << Cfg.HistSz << std::endl;
   qout << "Global size: " << Cfg.GlobSz << std::endl;
   qout << "Local size: " << Cfg.LocSz << std::endl;
@@ -145,6 +165,47 @@ inline void dump_config_info(Config &Cfg) {
     qout << "Detailed events" << std::endl;
 }
 
+inline void record_config(const Config &Cfg, ResultRecord &Rec) {
+  Rec.add("config", "block", Cfg.Block);
+  Rec.add("config", "size", Cfg.Sz);
+  Rec.add("config", "hsize", Cfg.HistSz);
+  Rec.add("config", "gsz", Cfg.GlobSz);
+  Rec.add("config", "lsz", Cfg.LocSz);
+  Rec.add("config", "bwidth", Cfg.BWidth);
+  Rec.add("config", "zero", Cfg.Zero);
+  Rec.add("config", "image", Cfg.Image);
+  Rec.add("config", "data", Cfg.DataFile);
+}
+
+// no arithmetic to speak of: data read once, bins written once
+template <typename T> WorkCount work_count(const Config &Cfg) {
+  return {0, (double(Cfg.Sz) + Cfg.HistSz) * sizeof(T)};
+}
+
+// data is shared by testers, bins are per tester
+// with -chunk device holds only streaming slots of data
+template <typename T> Footprint footprint(const Config &Cfg) {
+  double Data = double(Cfg.Sz) * sizeof(T);
+  double Bins = double(Cfg.HistSz) * sizeof(T);
+  double Host = Data + Bins * (1 + 2 * HOST_REF_COPIES);
+  if (Cfg.Bench.StreamChunk > 0)
+    return stream_footprint<T>(Host, Cfg.Bench.StreamChunk,
+                               Cfg.Bench.StreamBufs, 1, Cfg.Sz);
+  return {Host, Data + Bins, Data};
+}
+
+// GlobSz work-items in work-groups of LocSz, no more work-items than data
+template <typename T> TuneSpace tune_space(sycl::device D, Config &Cfg) {
+  auto Lim = device_limits(D);
+  auto Legal = [Lim, &Cfg] {
+    return Cfg.LocSz <= Lim.MaxWG && Cfg.GlobSz % Cfg.LocSz == 0 &&
+           Cfg.GlobSz <= std::max(Cfg.Sz, Cfg.Block);
+  };
+  return {{tune_param("lsz", Cfg.LocSz, pow2_candidates(4, 1024)),
+           tune_param("gsz", Cfg.GlobSz, pow2_candidates(1, 1024, Cfg.Block))},
+          Legal};
+}
+
 } // namespace hist
 
 template <typename T> class Histogramm {
@@ -184,7 +245,9 @@ public:
       : Hist_(Hist), Data_(Data), NumData_(NumData), NumBins_(NumBins),
         Bins_(NumBins) {}
 
-  std::pair<unsigned, unsigned long long> calculate(hist::Config Cfg) {
+  Timing_t calculate(hist::Config Cfg) {
+    // bins are accumulated by most variants, so each run starts from zero
+    std::fill(Bins_.begin(), Bins_.end(), 0);
     Timer_.start();
     EvtRet_t Ret = Hist_(Data_, Bins_.data(), NumData_, NumBins_);
     Timer_.stop();
@@ -207,37 +270,37 @@ void dump_hist(std::ostream &Os, std::string Name, const T *Data, int Sz) {
   Os << "\n";
 }
 
-template <typename HistChildT, typename Ty>
-HistogrammTester<Ty> single_hist_sequence(sycl::queue &Q, hist::Config Cfg,
-                                          Ty *Data) {
+// host reference bins, empty unless MEASURE_NORMAL
+template <typename Ty>
+std::vector<Ty> hist_reference(sycl::queue &Q, const hist::Config &Cfg,
+                               const Ty *Data) {
 #if defined(MEASURE_NORMAL)
   qout << "Calculating host" << std::endl;
   HistogrammHost<Ty> HistH{Q}; // Q unused for this derived class
   HistogrammTester<Ty> TesterH{HistH, Data, Cfg.Sz, Cfg.HistSz};
-  auto ElapsedH = TesterH.calculate(Cfg);
-  qout << "Measured host time: " << ElapsedH.first / msec_per_sec << std::endl;
-  Ty *HostData = TesterH.dataBins();
+  measure_host(Cfg.Bench, [&] { return TesterH.calculate(Cfg); });
   if (Cfg.Vis)
-    dump_hist(qout, "Host result", HostData, Cfg.HistSz);
+    dump_hist(qout, "Host result", TesterH.dataBins(), Cfg.HistSz);
+  return {TesterH.beginBins(), TesterH.endBins()};
+#else
+  return {};
 #endif
+}
 
-  HistChildT Hist{Q, Cfg};
-
-  HistogrammTester<Ty> Tester{Hist, Data, Cfg.Sz, Cfg.HistSz};
-
+// measure one variant, HostBins is host result or nullptr
+template <typename Ty>
+BenchResult bench_hist_variant(sycl::queue &Q, const hist::Config &Cfg,
+                               HistogrammTester<Ty> &Tester,
+                               const Ty *HostBins) {
   qout << "Calculating gpu" << std::endl;
-  auto Elapsed = Tester.calculate(Cfg);
-
-  auto ExecTime = Elapsed.second / nsec_per_sec;
-  qout << "Measured time: " << Elapsed.first / msec_per_sec << std::endl
-       << "Pure execution time: " << ExecTime << std::endl;
+  auto Bench = run_bench(Cfg.Bench, [&] { return Tester.calculate(Cfg); });
+  attach_work(Q, Cfg.Bench, Bench, hist::work_count<Ty>(Cfg));
 
-  // Quiet mode output: size, elapsed time
-  if (Cfg.Quiet) {
-    qout.set(!Cfg.Quiet);
-    qout << Cfg.Sz << " " << ExecTime << "\n";
-    qout.set(Cfg.Quiet);
-  }
+  qout << "Measured time: " << SecFmt{Bench.WallStats.Median} << std::endl
+       << "Pure execution time: " << SecFmt{Bench.EvtStats.Median}
+       << std::endl;
+  dump_bench(qout, Bench);
+  report_result("hist", Cfg, Q.get_device(), Bench);
 
   Ty *GPUData = Tester.dataBins();
 
@@ -246,19 +309,80 @@ HistogrammTester<Ty> single_hist_sequence(sycl::queue &Q, hist::Config Cfg,
     dump_hist(qout, "GPU result", GPUData, Cfg.HistSz);
   }
 
-#if defined(MEASURE_NORMAL) && defined(VERIFY)
+#if defined(VERIFY)
   // verification with host result
-  auto MisPoint = std::mismatch(HostData, HostData + Cfg.HistSz, GPUData);
-  if (MisPoint.first != HostData + Cfg.HistSz) {
-    ptrdiff_t I = MisPoint.first - HostData;
-    qout << "Mismatch at: " << I << std::endl;
-    qout << *MisPoint.first << " vs " << *MisPoint.second << std::endl;
-    throw std::runtime_error("Mismath");
-  }
+  if (HostBins != nullptr)
+    check_result("hist", HostBins, GPUData, Cfg.HistSz, Cfg.Bench);
 #endif
+  return Bench;
+}
+
+// Make(Cfg) creates variant for current sizes of Cfg
+template <typename Ty, typename MakeF>
+void tune_hist_variant(sycl::queue &Q, hist::Config &Cfg, MakeF Make,
+                       const Ty *Data) {
+  auto Space = hist::tune_space<Ty>(Q.get_device(), Cfg);
+  tune_config(Q, Cfg.Bench, Space, [&] {
+    auto Hist = Make(Cfg);
+    HistogrammTester<Ty> Tester{*Hist, Data, Cfg.Sz, Cfg.HistSz};
+    return Tester.calculate(Cfg);
+  });
+}
+
+template <typename HistChildT, typename Ty>
+void tune_hist_sequence(sycl::queue &Q, hist::Config &Cfg, const Ty *Data) {
+  tune_hist_variant<Ty>(
+      Q, Cfg,
+      [&Q](const hist::Config &C) {
+        return std::make_unique<HistChildT>(Q, C);
+      },
+      Data);
+}
+
+template <typename HistChildT, typename Ty>
+HistogrammTester<Ty> single_hist_sequence(sycl::queue &Q, hist::Config Cfg,
+                                          const Ty *Data) {
+  auto HostBins = hist_reference(Q, Cfg, Data);
+
+  HistChildT Hist{Q, Cfg};
+
+  HistogrammTester<Ty> Tester{Hist, Data, Cfg.Sz, Cfg.HistSz};
+  auto Bench = bench_hist_variant(Q, Cfg, Tester,
+                                  HostBins.empty() ? nullptr : HostBins.data());
+
+  // Quiet mode output: size, elapsed time
+  if (Cfg.Quiet) {
+    qout.set(!Cfg.Quiet);
+    qout << Cfg.Sz << " " << SecFmt{Bench.EvtStats.Median} << "\n";
+    qout.set(Cfg.Quiet);
+  }
   return Tester;
 }
 
+// mapped dataset or random (or zero) data of Cfg.Sz elements in [0, HistSz)
+template <typename Ty> InputArray<Ty> hist_input(const hist::Config &Cfg) {
+  if (!Cfg.DataFile.empty()) {
+    qout << "Mapping dataset: " << Cfg.DataFile << std::endl;
+    InputArray<Ty> Data{Cfg.DataFile};
+    // values are bin indices: kernels do not check them
+    auto [MinIt, MaxIt] =
+        std::minmax_element(Data.data(), Data.data() + Data.size());
+    if (Data.size() > 0 && (*MinIt < 0 || *MaxIt >= Cfg.HistSz))
+      throw std::runtime_error("Dataset values out of range [0, " +
+                               std::to_string(Cfg.HistSz) + "): " +
+                               Cfg.DataFile);
+    return Data;
+  }
+  std::vector<Ty> Data;
+  qout << "Initializing with random" << std::endl;
+  Data.resize(Cfg.Sz);
+  if (Cfg.Zero)
+    std::fill(Data.begin(), Data.end(), 0);
+  else
+    rand_initialize(Data.begin(), Data.end(), 0, Cfg.HistSz - 1);
+  return InputArray<Ty>{std::move(Data)};
+}
+
 #ifdef CIMG_ENABLE
 // implemented in terms of single_hist_sequence
 template <typename HistChildT>
@@ -274,6 +398,7 @@ void cimg_hist_sequence(sycl::queue &Q, hist::Config Cfg) {
   std::vector<Ty> DataR(Image.data(), Image.data() + Cfg.Sz);
   std::vector<Ty> DataG(Image.data() + Cfg.Sz, Image.data() + 2 * Cfg.Sz);
   std::vector<Ty> DataB(Image.data() + 2 * Cfg.Sz, Image.data() + 3 * Cfg.Sz);
+  tune_hist_sequence<HistChildT>(Q, Cfg, DataR.data());
   auto TesterR = single_hist_sequence<HistChildT, Ty>(Q, Cfg, DataR.data());
   auto TesterG = single_hist_sequence<HistChildT, Ty>(Q, Cfg, DataG.data());
   auto TesterB = single_hist_sequence<HistChildT, Ty>(Q, Cfg, DataB.data());
@@ -306,28 +431,34 @@ void cimg_hist_sequence(sycl::queue &Q, hist::Config Cfg) {
 template <typename HistChildT> void test_sequence(int argc, char **argv) {
   try {
     using Ty = typename HistChildT::type;
-    auto Cfg = hist::read_config(argc, argv);
+    options::Parser OptParser;
+    hist::add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return hist::read_config(Parser, argv[0]);
+    });
     qout << "Welcome to histogram" << std::endl;
-    dump_config_info(Cfg);
     auto Q = set_queue();
     print_info(qout, Q.get_device());
 
-    if (Cfg.Image.empty()) {
-      std::vector<Ty> Data;
-      qout << "Initializing with random" << std::endl;
-      Data.resize(Cfg.Sz);
-      if (Cfg.Zero)
-        std::fill(Data.begin(), Data.end(), 0);
-      else
-        rand_initialize(Data.begin(), Data.end(), 0, Cfg.HistSz - 1);
-      single_hist_sequence<HistChildT>(Q, Cfg, Data.data());
-    } else {
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      auto &Cfg = Cfgs[I];
+      dump_sweep_point(I, Cfgs.size());
+      dump_config_info(Cfg);
+      if (Cfg.Image.empty()) {
+        preflight(Q.get_device(), hist::footprint<Ty>(Cfg));
+        reseed(Cfg.Bench);
+        auto Data = hist_input<Ty>(Cfg);
+        tune_hist_sequence<HistChildT>(Q, Cfg, Data.data());
+        single_hist_sequence<HistChildT>(Q, Cfg, Data.data());
+      } else {
 #ifdef CIMG_ENABLE
-      cimg_hist_sequence<HistChildT>(Q, Cfg);
+        cimg_hist_sequence<HistChildT>(Q, Cfg);
 #else
-      std::cerr << "Please build with CImg support" << std::endl;
-      std::terminate();
+        std::cerr << "Please build with CImg support" << std::endl;
+        std::terminate();
 #endif // CIMG_ENABLE
+      }
     }
 
   } catch (sycl::exception const &err) {
@@ -343,4 +474,87 @@ template <typename HistChildT> void test_sequence(int argc, char **argv) {
   qout << "Everything is correct" << std::endl;
 }
 
+namespace hist {
+
+template <typename T> using Registry = VariantRegistry<Histogramm<T>, Config>;
+
+// sycl_bench sequence: requested variants (all if empty) on same data
+template <typename Ty>
+void bench_sequence(int argc, char **argv,
+                    const std::vector<std::string> &Requested) {
+  try {
+    auto Names = Registry<Ty>::instance().select(Requested);
+    options::Parser OptParser;
+    add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return read_config(Parser, argv[0]);
+    });
+    qout << "Welcome to histogram" << std::endl;
+    auto Q = set_queue();
+    print_info(qout, Q.get_device());
+
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      auto &Cfg = Cfgs[I];
+      dump_sweep_point(I, Cfgs.size());
+      dump_config_info(Cfg);
+      if (!Cfg.Image.empty())
+        throw std::runtime_error("Image input is not supported in sycl_bench");
+      preflight(Q.get_device(), footprint<Ty>(Cfg));
+      reseed(Cfg.Bench);
+      auto Data = hist_input<Ty>(Cfg);
+      auto HostBins = hist_reference(Q, Cfg, Data.data());
+
+      VariantResults Results;
+      for (auto &&Name : Names) {
+        qout << "Variant: " << Name << std::endl;
+        auto VCfg = Cfg;
+        VCfg.Bench.Program = Name;
+        tune_hist_variant<Ty>(
+            Q, VCfg,
+            [&](const Config &C) {
+              return Registry<Ty>::instance().create(Name, Q, C);
+            },
+            Data.data());
+        auto Hist = Registry<Ty>::instance().create(Name, Q, VCfg);
+        HistogrammTester<Ty> Tester{*Hist, Data.data(), Cfg.Sz, Cfg.HistSz};
+        auto Bench =
+            bench_hist_variant(Q, VCfg, Tester,
+                               HostBins.empty() ? nullptr : HostBins.data());
+        if (Cfg.Quiet) {
+          qout.set(!Cfg.Quiet);
+          qout << Name << " " << Cfg.Sz << " " << SecFmt{Bench.EvtStats.Median}
+               << "\n";
+          qout.set(Cfg.Quiet);
+        }
+        Results.emplace_back(Name, Bench);
+      }
+      dump_comparison(qout, Results);
+    }
+  } catch (sycl::exception const &err) {
+    std::cerr << "SYCL ERROR: " << err.what() << "\n";
+    abort();
+  } catch (std::exception const &err) {
+    std::cerr << "Exception: " << err.what() << "\n";
+    abort();
+  } catch (...) {
+    std::cerr << "Unknown error\n";
+    abort();
+  }
+  qout << "Everything is correct" << std::endl;
+}
+
+// used through REGISTER_VARIANT(hist, "name", Class)
+template <typename HistChildT> bool register_variant(std::string Name) {
+  using Ty = typename HistChildT::type;
+  auto Variants = [] { return Registry<Ty>::instance().names(); };
+  FamilyRegistry::instance().add("hist", {bench_sequence<Ty>, Variants});
+  return Registry<Ty>::instance().add(
+      Name, [](sycl::queue &Q, const Config &Cfg) {
+        return std::make_unique<HistChildT>(Q, Cfg);
+      });
+}
+
+} // namespace hist
+
 } // namespace sycltesters
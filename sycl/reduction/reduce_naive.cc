@@ -30,6 +30,7 @@ class ReductionNaiveBuf : public sycltesters::Reduction<T> {
   ConfigTy Cfg_;
 
 public:
+  using kernel_name = reduce_naive_buf<T>;
   ReductionNaiveBuf(sycl::queue &DeviceQueue, EBundleTy ExeBundle, ConfigTy Cfg)
       : sycltesters::Reduction<T>(DeviceQueue, ExeBundle), Cfg_(Cfg) {}
 
@@ -88,7 +89,11 @@ public:
   }
 };
 
+REGISTER_VARIANT(reduce, "reduce_naive", ReductionNaiveBuf<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycl::kernel_id kid = sycl::get_kernel_id<reduce_naive_buf<int>>();
   sycltesters::test_sequence<ReductionNaiveBuf<int>>(argc, argv, kid);
 }
+#endif
@@ -0,0 +1,123 @@
+//------------------------------------------------------------------------------
+//
+// Reduction, data streamed through device in chunks (SYCL vs serial CPU).
+// Every chunk is reduced to per-group partial sums as in reduce_naive, host
+// adds them up as chunks finish, so data may be larger than device memory
+// (see framework/streaming.hpp)
+//
+// > reduction\reduce_stream.exe -sz=100000 -chunk=1048576 -nbuf=3
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+#include "reduction_testers.hpp"
+
+using ConfigTy = sycltesters::reduce::Config;
+
+// class is used for kernel name
+template <typename T> class reduce_stream_buf;
+
+template <typename T>
+class ReductionStream : public sycltesters::Reduction<T> {
+  using sycltesters::Reduction<T>::Queue;
+  using sycltesters::Reduction<T>::Bundle;
+  ConfigTy Cfg_;
+
+public:
+  using kernel_name = reduce_stream_buf<T>;
+  ReductionStream(sycl::queue &DeviceQueue, EBundleTy ExeBundle, ConfigTy Cfg)
+      : sycltesters::Reduction<T>(DeviceQueue, ExeBundle), Cfg_(Cfg) {}
+
+  sycltesters::EvtRet_t operator()(const T *Data, size_t NumData,
+                                   T &Result) override {
+    const unsigned GSZ = Cfg_.GlobSz;
+    const unsigned LSZ = Cfg_.LocSz;
+    const auto NumRes = GSZ / LSZ;
+    assert(Data != nullptr);
+    const auto &BCfg = Cfg_.Bench;
+    auto &DeviceQueue = Queue();
+    auto Chunk = sycltesters::stream_chunk<T>(DeviceQueue, BCfg.StreamChunk,
+                                              BCfg.StreamBufs, 1, NumData);
+    sycltesters::ChunkStream<T, 1> Stream{DeviceQueue, Chunk, BCfg.StreamBufs};
+
+    // partial sums per slot: on device and copied back for merge
+    std::vector<T *> DevSums(Stream.slots());
+    std::vector<std::vector<T>> HostSums(Stream.slots());
+    for (unsigned S = 0; S < Stream.slots(); ++S) {
+      DevSums[S] = sycltesters::pool_malloc_device<T>(NumRes, DeviceQueue);
+      HostSums[S].resize(NumRes);
+    }
+    sycl::nd_range<1> DataSz{GSZ, LSZ};
+
+    auto Compute = [&](const sycltesters::ChunkInfo &Ch, auto &Dev,
+                       auto &Copies) {
+      const T *ChunkData = Dev[0];
+      T *Results = DevSums[Ch.Slot];
+      const size_t ChunkSz = Ch.Size;
+      // events are wrapped right after submit: host stamp is taken there
+      sycltesters::EvtVec_t Evts;
+      auto Evt = DeviceQueue.submit([&](sycl::handler &Cgh) {
+        Cgh.depends_on(Copies);
+        using LTy = sycl::accessor<T, 1, sycl_read_write, sycl_local>;
+        LTy ReductionSums{sycl::range<1>{LSZ}, Cgh};
+
+        auto KernReduce = [=](sycl::nd_item<1> WorkItem) {
+          const int N = WorkItem.get_global_id(0);
+          const int L = WorkItem.get_local_id(0);
+          const int Group = WorkItem.get_group(0);
+          ReductionSums[L] = 0;
+          for (size_t I = N; I < ChunkSz; I += GSZ)
+            ReductionSums[L] += ChunkData[I];
+
+          for (int Offset = LSZ / 2; Offset > 0; Offset /= 2) {
+            WorkItem.barrier(sycl_local_fence);
+            if (L < Offset)
+              ReductionSums[L] += ReductionSums[L + Offset];
+          }
+
+          if (L == 0)
+            Results[Group] = ReductionSums[0];
+        };
+
+        Cgh.parallel_for<class reduce_stream_buf<T>>(DataSz, KernReduce);
+      });
+      Evts.emplace_back(Evt, "Calculating chunk reduction");
+      auto EvtCpySums =
+          DeviceQueue.copy(Results, HostSums[Ch.Slot].data(), NumRes, Evt);
+      Evts.emplace_back(EvtCpySums, "Copy partial sums back");
+      return Evts;
+    };
+
+    // final combine, chunk by chunk
+    Result = 0;
+    auto Merge = [&](const sycltesters::ChunkInfo &Ch) {
+      for (auto Sum : HostSums[Ch.Slot])
+        Result += Sum;
+    };
+
+    auto ProfInfo = Stream.run({Data}, NumData, Compute, Merge);
+
+    for (unsigned S = Stream.slots(); S > 0; --S)
+      sycltesters::pool_free(DevSums[S - 1], DeviceQueue);
+    return ProfInfo;
+  }
+};
+
+REGISTER_VARIANT(reduce, "reduce_stream", ReductionStream<int>);
+
+#ifndef SYCL_BENCH
+int main(int argc, char **argv) {
+  sycl::kernel_id kid = sycl::get_kernel_id<reduce_stream_buf<int>>();
+  sycltesters::test_sequence<ReductionStream<int>>(argc, argv, kid);
+}
+#endif
@@ -12,8 +12,12 @@
 // -gsz=<g> : global iteration space (in bsz-units)
 // -lsz=<l> : local iteration space
 // -val=<val> : fill data with val for debug
+// -data=<file> : binary int dataset (see dataset.hpp), overrides -sz
 // -detailed : detailed report from event
 // -quiet : quiet mode for bulk runs
+// -reps=<n>, -warmup=<w> : measured and warmup runs (see testers.hpp)
+// -tune : tune gsz and lsz for device, tuned are defaults afterwards
+// numeric options may be lists or ranges: -sz=1024..8192:1024 -lsz=16,32
 //
 //------------------------------------------------------------------------------
 //
@@ -29,7 +33,11 @@
 #include <chrono>
 #include <iostream>
 #include <iterator>
+#include <mutex>
 #include <numeric>
+#include <optional>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 #include <CL/sycl.hpp>
@@ -59,11 +67,11 @@ constexpr int DEF_QUIET = 0;
 struct Config {
   bool ValExists, Detailed, Quiet;
   int Block, Sz, GlobSz, LocSz, Val;
+  std::string DataFile;
+  BenchConfig Bench;
 };
 
-inline Config read_config(int argc, char **argv) {
-  Config Cfg;
-  options::Parser OptParser;
+inline void add_options(options::Parser &OptParser) {
   OptParser.template add<int>("bsz", DEF_BSZ, "block size");
   OptParser.template add<int>("sz", DEF_SZ,
                               "data size (in bsz-element blocks)");
@@ -71,17 +79,30 @@ inline Config read_config(int argc, char **argv) {
                               "global iteration space (in bsz-element blocks)");
   OptParser.template add<int>("lsz", DEF_LSZ, "local iteration space");
   OptParser.template add<int>("val", DEF_VAL, "fill data with given value");
+  OptParser.template add<std::string>("data", "",
+                                      "binary dataset to map as input");
   OptParser.template add<int>("detailed", DEF_DETAILED, "detailed event view");
   OptParser.template add<int>("quiet", DEF_QUIET, "detailed event view");
-  OptParser.parse(argc, argv);
+  add_bench_options(OptParser);
+}
+
+// for currently selected sweep point
+inline Config read_config(const options::Parser &OptParser,
+                          std::string Program) {
+  Config Cfg;
 
   Cfg.Block = OptParser.template get<int>("bsz");
   Cfg.Sz = OptParser.template get<int>("sz") * Cfg.Block;
+  Cfg.DataFile = OptParser.template get<std::string>("data");
+  if (!Cfg.DataFile.empty())
+    Cfg.Sz = dataset_elements<int>(Cfg.DataFile);
   Cfg.GlobSz = OptParser.template get<int>("gsz") * Cfg.Block;
   Cfg.LocSz = OptParser.template get<int>("lsz");
   Cfg.ValExists = OptParser.exists("val");
   Cfg.Val = OptParser.template get<int>("val");
   Cfg.Detailed = OptParser.exists("detailed");
+  Cfg.Bench = read_bench_options(OptParser, Program);
+  Cfg.Bench.Given = given_options(OptParser, {"lsz", "gsz"});
 
   if (OptParser.exists("quiet")) {
     Cfg.Quiet = true;
@@ -98,6 +119,8 @@ inline void dump_config_info(Config &Cfg) {
 
   qout << "Block size: " << Cfg.Block << std::endl;
   qout << "Data size: " << Cfg.Sz << std::endl;
+  if (!Cfg.DataFile.empty())
+    qout << "Dataset: " << Cfg.DataFile << std::endl;
   qout << "Global size: " << Cfg.GlobSz << std::endl;
   qout << "Local size: " << Cfg.LocSz << std::endl;
   if (Cfg.ValExists)
@@ -106,6 +129,46 @@ inline void dump_config_info(Config &Cfg) {
     qout << "Detailed events" << std::endl;
   qout.flush();
 }
+
+inline void record_config(const Config &Cfg, ResultRecord &Rec) {
+  Rec.add("config", "block", Cfg.Block);
+  Rec.add("config", "size", Cfg.Sz);
+  Rec.add("config", "gsz", Cfg.GlobSz);
+  Rec.add("config", "lsz", Cfg.LocSz);
+  if (Cfg.ValExists)
+    Rec.add("config", "val", Cfg.Val);
+  if (!Cfg.DataFile.empty())
+    Rec.add("config", "data", Cfg.DataFile);
+}
+
+// one add per element, data read once
+template <typename T> WorkCount work_count(const Config &Cfg) {
+  return {double(Cfg.Sz), double(Cfg.Sz) * sizeof(T)};
+}
+
+// data is shared by testers, partial sums are one per work-item at most
+// with -chunk device holds only streaming slots of data
+template <typename T> Footprint footprint(const Config &Cfg) {
+  double Data = double(Cfg.Sz) * sizeof(T);
+  if (Cfg.Bench.StreamChunk > 0)
+    return stream_footprint<T>(Data, Cfg.Bench.StreamChunk,
+                               Cfg.Bench.StreamBufs, 1, Cfg.Sz);
+  return {Data, Data + double(Cfg.GlobSz) * sizeof(T), Data};
+}
+
+// tree reduction of LocSz partial sums in local memory per work-group
+template <typename T> TuneSpace tune_space(sycl::device D, Config &Cfg) {
+  auto Lim = device_limits(D);
+  auto Legal = [Lim, &Cfg] {
+    size_t L = Cfg.LocSz;
+    return L <= Lim.MaxWG && L * sizeof(T) <= Lim.LocalMem &&
+           Cfg.GlobSz % Cfg.LocSz == 0 &&
+           Cfg.GlobSz <= std::max(Cfg.Sz, Cfg.Block);
+  };
+  return {{tune_param("lsz", Cfg.LocSz, pow2_candidates(4, 1024)),
+           tune_param("gsz", Cfg.GlobSz, pow2_candidates(1, 1024, Cfg.Block))},
+          Legal};
+}
 } // namespace reduce
 
 template <typename T> class Reduction {
@@ -141,7 +204,7 @@ public:
   ReductionTester(Reduction<T> &Reduce, const T *Data, reduce::Config Cfg)
       : Reduce_(Reduce), Data_(Data), Cfg_(Cfg) {}
 
-  std::pair<unsigned, unsigned> calculate(T &Result) {
+  Timing_t calculate(T &Result) {
     Timer Tm;
     Tm.start();
     EvtRet_t Ret = Reduce_(Data_, Cfg_.Sz, Result);
@@ -153,74 +216,117 @@ public:
   const T *data() const { return Data_; }
 };
 
-template <typename ReductionChildT, typename Ty>
-ReductionTester<Ty> single_reduce_sequence(sycl::queue &Q, reduce::Config Cfg,
-                                           Ty *Data, EBundleTy ExeBundle) {
+// host result, empty unless MEASURE_NORMAL
+template <typename Ty>
+std::optional<Ty> reduce_reference(sycl::queue &Q, const reduce::Config &Cfg,
+                                   const Ty *Data, EBundleTy ExeBundle) {
 #if defined(MEASURE_NORMAL)
   qout << "Calculating host" << std::endl;
   ReductionHost<Ty> ReductionHost{Q, ExeBundle}; // both args here unused
   ReductionTester<Ty> TesterH{ReductionHost, Data, Cfg};
   Ty ResultH;
-  auto ElapsedH = TesterH.calculate(ResultH);
-  qout << "Measured host time: " << ElapsedH.first / msec_per_sec << std::endl;
+  measure_host(Cfg.Bench, [&] { return TesterH.calculate(ResultH); });
+  return ResultH;
+#else
+  return std::nullopt;
 #endif
+}
 
-  ReductionChildT Reduce{Q, ExeBundle, Cfg};
-
+// measure one variant on given data, HostRes is host result or nullptr
+template <typename Ty>
+BenchResult bench_reduce_variant(sycl::queue &Q, const reduce::Config &Cfg,
+                                 Reduction<Ty> &Reduce, const Ty *Data,
+                                 const Ty *HostRes) {
   ReductionTester<Ty> Tester{Reduce, Data, Cfg};
 
   qout << "Calculating gpu" << std::endl;
   Ty Result;
-  auto Elapsed = Tester.calculate(Result);
+  auto Bench = run_bench(Cfg.Bench, [&] { return Tester.calculate(Result); });
+  attach_work(Q, Cfg.Bench, Bench, reduce::work_count<Ty>(Cfg));
+
+  auto ExecTime = Bench.EvtStats.Median;
+  qout << "Measured time: " << SecFmt{Bench.WallStats.Median} << std::endl;
+  qout << "Pure execution time: " << SecFmt{ExecTime} << std::endl;
+  dump_bench(qout, Bench);
+  report_result("reduce", Cfg, Q.get_device(), Bench);
+
+#if defined(VERIFY)
+  if (HostRes != nullptr)
+    check_result("reduce", HostRes, &Result, 1, Cfg.Bench);
+#endif
+  return Bench;
+}
 
-  auto ExecTime = Elapsed.second / nsec_per_sec;
-  qout << "Measured time: " << Elapsed.first / msec_per_sec << std::endl;
-  qout << "Pure execution time: " << ExecTime << std::endl;
+template <typename ReductionChildT, typename Ty>
+void single_reduce_sequence(sycl::queue &Q, reduce::Config Cfg,
+                            const Ty *Data, EBundleTy ExeBundle) {
+  auto HostRes = reduce_reference(Q, Cfg, Data, ExeBundle);
+  ReductionChildT Reduce{Q, ExeBundle, Cfg};
+  auto Bench = bench_reduce_variant<Ty>(Q, Cfg, Reduce, Data,
+                                        HostRes ? &*HostRes : nullptr);
 
   // Quiet mode output: size, elapsed time
   if (Cfg.Quiet) {
     qout.set(!Cfg.Quiet);
-    qout << Cfg.Sz << " " << ExecTime << "\n";
+    qout << Cfg.Sz << " " << SecFmt{Bench.EvtStats.Median} << "\n";
     qout.set(Cfg.Quiet);
   }
+}
 
-#if defined(MEASURE_NORMAL) && defined(VERIFY)
-  if (Result != ResultH) {
-    qout << "Mismatch result: " << std::endl;
-    qout << Result << " vs " << ResultH << std::endl;
-    std::terminate();
+// mapped dataset, constant value or random data of Cfg.Sz elements
+template <typename Ty> InputArray<Ty> reduce_input(const reduce::Config &Cfg) {
+  if (!Cfg.DataFile.empty()) {
+    qout << "Mapping dataset: " << Cfg.DataFile << std::endl;
+    return InputArray<Ty>{Cfg.DataFile};
   }
-#endif
-  return Tester;
+  std::vector<Ty> Data;
+  Data.resize(Cfg.Sz);
+  constexpr Ty MAX_VAL = 10;
+  if (Cfg.ValExists) {
+    qout << "Initializing with value = " << Cfg.Val << std::endl;
+    std::fill(Data.begin(), Data.end(), Cfg.Val);
+  } else {
+    qout << "Initializing with random" << std::endl;
+    rand_initialize(Data.begin(), Data.end(), 0, MAX_VAL);
+  }
+  return InputArray<Ty>{std::move(Data)};
 }
 
 template <typename ReductionChildT>
 void test_sequence(int argc, char **argv, sycl::kernel_id kid) {
   try {
-    auto Cfg = reduce::read_config(argc, argv);
+    options::Parser OptParser;
+    reduce::add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return reduce::read_config(Parser, argv[0]);
+    });
     using Ty = typename ReductionChildT::type;
     qout << "Welcome to reduction" << std::endl;
-    reduce::dump_config_info(Cfg);
     auto Q = set_queue();
     print_info(qout, Q.get_device());
 
-    IBundleTy SrcBundle = sycl::get_kernel_bundle<sycl::bundle_state::input>(
-        Q.get_context(), {kid});
+    // bundle is built once for all sweep points
     // here we can do specialization constants and many more
-    OBundleTy ObjBundle = sycl::compile(SrcBundle);
-    EBundleTy ExeBundle = sycl::link(ObjBundle);
-
-    std::vector<Ty> Data;
-    Data.resize(Cfg.Sz);
-    constexpr Ty MAX_VAL = 10;
-    if (Cfg.ValExists) {
-      qout << "Initializing with value = " << Cfg.Val << std::endl;
-      std::fill(Data.begin(), Data.end(), Cfg.Val);
-    } else {
-      qout << "Initializing with random" << std::endl;
-      rand_initialize(Data.begin(), Data.end(), 0, MAX_VAL);
+    EBundleTy ExeBundle =
+        bundle_cache().get(Q.get_context(), kid, "", [](IBundleTy &) {});
+
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      auto &Cfg = Cfgs[I];
+      dump_sweep_point(I, Cfgs.size());
+      reduce::dump_config_info(Cfg);
+      preflight(Q.get_device(), reduce::footprint<Ty>(Cfg));
+      reseed(Cfg.Bench);
+      auto Data = reduce_input<Ty>(Cfg);
+      auto Space = reduce::tune_space<Ty>(Q.get_device(), Cfg);
+      tune_config(Q, Cfg.Bench, Space, [&] {
+        ReductionChildT Reduce{Q, ExeBundle, Cfg};
+        ReductionTester<Ty> Tester{Reduce, Data.data(), Cfg};
+        Ty Result;
+        return Tester.calculate(Result);
+      });
+      single_reduce_sequence<ReductionChildT>(Q, Cfg, Data.data(), ExeBundle);
     }
-    single_reduce_sequence<ReductionChildT>(Q, Cfg, Data.data(), ExeBundle);
 
   } catch (sycl::exception const &err) {
     std::cerr << "SYCL ERROR: " << err.what() << "\n";
@@ -235,4 +341,115 @@ void test_sequence(int argc, char **argv, sycl::kernel_id kid) {
   qout << "Everything is correct" << std::endl;
 }
 
+namespace reduce {
+
+template <typename T> using Registry = VariantRegistry<Reduction<T>, Config>;
+
+template <typename T, typename = void>
+struct has_kernel_name : std::false_type {};
+template <typename T>
+struct has_kernel_name<T, std::void_t<typename T::kernel_name>>
+    : std::true_type {};
+
+// all kernels of context, built once per context
+inline EBundleTy context_bundle(sycl::queue &Q) {
+  static std::mutex Mutex;
+  static std::vector<std::pair<sycl::context, EBundleTy>> Bundles;
+  std::lock_guard<std::mutex> Lock{Mutex};
+  auto Ctx = Q.get_context();
+  for (auto &&[C, Kb] : Bundles)
+    if (C == Ctx)
+      return Kb;
+  Bundles.emplace_back(
+      Ctx, sycl::get_kernel_bundle<sycl::bundle_state::executable>(Ctx));
+  return Bundles.back().second;
+}
+
+// bundle of variant kernel, resolved on first use (after queue is set);
+// variants without nameable kernel (reduction objects) take whole context
+template <typename ReductionChildT> EBundleTy variant_bundle(sycl::queue &Q) {
+  if constexpr (has_kernel_name<ReductionChildT>::value)
+    return build_cached<typename ReductionChildT::kernel_name>(Q);
+  else
+    return context_bundle(Q);
+}
+
+// sycl_bench sequence: requested variants (all if empty) on same data
+template <typename Ty>
+void bench_sequence(int argc, char **argv,
+                    const std::vector<std::string> &Requested) {
+  try {
+    auto Names = Registry<Ty>::instance().select(Requested);
+    options::Parser OptParser;
+    add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return read_config(Parser, argv[0]);
+    });
+    qout << "Welcome to reduction" << std::endl;
+    auto Q = set_queue();
+    print_info(qout, Q.get_device());
+
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      auto &Cfg = Cfgs[I];
+      dump_sweep_point(I, Cfgs.size());
+      dump_config_info(Cfg);
+      preflight(Q.get_device(), footprint<Ty>(Cfg));
+      reseed(Cfg.Bench);
+      auto Data = reduce_input<Ty>(Cfg);
+      // host reference does not use bundle
+      auto HostRes = reduce_reference(Q, Cfg, Data.data(), context_bundle(Q));
+
+      VariantResults Results;
+      for (auto &&Name : Names) {
+        qout << "Variant: " << Name << std::endl;
+        auto VCfg = Cfg;
+        VCfg.Bench.Program = Name;
+        auto Space = tune_space<Ty>(Q.get_device(), VCfg);
+        tune_config(Q, VCfg.Bench, Space, [&] {
+          auto Reduce = Registry<Ty>::instance().create(Name, Q, VCfg);
+          ReductionTester<Ty> Tester{*Reduce, Data.data(), VCfg};
+          Ty Result;
+          return Tester.calculate(Result);
+        });
+        auto Reduce = Registry<Ty>::instance().create(Name, Q, VCfg);
+        auto Bench = bench_reduce_variant<Ty>(Q, VCfg, *Reduce, Data.data(),
+                                              HostRes ? &*HostRes : nullptr);
+        if (Cfg.Quiet) {
+          qout.set(!Cfg.Quiet);
+          qout << Name << " " << Cfg.Sz << " " << SecFmt{Bench.EvtStats.Median}
+               << "\n";
+          qout.set(Cfg.Quiet);
+        }
+        Results.emplace_back(Name, Bench);
+      }
+      dump_comparison(qout, Results);
+    }
+  } catch (sycl::exception const &err) {
+    std::cerr << "SYCL ERROR: " << err.what() << "\n";
+    abort();
+  } catch (std::exception const &err) {
+    std::cerr << "Exception: " << err.what() << "\n";
+    abort();
+  } catch (...) {
+    std::cerr << "Unknown error\n";
+    abort();
+  }
+  qout << "Everything is correct" << std::endl;
+}
+
+// used through REGISTER_VARIANT(reduce, "name", Class)
+template <typename ReductionChildT> bool register_variant(std::string Name) {
+  using Ty = typename ReductionChildT::type;
+  auto Variants = [] { return Registry<Ty>::instance().names(); };
+  FamilyRegistry::instance().add("reduce", {bench_sequence<Ty>, Variants});
+  return Registry<Ty>::instance().add(
+      Name, [](sycl::queue &Q, const Config &Cfg) {
+        return std::make_unique<ReductionChildT>(
+            Q, variant_bundle<ReductionChildT>(Q), Cfg);
+      });
+}
+
+} // namespace reduce
+
 } // namespace sycltesters
@@ -14,6 +14,8 @@
 // -novis : switch off visualization
 // -quiet : measurement (quiet) mode
 // -detailed : detailed report from event
+// -reps=<n>, -warmup=<w> : measured and warmup runs (see testers.hpp)
+// numeric options may be lists or ranges: -amt=0..90:15
 //
 //------------------------------------------------------------------------------
 //
@@ -76,11 +78,10 @@ struct Config {
   int RandImSz, LocSz;
   float Theta;
   std::string ImagePath;
+  BenchConfig Bench;
 };
 
-inline Config read_config(int argc, char **argv) {
-  Config Cfg;
-  options::Parser OptParser;
+inline void add_options(options::Parser &OptParser) {
   OptParser.template add<std::string>("img", "", "image to apply rotate");
   OptParser.template add<int>("randboxes", DEF_IMSZ, "random boxes image");
   OptParser.template add<int>("amt", DEF_AMT, "rotate amount (degrees)");
@@ -89,7 +90,13 @@ inline Config read_config(int argc, char **argv) {
                               "disable graphic visualization");
   OptParser.template add<int>("quiet", DEF_QUIET, "quiet mode for bulk runs");
   OptParser.template add<int>("detailed", DEF_DETAILED, "detailed event view");
-  OptParser.parse(argc, argv);
+  add_bench_options(OptParser);
+}
+
+// for currently selected sweep point
+inline Config read_config(const options::Parser &OptParser,
+                          std::string Program) {
+  Config Cfg;
 
   Cfg.ImagePath = OptParser.template get<std::string>("img");
   Cfg.RandImage = OptParser.exists("randboxes");
@@ -100,6 +107,7 @@ inline Config read_config(int argc, char **argv) {
   Cfg.Visualize = !OptParser.exists("novis");
   Cfg.Quiet = OptParser.exists("quiet");
   Cfg.Detailed = OptParser.exists("detailed");
+  Cfg.Bench = read_bench_options(OptParser, Program);
   if (Cfg.Quiet) {
     Cfg.Quiet = true;
     Cfg.Visualize = false; // quiet implies novis of course
@@ -125,6 +133,19 @@ inline void dump_config_info(Config &Cfg) {
     qout << "Screen visualization\n";
 }
 
+inline void record_config(const Config &Cfg, ResultRecord &Rec) {
+  Rec.add("config", "lsz", Cfg.LocSz);
+  Rec.add("config", "theta", Cfg.Theta);
+  Rec.add("config", "img", Cfg.RandImage ? "" : Cfg.ImagePath);
+  if (Cfg.RandImage)
+    Rec.add("config", "randboxes", Cfg.RandImSz);
+}
+
+// sampling is done by texture units: only image traffic counted
+inline WorkCount work_count(int ImW, int ImH) {
+  return {0, double(ImW) * ImH * sizeof(sycl::float4) * 2};
+}
+
 inline void check_device_props(sycl::device D, Config &Cfg) {
   if (!D.has(sycl::aspect::image))
     throw std::runtime_error("Image support required");
@@ -214,7 +235,7 @@ public:
       : Rotate_(Rotate), Cfg_(Cfg), ImW_(ImW), ImH_(ImH),
         DstBuffer_(ImW * ImH) {}
 
-  using CalcDataTy = std::pair<unsigned, unsigned long long>;
+  using CalcDataTy = Timing_t;
   CalcDataTy calculate(sycl::float4 *SrcData, float Theta) {
     Timer Tm;
     Tm.start();
@@ -239,71 +260,88 @@ void disp_tester(const Ty *Data, int ImW, int ImH,
 
 template <typename RotateChildT> void test_sequence(int argc, char **argv) {
   try {
-    auto Cfg = rotate::read_config(argc, argv);
+    options::Parser OptParser;
+    rotate::add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return rotate::read_config(Parser, argv[0]);
+    });
     qout << "Welcome to image rotateing!\n";
-    dump_config_info(Cfg);
     auto Q = set_queue();
     print_info(qout, Q.get_device());
 
-    auto Image = rotate::init_image(Cfg);
-    const auto ImW = Image.width();
-    const auto ImH = Image.height();
-    qout << "Range: " << ImW << " x " << ImH << "\n";
-    std::vector<sycl::float4> SrcBuffer(ImW * ImH);
-    drawer::img_to_float4(Image, SrcBuffer.data());
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      auto &Cfg = Cfgs[I];
+      dump_sweep_point(I, Cfgs.size());
+      dump_config_info(Cfg);
+
+      reseed(Cfg.Bench);
+      auto Image = rotate::init_image(Cfg);
+      const auto ImW = Image.width();
+      const auto ImH = Image.height();
+      qout << "Range: " << ImW << " x " << ImH << "\n";
+      std::vector<sycl::float4> SrcBuffer(ImW * ImH);
+      drawer::img_to_float4(Image, SrcBuffer.data());
 
-    rotate::check_device_props(Q.get_device(), Cfg);
+      rotate::check_device_props(Q.get_device(), Cfg);
 
 #if defined(MEASURE_NORMAL)
-    qout << "Calculating host\n";
-    RotateHost RotateHost{Q}; // arg unused
-    RotateTester TesterH{RotateHost, Cfg, ImW, ImH};
-    auto ElapsedH = TesterH.calculate(SrcBuffer.data(), Cfg.Theta);
-    qout << "Measured host time: " << ElapsedH.first / msec_per_sec << "\n";
+      qout << "Calculating host\n";
+      RotateHost RotateHost{Q}; // arg unused
+      RotateTester TesterH{RotateHost, Cfg, ImW, ImH};
+      measure_host(Cfg.Bench, [&] {
+        return TesterH.calculate(SrcBuffer.data(), Cfg.Theta);
+      });
 #endif
 
-    RotateChildT RotateGPU{Q, Cfg};
-    RotateTester Tester{RotateGPU, Cfg, ImW, ImH};
-    qout << "Calculating GPU\n";
-    auto Elapsed = Tester.calculate(SrcBuffer.data(), Cfg.Theta);
-    qout << "Measured time: " << Elapsed.first / msec_per_sec << "\n";
-    auto ExecTime = Elapsed.second / nsec_per_sec;
-    qout << "Pure execution time: " << ExecTime << "\n";
-
-    // Quiet mode output: rotate size, elapsed time
-    if (Cfg.Quiet) {
-      qout.set(!Cfg.Quiet);
-      qout << ImW << " " << ExecTime << "\n";
-      qout.set(Cfg.Quiet);
-    }
+      RotateChildT RotateGPU{Q, Cfg};
+      RotateTester Tester{RotateGPU, Cfg, ImW, ImH};
+      qout << "Calculating GPU\n";
+      auto Bench = run_bench(Cfg.Bench, [&] {
+        return Tester.calculate(SrcBuffer.data(), Cfg.Theta);
+      });
+      attach_work(Q, Cfg.Bench, Bench, rotate::work_count(ImW, ImH));
+      qout << "Measured time: " << SecFmt{Bench.WallStats.Median} << "\n";
+      auto ExecTime = Bench.EvtStats.Median;
+      qout << "Pure execution time: " << SecFmt{ExecTime} << "\n";
+      dump_bench(qout, Bench);
+      report_result("rotate", Cfg, Q.get_device(), Bench);
+
+      // Quiet mode output: rotate size, elapsed time
+      if (Cfg.Quiet) {
+        qout.set(!Cfg.Quiet);
+        qout << ImW << " " << SecFmt{ExecTime} << "\n";
+        qout.set(Cfg.Quiet);
+      }
 
 #if defined(MEASURE_NORMAL) && defined(VERIFY)
-    // Do we need formal verification here? Is it even possible?
-    // What worries me a lot: we are interpolating on GPU with sampler, so
-    // pixel-to-pixel we may have different picture, which is fine.
+      // Do we need formal verification here? Is it even possible?
+      // What worries me a lot: we are interpolating on GPU with sampler, so
+      // pixel-to-pixel we may have different picture, which is fine.
 #endif
 
-    if (Cfg.Visualize) {
+      if (Cfg.Visualize) {
 #if defined(SHOW_ORIG)
-      cimg_library::CImgDisplay MainDisp(Image, "Rotateing image source");
+        cimg_library::CImgDisplay MainDisp(Image, "Rotateing image source");
 #endif
 #if defined(MEASURE_NORMAL)
-      cimg_library::CImgDisplay ResDispH(ImW, ImH, "Image result: host", 0);
-      disp_tester(TesterH.data(), ImW, ImH, ResDispH);
+        cimg_library::CImgDisplay ResDispH(ImW, ImH, "Image result: host", 0);
+        disp_tester(TesterH.data(), ImW, ImH, ResDispH);
 #endif
-      cimg_library::CImgDisplay ResDisp(ImW, ImH, "Image result: GPU", 0);
-      disp_tester(Tester.data(), ImW, ImH, ResDisp);
-      while (!ResDisp.is_closed()) {
-        cimg_library::cimg::wait(20);
-        int Inc = 0;
-        if (ResDisp.is_keyARROWUP())
-          Inc = rotate::AMT_STEP;
-        else if (ResDisp.is_keyARROWDOWN())
-          Inc = -rotate::AMT_STEP;
-        if (Inc != 0) {
-          Cfg.Theta += Inc * std::numbers::pi / 180.0;
-          Tester.calculate(SrcBuffer.data(), Cfg.Theta);
-          disp_tester(Tester.data(), ImW, ImH, ResDisp);
+        cimg_library::CImgDisplay ResDisp(ImW, ImH, "Image result: GPU", 0);
+        disp_tester(Tester.data(), ImW, ImH, ResDisp);
+        while (!ResDisp.is_closed()) {
+          cimg_library::cimg::wait(20);
+          int Inc = 0;
+          if (ResDisp.is_keyARROWUP())
+            Inc = rotate::AMT_STEP;
+          else if (ResDisp.is_keyARROWDOWN())
+            Inc = -rotate::AMT_STEP;
+          if (Inc != 0) {
+            Cfg.Theta += Inc * std::numbers::pi / 180.0;
+            Tester.calculate(SrcBuffer.data(), Cfg.Theta);
+            disp_tester(Tester.data(), ImW, ImH, ResDisp);
+          }
         }
       }
     }
@@ -75,6 +75,10 @@ public:
   }
 };
 
+REGISTER_VARIANT(sgemm, "matmult", MatrixMultNaiveBuf<float>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<MatrixMultNaiveBuf<float>>(argc, argv);
-}
\ No newline at end of file
+}
+#endif
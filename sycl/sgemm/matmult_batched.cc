@@ -0,0 +1,237 @@
+//------------------------------------------------------------------------------
+//
+// Batched matrix multiplication with local memory kernel (SYCL vs serial CPU)
+// Many small products of same sizes in one launch: batch is first dimension
+// of nd_range, every group makes one LSZ x LSZ tile of one product, so small
+// matrices still fill the device. Tiles are as in matmult_local_shared.
+//
+// Strided form: matrices of batch are back to back in A, B and C
+// Pointer-array form (-batchptr): device table of pointers per matrix
+//
+// Low precision inputs with wider accumulator: matmult_batched_half,
+// matmult_batched_bf16, matmult_batched_int8 (see GEMM_PREC in
+// sgemm_testers.hpp)
+//
+// try: matmult_batched.exe -bsz=1 -ax=32 -ay=32 -by=32 -batch=1000
+//      matmult_batched_int8.exe -bsz=1 -ax=32 -ay=32 -by=32 -batch=1000
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+#include "sgemm_testers.hpp"
+
+// class is used for kernel name
+template <typename T, typename AccT, bool PtrArray> class mmult_batched;
+
+using ConfigTy = sycltesters::sgemm::Config;
+
+// tiles keep input type T, sum is in accumulator type AccT
+template <typename T, typename AccT = T>
+class MatrixMultBatched : public sycltesters::BatchedMatrixMult<T, AccT> {
+  using sycltesters::BatchedMatrixMult<T, AccT>::Queue;
+  ConfigTy Cfg_;
+
+  // GetA(I), GetB(I), GetC(I) give matrix I of batch on device
+  template <bool PtrArray, typename GetAT, typename GetBT, typename GetCT>
+  sycl::event submit(const std::vector<sycl::event> &Deps, GetAT GetA,
+                     GetBT GetB, GetCT GetC, size_t AX, size_t AY, size_t BY,
+                     size_t Batch) {
+    const int LSZ = Cfg_.Lsz; // avoid implicit capture of this
+    // full tiles along AY and width of last partial one
+    const int NumTiles = AY / LSZ;
+    const int Rem = AY % LSZ;
+    const int AXI = AX, AYI = AY, BYI = BY;
+
+    // one product per index of first dimension
+    sycl::range<3> BlockSize{1, LSZ, LSZ};
+    sycl::range<3> Grid{Batch, simplemath::roundup<size_t>(AX, LSZ),
+                        simplemath::roundup<size_t>(BY, LSZ)};
+    sycl::nd_range<3> Range{Grid, BlockSize};
+
+    return Queue().submit([&](sycl::handler &Cgh) {
+      Cgh.depends_on(Deps);
+      // local memory
+      using LTy = sycl::accessor<T, 2, sycl_read_write, sycl_local>;
+      sycl::range<2> TileSize{LSZ, LSZ};
+      LTy Asub{TileSize, Cgh}, Bsub{TileSize, Cgh};
+
+      auto KernMul = [=](sycl::nd_item<3> It) {
+        const size_t Idx = It.get_group(0);
+        const T *A = GetA(Idx);
+        const T *B = GetB(Idx);
+        AccT *C = GetC(Idx);
+        const int Row = It.get_local_id(1);
+        const int Col = It.get_local_id(2);
+        const int GlobalRow = LSZ * It.get_group(1) + Row;
+        const int GlobalCol = LSZ * It.get_group(2) + Col;
+        // same for whole group, so no divergence inside group
+        const bool Interior = (It.get_group(1) + 1) * LSZ <= AXI &&
+                              (It.get_group(2) + 1) * LSZ <= BYI;
+        const bool RowIn = GlobalRow < AXI, ColIn = GlobalCol < BYI;
+
+        AccT Sum = 0;
+        for (int Tile = 0; Tile < NumTiles; Tile++) {
+          const int TiledRow = LSZ * Tile + Row;
+          const int TiledCol = LSZ * Tile + Col;
+          if (Interior) {
+            Asub[Row][Col] = A[GlobalRow * AYI + TiledCol];
+            Bsub[Row][Col] = B[TiledRow * BYI + GlobalCol];
+          } else {
+            Asub[Row][Col] = RowIn ? A[GlobalRow * AYI + TiledCol] : T(0);
+            Bsub[Row][Col] = ColIn ? B[TiledRow * BYI + GlobalCol] : T(0);
+          }
+          // waiting for all threads to fill Asub[Row][Col]
+          It.barrier(sycl_local_fence);
+          for (int K = 0; K < LSZ; K++)
+            Sum += AccT(Asub[Row][K]) * AccT(Bsub[K][Col]);
+          // waiting for all threads to use Asub[Row][Col]
+          It.barrier(sycl_local_fence);
+        }
+
+        // last partial tile along AY
+        if (Rem > 0) {
+          const int TiledRow = LSZ * NumTiles + Row;
+          const int TiledCol = LSZ * NumTiles + Col;
+          Asub[Row][Col] =
+              (RowIn && Col < Rem) ? A[GlobalRow * AYI + TiledCol] : T(0);
+          Bsub[Row][Col] =
+              (ColIn && Row < Rem) ? B[TiledRow * BYI + GlobalCol] : T(0);
+          It.barrier(sycl_local_fence);
+          for (int K = 0; K < Rem; K++)
+            Sum += AccT(Asub[Row][K]) * AccT(Bsub[K][Col]);
+        }
+
+        if (RowIn && ColIn)
+          C[GlobalRow * BYI + GlobalCol] = Sum;
+      };
+
+      Cgh.parallel_for<class mmult_batched<T, AccT, PtrArray>>(Range,
+                                                               KernMul);
+    });
+  }
+
+public:
+  MatrixMultBatched(sycl::queue &DeviceQueue, ConfigTy Cfg)
+      : sycltesters::BatchedMatrixMult<T, AccT>(DeviceQueue), Cfg_(Cfg) {}
+
+  sycltesters::EvtRet_t operator()(const T *Aptr, size_t StrideA,
+                                   const T *Bptr, size_t StrideB, AccT *Cptr,
+                                   size_t StrideC, size_t AX, size_t AY,
+                                   size_t BY, size_t Batch) override {
+    assert(Aptr != nullptr && Bptr != nullptr && Cptr != nullptr);
+    assert(StrideA >= AX * AY && StrideB >= AY * BY && StrideC >= AX * BY);
+    assert(Batch > 0);
+    sycltesters::EvtVec_t ProfInfo;
+    auto &DeviceQueue = Queue();
+    const size_t SzA = (Batch - 1) * StrideA + AX * AY;
+    const size_t SzB = (Batch - 1) * StrideB + AY * BY;
+    const size_t SzC = (Batch - 1) * StrideC + AX * BY;
+
+    auto *A = sycltesters::pool_malloc_device<T>(SzA, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_device<T>(SzB, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_device<AccT>(SzC, DeviceQueue);
+    // events are wrapped right after submit: host stamp is taken there
+    auto EvtCpyA = DeviceQueue.copy(Aptr, A, SzA);
+    ProfInfo.emplace_back(EvtCpyA, "Copy A batch");
+    auto EvtCpyB = DeviceQueue.copy(Bptr, B, SzB);
+    ProfInfo.emplace_back(EvtCpyB, "Copy B batch");
+
+    auto Evt = submit<false>(
+        {EvtCpyA, EvtCpyB}, [=](size_t I) { return A + I * StrideA; },
+        [=](size_t I) { return B + I * StrideB; },
+        [=](size_t I) { return C + I * StrideC; }, AX, AY, BY, Batch);
+    ProfInfo.emplace_back(Evt, "Main execution");
+    // only AX x BY of every product: gaps of padded strides in host C
+    // belong to caller
+    std::vector<sycl::event> CopiesBack;
+    for (size_t I = 0; I < Batch; ++I) {
+      CopiesBack.push_back(DeviceQueue.copy(C + I * StrideC, Cptr + I * StrideC,
+                                            AX * BY, Evt));
+      ProfInfo.emplace_back(CopiesBack.back(), "Copy C batch back");
+    }
+    sycl::event::wait(CopiesBack);
+
+    // reverse order: pool is LIFO, next call gets same blocks
+    sycltesters::pool_free(C, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    return ProfInfo;
+  }
+
+  sycltesters::EvtRet_t operator()(const T *const *Aptrs,
+                                   const T *const *Bptrs, AccT *const *Cptrs,
+                                   size_t AX, size_t AY, size_t BY,
+                                   size_t Batch) override {
+    assert(Aptrs != nullptr && Bptrs != nullptr && Cptrs != nullptr);
+    assert(Batch > 0);
+    sycltesters::EvtVec_t ProfInfo;
+    auto &DeviceQueue = Queue();
+    const size_t SzA = AX * AY, SzB = AY * BY, SzC = AX * BY;
+
+    // host matrices may be anywhere: gather them to device, one per slice,
+    // kernel sees them only through pointer tables
+    auto *A = sycltesters::pool_malloc_device<T>(SzA * Batch, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_device<T>(SzB * Batch, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_device<AccT>(SzC * Batch, DeviceQueue);
+    auto *ATab = sycltesters::pool_malloc_device<const T *>(Batch, DeviceQueue);
+    auto *BTab = sycltesters::pool_malloc_device<const T *>(Batch, DeviceQueue);
+    auto *CTab = sycltesters::pool_malloc_device<AccT *>(Batch, DeviceQueue);
+
+    std::vector<const T *> HostATab(Batch), HostBTab(Batch);
+    std::vector<AccT *> HostCTab(Batch);
+    std::vector<sycl::event> Copies;
+    for (size_t I = 0; I < Batch; ++I) {
+      HostATab[I] = A + I * SzA;
+      HostBTab[I] = B + I * SzB;
+      HostCTab[I] = C + I * SzC;
+      Copies.push_back(DeviceQueue.copy(Aptrs[I], A + I * SzA, SzA));
+      ProfInfo.emplace_back(Copies.back(), "Copy batch in");
+      Copies.push_back(DeviceQueue.copy(Bptrs[I], B + I * SzB, SzB));
+      ProfInfo.emplace_back(Copies.back(), "Copy batch in");
+    }
+    Copies.push_back(DeviceQueue.copy(HostATab.data(), ATab, Batch));
+    ProfInfo.emplace_back(Copies.back(), "Copy batch in");
+    Copies.push_back(DeviceQueue.copy(HostBTab.data(), BTab, Batch));
+    ProfInfo.emplace_back(Copies.back(), "Copy batch in");
+    Copies.push_back(DeviceQueue.copy(HostCTab.data(), CTab, Batch));
+    ProfInfo.emplace_back(Copies.back(), "Copy batch in");
+
+    auto Evt = submit<true>(
+        Copies, [=](size_t I) { return ATab[I]; },
+        [=](size_t I) { return BTab[I]; }, [=](size_t I) { return CTab[I]; },
+        AX, AY, BY, Batch);
+    ProfInfo.emplace_back(Evt, "Main execution");
+
+    std::vector<sycl::event> CopiesBack;
+    for (size_t I = 0; I < Batch; ++I) {
+      CopiesBack.push_back(DeviceQueue.copy(C + I * SzC, Cptrs[I], SzC, Evt));
+      ProfInfo.emplace_back(CopiesBack.back(), "Copy C back");
+    }
+    sycl::event::wait(CopiesBack);
+
+    // reverse order: pool is LIFO, next call gets same blocks
+    sycltesters::pool_free(CTab, DeviceQueue);
+    sycltesters::pool_free(BTab, DeviceQueue);
+    sycltesters::pool_free(ATab, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    return ProfInfo;
+  }
+};
+
+int main(int argc, char **argv) {
+  using namespace sycltesters::sgemm;
+  sycltesters::batched_test_sequence<MatrixMultBatched<InTy, AccTy>>(argc,
+                                                                     argv);
+}
@@ -43,15 +43,15 @@ public:
     int X = 1;
 
 #ifdef SHARED
-    auto *A = sycl::malloc_shared<T>(AX * AY, DeviceQueue);
-    auto *B = sycl::malloc_shared<T>(AY * BY, DeviceQueue);
-    auto *C = sycl::malloc_shared<T>(AX * BY, DeviceQueue);
+    auto *A = sycltesters::pool_malloc_shared<T>(AX * AY, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_shared<T>(AY * BY, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_shared<T>(AX * BY, DeviceQueue);
     std::copy(Aptr, Aptr + AX * AY, A);
     std::copy(Bptr, Bptr + AY * BY, B);
 #else
-    auto *A = sycl::malloc_device<T>(AX * AY, DeviceQueue);
-    auto *B = sycl::malloc_device<T>(AY * BY, DeviceQueue);
-    auto *C = sycl::malloc_device<T>(AX * BY, DeviceQueue);
+    auto *A = sycltesters::pool_malloc_device<T>(AX * AY, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_device<T>(AY * BY, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_device<T>(AX * BY, DeviceQueue);
     auto EvtCpyA = DeviceQueue.copy(Aptr, A, AX * AY);
     auto EvtCpyB = DeviceQueue.copy(Bptr, B, AY * BY);
     ProfInfo.emplace_back(EvtCpyA, "Copy A forth");
@@ -88,13 +88,17 @@ public:
     DeviceQueue.wait();
 #endif
 
-    sycl::free(A, DeviceQueue);
-    sycl::free(B, DeviceQueue);
-    sycl::free(C, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(sgemm, "matmult_device", MatrixMultNaiveShared<float>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<MatrixMultNaiveShared<float>>(argc, argv);
-}
\ No newline at end of file
+}
+#endif
@@ -106,6 +106,10 @@ public:
   }
 };
 
+REGISTER_VARIANT(sgemm, "matmult_groups", MatrixMultGroups<float>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<MatrixMultGroups<float>>(argc, argv);
-}
\ No newline at end of file
+}
+#endif
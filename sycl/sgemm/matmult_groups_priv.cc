@@ -24,12 +24,12 @@ template <typename T> class mmult_groups_priv;
 using ConfigTy = sycltesters::sgemm::Config;
 
 template <typename T>
-class MatrixMultGroups : public sycltesters::MatrixMult<T> {
+class MatrixMultGroupsPriv : public sycltesters::MatrixMult<T> {
   using sycltesters::MatrixMult<T>::Queue;
   ConfigTy Cfg_;
 
 public:
-  MatrixMultGroups(sycl::queue &DeviceQueue, ConfigTy Cfg)
+  MatrixMultGroupsPriv(sycl::queue &DeviceQueue, ConfigTy Cfg)
       : sycltesters::MatrixMult<T>(DeviceQueue), Cfg_(Cfg) {}
 
   sycltesters::EvtRet_t operator()(const T *Aptr, const T *Bptr, T *Cptr,
@@ -108,6 +108,10 @@ public:
   }
 };
 
+REGISTER_VARIANT(sgemm, "matmult_groups_priv", MatrixMultGroupsPriv<float>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
-  sycltesters::test_sequence<MatrixMultGroups<float>>(argc, argv);
-}
\ No newline at end of file
+  sycltesters::test_sequence<MatrixMultGroupsPriv<float>>(argc, argv);
+}
+#endif
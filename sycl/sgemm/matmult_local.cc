@@ -2,7 +2,15 @@
 //
 // Matrix multiplication with local memory kernel (SYCL vs serial CPU)
 //
+// Any matrix sizes: groups on edges of C and last tile along AY are bounds
+// checked, interior groups take unchecked path
+//
+// Low precision inputs with wider accumulator: matmult_local_half,
+// matmult_local_bf16, matmult_local_int8 (see GEMM_PREC in sgemm_testers.hpp)
+//
 // try: matmult_local.exe -lsz=16
+//      matmult_local.exe -bsz=1 -ax=1000 -ay=777 -by=1531
+//      matmult_local_int8.exe -lsz=16
 //
 //------------------------------------------------------------------------------
 //
@@ -20,36 +28,43 @@
 #include "sgemm_testers.hpp"
 
 // class is used for kernel name
-template <typename T> class mmult_local_buf;
+template <typename T, typename AccT> class mmult_local_buf;
 
 using ConfigTy = sycltesters::sgemm::Config;
 
-template <typename T>
-class MatrixMultLocalBuf : public sycltesters::MatrixMult<T> {
-  using sycltesters::MatrixMult<T>::Queue;
+// tiles keep input type T, sum is in accumulator type AccT
+template <typename T, typename AccT = T>
+class MatrixMultLocalBuf : public sycltesters::MatrixMult<T, AccT> {
+  using sycltesters::MatrixMult<T, AccT>::Queue;
   ConfigTy Cfg_;
 
 public:
+  static constexpr bool any_size = true; // see sgemm::tune_space
   MatrixMultLocalBuf(sycl::queue &DeviceQueue, ConfigTy Cfg)
-      : sycltesters::MatrixMult<T>(DeviceQueue), Cfg_(Cfg) {}
+      : sycltesters::MatrixMult<T, AccT>(DeviceQueue), Cfg_(Cfg) {}
 
-  sycltesters::EvtRet_t operator()(const T *Aptr, const T *Bptr, T *Cptr,
+  sycltesters::EvtRet_t operator()(const T *Aptr, const T *Bptr, AccT *Cptr,
                                    size_t AX, size_t AY, size_t BY) override {
     assert(Aptr != nullptr && Bptr != nullptr && Cptr != nullptr);
     const int LSZ = Cfg_.Lsz; // avoid implicit capture of this
-    if ((AY % LSZ) != 0)
-      throw std::runtime_error("Expect local size = multiple of AY");
+    // full tiles along AY and width of last partial one
     const int NumTiles = AY / LSZ;
+    const int Rem = AY % LSZ;
+    const int AXI = AX, BYI = BY;
     sycltesters::EvtVec_t ProfInfo;
     sycl::range<2> Asz{AX, AY}, Bsz{AY, BY}, Csz{AX, BY};
-    sycl::buffer<T, 2> BufA(Aptr, Asz), BufB(Bptr, Bsz), BufC(Cptr, Csz);
+    sycl::buffer<T, 2> BufA(Aptr, Asz), BufB(Bptr, Bsz);
+    sycl::buffer<AccT, 2> BufC(Cptr, Csz);
     BufA.set_final_data(nullptr);
     BufB.set_final_data(nullptr);
 
     auto &DeviceQueue = Queue();
 
+    // any sizes: iteration space is rounded up, edge groups are checked
     cl::sycl::range<2> BlockSize{LSZ, LSZ};
-    cl::sycl::nd_range<2> Range{Csz, BlockSize};
+    cl::sycl::range<2> Grid{simplemath::roundup<size_t>(AX, LSZ),
+                            simplemath::roundup<size_t>(BY, LSZ)};
+    cl::sycl::nd_range<2> Range{Grid, BlockSize};
 
     auto Evt = DeviceQueue.submit([&](cl::sycl::handler &Cgh) {
       auto A = BufA.template get_access<sycl_read>(Cgh);
@@ -65,28 +80,50 @@ public:
         const int Col = It.get_local_id(1);
         const int GlobalRow = It.get_global_id(0);
         const int GlobalCol = It.get_global_id(1);
+        // same for whole group, so no divergence inside group
+        const bool Interior = (It.get_group(0) + 1) * LSZ <= AXI &&
+                              (It.get_group(1) + 1) * LSZ <= BYI;
+        const bool RowIn = GlobalRow < AXI, ColIn = GlobalCol < BYI;
 
-        T Sum = 0;
+        AccT Sum = 0;
         for (int Tile = 0; Tile < NumTiles; Tile++) {
           const int TiledRow = LSZ * Tile + Row;
           const int TiledCol = LSZ * Tile + Col;
-          Asub[Row][Col] = A[GlobalRow][TiledCol];
-          Bsub[Row][Col] = B[TiledRow][GlobalCol];
+          if (Interior) {
+            Asub[Row][Col] = A[GlobalRow][TiledCol];
+            Bsub[Row][Col] = B[TiledRow][GlobalCol];
+          } else {
+            Asub[Row][Col] = RowIn ? A[GlobalRow][TiledCol] : T(0);
+            Bsub[Row][Col] = ColIn ? B[TiledRow][GlobalCol] : T(0);
+          }
 #ifndef NOBARRIER
           // waiting for all threads to fill Asub[Row][Col]
           It.barrier(sycl_local_fence);
 #endif
           for (int K = 0; K < LSZ; K++)
-            Sum += Asub[Row][K] * Bsub[K][Col];
+            Sum += AccT(Asub[Row][K]) * AccT(Bsub[K][Col]);
 #ifndef NOBARRIER
           // waiting for all threads to use Asub[Row][Col]
           It.barrier(sycl_local_fence);
 #endif
         }
-        C[GlobalRow][GlobalCol] = Sum;
+
+        // last partial tile along AY
+        if (Rem > 0) {
+          const int TiledRow = LSZ * NumTiles + Row;
+          const int TiledCol = LSZ * NumTiles + Col;
+          Asub[Row][Col] = (RowIn && Col < Rem) ? A[GlobalRow][TiledCol] : T(0);
+          Bsub[Row][Col] = (ColIn && Row < Rem) ? B[TiledRow][GlobalCol] : T(0);
+          It.barrier(sycl_local_fence);
+          for (int K = 0; K < Rem; K++)
+            Sum += AccT(Asub[Row][K]) * AccT(Bsub[K][Col]);
+        }
+
+        if (RowIn && ColIn)
+          C[GlobalRow][GlobalCol] = Sum;
       };
 
-      Cgh.parallel_for<class mmult_local_buf<T>>(Range, KernMul);
+      Cgh.parallel_for<class mmult_local_buf<T, AccT>>(Range, KernMul);
     });
 
     ProfInfo.emplace_back(Evt, "Main execution");
@@ -95,6 +132,11 @@ public:
   }
 };
 
+REGISTER_VARIANT(sgemm, "matmult_local", MatrixMultLocalBuf<float>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
-  sycltesters::test_sequence<MatrixMultLocalBuf<float>>(argc, argv);
-}
\ No newline at end of file
+  using namespace sycltesters::sgemm;
+  sycltesters::test_sequence<MatrixMultLocalBuf<InTy, AccTy>>(argc, argv);
+}
+#endif
@@ -2,6 +2,8 @@
 //
 // Matrix multiplication with local memory kernel (SYCL vs serial CPU)
 // Uses shared memory instead of buffers
+// Any matrix sizes: edge groups and last tile along AY are bounds checked
+// Input and accumulator types: see GEMM_PREC in sgemm_testers.hpp
 //
 // try: matmult_local_shared.exe -lsz=16
 //
@@ -21,39 +23,46 @@
 #include "sgemm_testers.hpp"
 
 // class is used for kernel name
-template <typename T> class mmult_local_shared;
+template <typename T, typename AccT> class mmult_local_shared;
 
 using ConfigTy = sycltesters::sgemm::Config;
 
-template <typename T>
-class MatrixMultLocalShared : public sycltesters::MatrixMult<T> {
-  using sycltesters::MatrixMult<T>::Queue;
+// tiles keep input type T, sum is in accumulator type AccT
+template <typename T, typename AccT = T>
+class MatrixMultLocalShared : public sycltesters::MatrixMult<T, AccT> {
+  using sycltesters::MatrixMult<T, AccT>::Queue;
   ConfigTy Cfg_;
 
 public:
+  static constexpr bool any_size = true; // see sgemm::tune_space
   MatrixMultLocalShared(sycl::queue &DeviceQueue, ConfigTy Cfg)
-      : sycltesters::MatrixMult<T>(DeviceQueue), Cfg_(Cfg) {}
+      : sycltesters::MatrixMult<T, AccT>(DeviceQueue), Cfg_(Cfg) {}
 
-  sycltesters::EvtRet_t operator()(const T *Aptr, const T *Bptr, T *Cptr,
+  sycltesters::EvtRet_t operator()(const T *Aptr, const T *Bptr, AccT *Cptr,
                                    size_t AX, size_t AY, size_t BY) override {
     assert(Aptr != nullptr && Bptr != nullptr && Cptr != nullptr);
-    const auto LSZ = Cfg_.Lsz; // avoid implicit capture of this
-    if ((AY % LSZ) != 0)
-      throw std::runtime_error("Expect local size = multiple of AY");
+    const int LSZ = Cfg_.Lsz; // avoid implicit capture of this
+    // full tiles along AY and width of last partial one
+    const int NumTiles = AY / LSZ;
+    const int Rem = AY % LSZ;
+    const int AXI = AX, AYI = AY, BYI = BY;
     sycltesters::EvtVec_t ProfInfo;
     auto &DeviceQueue = Queue();
 
-    auto *A = sycl::malloc_shared<T>(AX * AY, DeviceQueue);
-    auto *B = sycl::malloc_shared<T>(AY * BY, DeviceQueue);
-    auto *C = sycl::malloc_shared<T>(AX * BY, DeviceQueue);
+    auto *A = sycltesters::pool_malloc_shared<T>(AX * AY, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_shared<T>(AY * BY, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_shared<AccT>(AX * BY, DeviceQueue);
     // alternative:
     // auto EvtCpyA = DeviceQueue.copy(Aptr, A, AX * AY);
     std::copy(Aptr, Aptr + AX * AY, A);
     std::copy(Bptr, Bptr + AY * BY, B);
     std::fill(Cptr, Cptr + AX * BY, 0);
 
+    // any sizes: iteration space is rounded up, edge groups are checked
     sycl::range<2> BlockSize{LSZ, LSZ};
-    sycl::nd_range<2> Range{sycl::range<2>{AX, BY}, BlockSize};
+    sycl::range<2> Grid{simplemath::roundup<size_t>(AX, LSZ),
+                        simplemath::roundup<size_t>(BY, LSZ)};
+    sycl::nd_range<2> Range{Grid, BlockSize};
 
     auto Evt = DeviceQueue.submit([&](sycl::handler &Cgh) {
       // local memory
@@ -65,25 +74,48 @@ public:
         const int Col = It.get_local_id(1);
         const int GlobalRow = LSZ * It.get_group(0) + Row;
         const int GlobalCol = LSZ * It.get_group(1) + Col;
-        const int NumTiles = AY / LSZ;
+        // same for whole group, so no divergence inside group
+        const bool Interior = (It.get_group(0) + 1) * LSZ <= AXI &&
+                              (It.get_group(1) + 1) * LSZ <= BYI;
+        const bool RowIn = GlobalRow < AXI, ColIn = GlobalCol < BYI;
 
-        T Sum = 0;
+        AccT Sum = 0;
         for (int Tile = 0; Tile < NumTiles; Tile++) {
           const int TiledRow = LSZ * Tile + Row;
           const int TiledCol = LSZ * Tile + Col;
-          Asub[Row][Col] = A[GlobalRow * AY + TiledCol];
-          Bsub[Row][Col] = B[TiledRow * BY + GlobalCol];
+          if (Interior) {
+            Asub[Row][Col] = A[GlobalRow * AYI + TiledCol];
+            Bsub[Row][Col] = B[TiledRow * BYI + GlobalCol];
+          } else {
+            Asub[Row][Col] = RowIn ? A[GlobalRow * AYI + TiledCol] : T(0);
+            Bsub[Row][Col] = ColIn ? B[TiledRow * BYI + GlobalCol] : T(0);
+          }
           // waiting for all threads to fill Asub[Row][Col]
           It.barrier(sycl_local_fence);
           for (int K = 0; K < LSZ; K++)
-            Sum += Asub[Row][K] * Bsub[K][Col];
+            Sum += AccT(Asub[Row][K]) * AccT(Bsub[K][Col]);
           // waiting for all threads to use Asub[Row][Col]
           It.barrier(sycl_local_fence);
         }
-        C[GlobalRow * BY + GlobalCol] = Sum;
+
+        // last partial tile along AY
+        if (Rem > 0) {
+          const int TiledRow = LSZ * NumTiles + Row;
+          const int TiledCol = LSZ * NumTiles + Col;
+          Asub[Row][Col] =
+              (RowIn && Col < Rem) ? A[GlobalRow * AYI + TiledCol] : T(0);
+          Bsub[Row][Col] =
+              (ColIn && Row < Rem) ? B[TiledRow * BYI + GlobalCol] : T(0);
+          It.barrier(sycl_local_fence);
+          for (int K = 0; K < Rem; K++)
+            Sum += AccT(Asub[Row][K]) * AccT(Bsub[K][Col]);
+        }
+
+        if (RowIn && ColIn)
+          C[GlobalRow * BYI + GlobalCol] = Sum;
       };
 
-      Cgh.parallel_for<class mmult_local_shared<T>>(Range, KernMul);
+      Cgh.parallel_for<class mmult_local_shared<T, AccT>>(Range, KernMul);
     });
 
     ProfInfo.push_back(Evt);
@@ -91,13 +123,18 @@ public:
 
     // copy back
     std::copy(C, C + AX * BY, Cptr);
-    sycl::free(A, DeviceQueue);
-    sycl::free(B, DeviceQueue);
-    sycl::free(C, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(sgemm, "matmult_local_shared", MatrixMultLocalShared<float>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
-  sycltesters::test_sequence<MatrixMultLocalShared<float>>(argc, argv);
-}
\ No newline at end of file
+  using namespace sycltesters::sgemm;
+  sycltesters::test_sequence<MatrixMultLocalShared<InTy, AccTy>>(argc, argv);
+}
+#endif
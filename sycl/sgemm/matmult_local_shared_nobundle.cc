@@ -48,9 +48,9 @@ public:
     sycltesters::EvtVec_t ProfInfo;
     auto &DeviceQueue = Queue();
 
-    auto *A = sycl::malloc_shared<T>(AX * AY, DeviceQueue);
-    auto *B = sycl::malloc_shared<T>(AY * BY, DeviceQueue);
-    auto *C = sycl::malloc_shared<T>(AX * BY, DeviceQueue);
+    auto *A = sycltesters::pool_malloc_shared<T>(AX * AY, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_shared<T>(AY * BY, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_shared<T>(AX * BY, DeviceQueue);
     // alternative:
     // auto EvtCpyA = DeviceQueue.copy(Aptr, A, AX * AY);
     std::copy(Aptr, Aptr + AX * AY, A);
@@ -105,13 +105,18 @@ public:
 
     // copy back
     std::copy(C, C + AX * BY, Cptr);
-    sycl::free(A, DeviceQueue);
-    sycl::free(B, DeviceQueue);
-    sycl::free(C, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(sgemm, "matmult_local_shared_nobundle",
+                 MatrixMultLocalSharedNoBundle<float>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<MatrixMultLocalSharedNoBundle<float>>(argc, argv);
-}
\ No newline at end of file
+}
+#endif
@@ -48,9 +48,9 @@ public:
     sycltesters::EvtVec_t ProfInfo;
     auto &DeviceQueue = Queue();
 
-    auto *A = sycl::malloc_shared<T>(AX * AY, DeviceQueue);
-    auto *B = sycl::malloc_shared<T>(AY * BY, DeviceQueue);
-    auto *C = sycl::malloc_shared<T>(AX * BY, DeviceQueue);
+    auto *A = sycltesters::pool_malloc_shared<T>(AX * AY, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_shared<T>(AY * BY, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_shared<T>(AX * BY, DeviceQueue);
     // alternative:
     // auto EvtCpyA = DeviceQueue.copy(Aptr, A, AX * AY);
     std::copy(Aptr, Aptr + AX * AY, A);
@@ -60,14 +60,9 @@ public:
     sycl::range<2> BlockSize{LSZ, LSZ};
     sycl::nd_range<2> Range{sycl::range<2>{AX, BY}, BlockSize};
 
-    sycl::kernel_id KId = sycl::get_kernel_id<mmult_local_shared_spec<T>>();
-    sycl::kernel_bundle KbSrc =
-        sycl::get_kernel_bundle<sycl::bundle_state::input>(
-            DeviceQueue.get_context(), {KId});
-    KbSrc.template set_specialization_constant<AYC>(AY);
-    KbSrc.template set_specialization_constant<BYC>(BY);
-    KbSrc.template set_specialization_constant<LSZC>(LSZ);
-    sycl::kernel_bundle Kb = sycl::build(KbSrc);
+    // built once per AY, BY, LSZ, then taken from cache
+    auto Kb = sycltesters::build_cached<mmult_local_shared_spec<T>, AYC, BYC,
+                                        LSZC>(DeviceQueue, AY, BY, LSZ);
 
     auto Evt = DeviceQueue.submit([&](sycl::handler &Cgh) {
       // local memory
@@ -112,13 +107,18 @@ public:
 
     // copy back
     std::copy(C, C + AX * BY, Cptr);
-    sycl::free(A, DeviceQueue);
-    sycl::free(B, DeviceQueue);
-    sycl::free(C, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(sgemm, "matmult_local_shared_spec",
+                 MatrixMultLocalSharedSpec<float>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<MatrixMultLocalSharedSpec<float>>(argc, argv);
-}
\ No newline at end of file
+}
+#endif
@@ -45,9 +45,9 @@ public:
     oneapi::mkl::transpose TransA = oneapi::mkl::transpose::nontrans;
     oneapi::mkl::transpose TransB = oneapi::mkl::transpose::nontrans;
 
-    auto *A = cl::sycl::malloc_shared<T>(AX * AY, DeviceQueue);
-    auto *B = cl::sycl::malloc_shared<T>(AY * BY, DeviceQueue);
-    auto *C = cl::sycl::malloc_shared<T>(AX * BY, DeviceQueue);
+    auto *A = sycltesters::pool_malloc_shared<T>(AX * AY, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_shared<T>(AY * BY, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_shared<T>(AX * BY, DeviceQueue);
     std::copy(Aptr, Aptr + AX * AY, A);
 #if !defined(MKLTRANS)
     std::copy(Bptr, Bptr + AY * BY, B);
@@ -68,9 +68,9 @@ public:
 
     // copy back
     std::copy(C, C + AX * BY, Cptr);
-    cl::sycl::free(A, DeviceQueue);
-    cl::sycl::free(B, DeviceQueue);
-    cl::sycl::free(C, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
     return ProfInfo;
   }
 };
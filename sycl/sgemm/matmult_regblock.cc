@@ -0,0 +1,193 @@
+//------------------------------------------------------------------------------
+//
+// Matrix multiplication with local memory and register blocking
+// (SYCL vs serial CPU)
+//
+// Each work-item accumulates TR x TC micro-tile of C in registers, so work
+// group of LSZ x LSZ items makes (LSZ * TR) x (LSZ * TC) tile of C. Inner
+// loop loads TR values of A and TC values of B from local memory for
+// TR * TC multiply-adds (matmult_local does two loads per multiply-add).
+// Rows and columns of micro-tile are strided by LSZ, so neighbour items
+// access neighbour columns in local memory and in C.
+//
+// Any matrix sizes: edge groups and last tile along AY are bounds checked,
+// interior groups take unchecked path
+//
+// Tiles in local memory keep input type, micro-tile accumulates in AccT
+// (see GEMM_PREC in sgemm_testers.hpp)
+//
+// Tile sizes are template parameters: 4x4 by default, other with
+// -DTILE_R=<r> -DTILE_C=<c> (see matmult_regblock_8x4 target)
+//
+// try: matmult_regblock.exe -lsz=16
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+#include "sgemm_testers.hpp"
+
+#ifndef TILE_R
+#define TILE_R 4
+#endif
+
+#ifndef TILE_C
+#define TILE_C 4
+#endif
+
+// class is used for kernel name
+template <typename T, typename AccT, int TR, int TC> class mmult_regblock_buf;
+
+using ConfigTy = sycltesters::sgemm::Config;
+
+template <typename T, int TR, int TC, typename AccT = T>
+class MatrixMultRegBlock : public sycltesters::MatrixMult<T, AccT> {
+  using sycltesters::MatrixMult<T, AccT>::Queue;
+  ConfigTy Cfg_;
+
+public:
+  static constexpr bool any_size = true; // see sgemm::tune_space
+  // TR * Lsz rows of A and TC * Lsz columns of B
+  static size_t local_bytes(size_t Lsz) {
+    return (TR + TC) * Lsz * Lsz * sizeof(T);
+  }
+  MatrixMultRegBlock(sycl::queue &DeviceQueue, ConfigTy Cfg)
+      : sycltesters::MatrixMult<T, AccT>(DeviceQueue), Cfg_(Cfg) {}
+
+  sycltesters::EvtRet_t operator()(const T *Aptr, const T *Bptr, AccT *Cptr,
+                                   size_t AX, size_t AY, size_t BY) override {
+    assert(Aptr != nullptr && Bptr != nullptr && Cptr != nullptr);
+    const int LSZ = Cfg_.Lsz; // avoid implicit capture of this
+    // full tiles along AY and width of last partial one
+    const int NumTiles = AY / LSZ;
+    const int Rem = AY % LSZ;
+    const int AXI = AX, BYI = BY;
+    sycltesters::EvtVec_t ProfInfo;
+    sycl::range<2> Asz{AX, AY}, Bsz{AY, BY}, Csz{AX, BY};
+    sycl::buffer<T, 2> BufA(Aptr, Asz), BufB(Bptr, Bsz);
+    sycl::buffer<AccT, 2> BufC(Cptr, Csz);
+    BufA.set_final_data(nullptr);
+    BufB.set_final_data(nullptr);
+
+    auto &DeviceQueue = Queue();
+
+    // one work-item per micro-tile, C is rounded up to group tiles
+    sycl::range<2> BlockSize{LSZ, LSZ};
+    sycl::range<2> Items{simplemath::roundup<size_t>(AX, LSZ * TR) / TR,
+                         simplemath::roundup<size_t>(BY, LSZ * TC) / TC};
+    sycl::nd_range<2> Range{Items, BlockSize};
+
+    auto Evt = DeviceQueue.submit([&](sycl::handler &Cgh) {
+      auto A = BufA.template get_access<sycl_read>(Cgh);
+      auto B = BufB.template get_access<sycl_read>(Cgh);
+      auto C = BufC.template get_access<sycl_write>(Cgh);
+
+      // local memory: TR * LSZ rows of A and TC * LSZ columns of B
+      using LTy = sycl::accessor<T, 2, sycl_read_write, sycl_local>;
+      LTy Asub{sycl::range<2>{LSZ * TR, LSZ}, Cgh};
+      LTy Bsub{sycl::range<2>{LSZ, LSZ * TC}, Cgh};
+
+      auto KernMul = [=](sycl::nd_item<2> It) {
+        const int Row = It.get_local_id(0);
+        const int Col = It.get_local_id(1);
+        const int GroupRow = It.get_group(0) * LSZ * TR;
+        const int GroupCol = It.get_group(1) * LSZ * TC;
+
+        // same for whole group, so no divergence inside group
+        const bool Interior =
+            GroupRow + LSZ * TR <= AXI && GroupCol + LSZ * TC <= BYI;
+
+        AccT Acc[TR][TC] = {};
+        AccT ARegs[TR], BRegs[TC];
+
+        // Width columns of A tile and rows of B tile starting at K0
+        auto LoadTiles = [&](int K0, int Width, bool Checked) {
+#pragma unroll
+          for (int R = 0; R < TR; R++) {
+            const int ARow = GroupRow + Row + R * LSZ;
+            Asub[Row + R * LSZ][Col] =
+                !Checked || (ARow < AXI && Col < Width) ? A[ARow][K0 + Col]
+                                                        : T(0);
+          }
+#pragma unroll
+          for (int Cl = 0; Cl < TC; Cl++) {
+            const int BCol = GroupCol + Col + Cl * LSZ;
+            Bsub[Row][Col + Cl * LSZ] =
+                !Checked || (BCol < BYI && Row < Width) ? B[K0 + Row][BCol]
+                                                        : T(0);
+          }
+        };
+
+        auto MulTiles = [&](int Width) {
+          for (int K = 0; K < Width; K++) {
+#pragma unroll
+            for (int R = 0; R < TR; R++)
+              ARegs[R] = AccT(Asub[Row + R * LSZ][K]);
+#pragma unroll
+            for (int Cl = 0; Cl < TC; Cl++)
+              BRegs[Cl] = AccT(Bsub[K][Col + Cl * LSZ]);
+#pragma unroll
+            for (int R = 0; R < TR; R++)
+#pragma unroll
+              for (int Cl = 0; Cl < TC; Cl++)
+                Acc[R][Cl] += ARegs[R] * BRegs[Cl];
+          }
+        };
+
+        for (int Tile = 0; Tile < NumTiles; Tile++) {
+          LoadTiles(LSZ * Tile, LSZ, !Interior);
+          // waiting for all threads to fill Asub and Bsub
+          It.barrier(sycl_local_fence);
+          MulTiles(LSZ);
+          // waiting for all threads to use Asub and Bsub
+          It.barrier(sycl_local_fence);
+        }
+
+        // last partial tile along AY
+        if (Rem > 0) {
+          LoadTiles(LSZ * NumTiles, Rem, true);
+          It.barrier(sycl_local_fence);
+          MulTiles(Rem);
+        }
+
+#pragma unroll
+        for (int R = 0; R < TR; R++)
+#pragma unroll
+          for (int Cl = 0; Cl < TC; Cl++) {
+            const int CRow = GroupRow + Row + R * LSZ;
+            const int CCol = GroupCol + Col + Cl * LSZ;
+            if (Interior || (CRow < AXI && CCol < BYI))
+              C[CRow][CCol] = Acc[R][Cl];
+          }
+      };
+
+      Cgh.parallel_for<class mmult_regblock_buf<T, AccT, TR, TC>>(Range,
+                                                                  KernMul);
+    });
+
+    ProfInfo.emplace_back(Evt, "Main execution");
+    DeviceQueue.wait(); // or explicit host accessor to BufC
+    return ProfInfo;
+  }
+};
+
+REGISTER_VARIANT(sgemm, "matmult_regblock", MatrixMultRegBlock<float, 4, 4>);
+REGISTER_VARIANT(sgemm, "matmult_regblock_8x4",
+                 MatrixMultRegBlock<float, 8, 4>);
+
+#ifndef SYCL_BENCH
+int main(int argc, char **argv) {
+  using namespace sycltesters::sgemm;
+  sycltesters::test_sequence<
+      MatrixMultRegBlock<InTy, TILE_R, TILE_C, AccTy>>(argc, argv);
+}
+#endif
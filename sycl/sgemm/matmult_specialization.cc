@@ -46,12 +46,9 @@ public:
 
     auto &DeviceQueue = Queue();
 
-    sycl::kernel_id KId = sycl::get_kernel_id<mmult_specialized_buf<T>>();
-    sycl::kernel_bundle KbSrc =
-        sycl::get_kernel_bundle<sycl::bundle_state::input>(
-            DeviceQueue.get_context(), {KId});
-    KbSrc.template set_specialization_constant<AYC>(AY);
-    sycl::kernel_bundle Kb = sycl::build(KbSrc);
+    // built once per AY, then taken from cache
+    auto Kb = sycltesters::build_cached<mmult_specialized_buf<T>, AYC>(
+        DeviceQueue, AY);
 
     auto Evt = DeviceQueue.submit([&](sycl::handler &Cgh) {
       auto A = BufA.template get_access<sycl_read>(Cgh);
@@ -80,6 +77,10 @@ public:
   }
 };
 
+REGISTER_VARIANT(sgemm, "matmult_specialization", MatrixMultSpecBuf<float>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<MatrixMultSpecBuf<float>>(argc, argv);
-}
\ No newline at end of file
+}
+#endif
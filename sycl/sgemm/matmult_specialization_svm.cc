@@ -21,7 +21,7 @@
 #include "sgemm_testers.hpp"
 
 // class is used for kernel name
-template <typename T> class mmult_shared_transposed;
+template <typename T> class mmult_spec_shared_transposed;
 
 constexpr sycl::specialization_id<int> AYC;
 constexpr sycl::specialization_id<int> BYC;
@@ -29,12 +29,12 @@ constexpr sycl::specialization_id<int> BYC;
 using ConfigTy = sycltesters::sgemm::Config;
 
 template <typename T>
-class MatrixMultSharedTransposed : public sycltesters::MatrixMult<T> {
+class MatrixMultSpecSharedTransposed : public sycltesters::MatrixMult<T> {
   using sycltesters::MatrixMult<T>::Queue;
   ConfigTy Cfg_;
 
 public:
-  MatrixMultSharedTransposed(sycl::queue &DeviceQueue, ConfigTy Cfg)
+  MatrixMultSpecSharedTransposed(sycl::queue &DeviceQueue, ConfigTy Cfg)
       : sycltesters::MatrixMult<T>(DeviceQueue), Cfg_(Cfg) {}
 
   sycltesters::EvtRet_t operator()(const T *Aptr, const T *Bptr, T *Cptr,
@@ -45,19 +45,16 @@ public:
 
     auto &DeviceQueue = Queue();
 
-    auto *A = cl::sycl::malloc_shared<T>(AX * AY, DeviceQueue);
-    auto *B = cl::sycl::malloc_shared<T>(AY * BY, DeviceQueue);
-    auto *C = cl::sycl::malloc_shared<T>(AX * BY, DeviceQueue);
+    auto *A = sycltesters::pool_malloc_shared<T>(AX * AY, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_shared<T>(AY * BY, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_shared<T>(AX * BY, DeviceQueue);
     std::copy(Aptr, Aptr + AX * AY, A);
     std::copy(Bptr, Bptr + AY * BY, B);
 
-    sycl::kernel_id KId = sycl::get_kernel_id<mmult_shared_transposed<T>>();
-    sycl::kernel_bundle KbSrc =
-        sycl::get_kernel_bundle<sycl::bundle_state::input>(
-            DeviceQueue.get_context(), {KId});
-    KbSrc.template set_specialization_constant<AYC>(AY);
-    KbSrc.template set_specialization_constant<BYC>(BY);
-    sycl::kernel_bundle Kb = sycl::build(KbSrc);
+    // built once per AY, BY, then taken from cache
+    auto Kb =
+        sycltesters::build_cached<mmult_spec_shared_transposed<T>, AYC, BYC>(
+            DeviceQueue, AY, BY);
 
     auto Evt = DeviceQueue.submit([&](sycl::handler &Cgh) {
       Cgh.use_kernel_bundle(Kb);
@@ -74,20 +71,25 @@ public:
         C[Row * BYK + Col] = Sum;
       };
 
-      Cgh.parallel_for<class mmult_shared_transposed<T>>(Csz, Kernmul);
+      Cgh.parallel_for<class mmult_spec_shared_transposed<T>>(Csz, Kernmul);
     });
 
     ProfInfo.push_back(Evt);
     DeviceQueue.wait();
     std::copy(C, C + AX * BY, Cptr);
-    cl::sycl::free(A, DeviceQueue);
-    cl::sycl::free(B, DeviceQueue);
-    cl::sycl::free(C, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
 
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(sgemm, "matmult_specialization_svm",
+                 MatrixMultSpecSharedTransposed<float>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
-  sycltesters::test_sequence<MatrixMultSharedTransposed<float>>(argc, argv);
-}
\ No newline at end of file
+  sycltesters::test_sequence<MatrixMultSpecSharedTransposed<float>>(argc, argv);
+}
+#endif
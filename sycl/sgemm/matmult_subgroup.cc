@@ -0,0 +1,226 @@
+//------------------------------------------------------------------------------
+//
+// Matrix multiplication with sub-group broadcasts (SYCL vs serial CPU)
+// No local memory and no barriers
+//
+// Every sub-group of SG lanes makes TR rows x SG columns of C, lane per
+// column. Along AY it goes by SG x SG tiles of B: each lane keeps its column
+// of tile in registers, then for every row lane L loads A[Row][K0 + L] and
+// sycl::group_broadcast hands these values to all lanes in turn (as in
+// hist_private_sg). Work-group is Lsz sub-groups stacked along rows.
+//
+// Kernel needs exact sub-group size (reqd_sub_group_size): SG_SIZE if device
+// supports it, else other supported of 8, 16, 32. Without any of them plain
+// kernel runs, where every item reads A itself.
+//
+// Any matrix sizes: out of range values are zero, stores are checked
+//
+// try: matmult_subgroup.exe -lsz=4
+//      matmult_subgroup.exe -bsz=1 -ax=100 -ay=77 -by=153
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+#include "sgemm_testers.hpp"
+
+#ifndef SG_SIZE
+#define SG_SIZE 16
+#endif
+static_assert(SG_SIZE == 8 || SG_SIZE == 16 || SG_SIZE == 32,
+              "Kernels are compiled for sub-groups of 8, 16 and 32");
+
+#ifndef TILE_R
+#define TILE_R 4
+#endif
+
+// class is used for kernel name, SG == 0 for kernel without sub-groups
+template <typename T, typename AccT, int SG, int TR> class mmult_subgroup;
+
+using ConfigTy = sycltesters::sgemm::Config;
+
+template <typename T, int TR, typename AccT = T>
+class MatrixMultSubgroup : public sycltesters::MatrixMult<T, AccT> {
+  using sycltesters::MatrixMult<T, AccT>::Queue;
+  ConfigTy Cfg_;
+  int SG_; // sub-group size of kernel, 0 for fallback
+
+  // preferred size, then larger first, 0 if device has none of compiled
+  static int select_sub_group(const sycl::device &D) {
+    auto Sizes = D.get_info<sycl::info::device::sub_group_sizes>();
+    auto Has = [&Sizes](size_t S) {
+      return std::find(Sizes.begin(), Sizes.end(), S) != Sizes.end();
+    };
+    for (int S : {SG_SIZE, 32, 16, 8})
+      if (Has(S))
+        return S;
+    return 0;
+  }
+
+  template <int SG>
+  sycl::event submit_subgroup(const T *A, const T *B, AccT *C, size_t AX,
+                              size_t AY, size_t BY,
+                              const std::vector<sycl::event> &Deps) {
+    const int LSZ = Cfg_.Lsz; // avoid implicit capture of this
+    const int AXI = AX, AYI = AY, BYI = BY;
+    // local width is exactly one sub-group, so lane is local id 1
+    sycl::range<2> BlockSize{LSZ, SG};
+    sycl::range<2> Grid{simplemath::roundup<size_t>((AX + TR - 1) / TR, LSZ),
+                        simplemath::roundup<size_t>(BY, SG)};
+    sycl::nd_range<2> Range{Grid, BlockSize};
+
+    return Queue().submit([&](sycl::handler &Cgh) {
+      Cgh.depends_on(Deps);
+      auto KernMul =
+          [=](sycl::nd_item<2> It) [[sycl::reqd_sub_group_size(SG)]] {
+            const auto SubGroup = It.get_sub_group();
+            const int Lane = SubGroup.get_local_id()[0];
+            const int Row0 = It.get_global_id(0) * TR;
+            const int Col = It.get_global_id(1);
+            const bool ColIn = Col < BYI;
+
+            AccT Acc[TR] = {};
+            AccT BRegs[SG];
+            for (int K0 = 0; K0 < AYI; K0 += SG) {
+              // column Col of SG x SG tile of B
+#pragma unroll
+              for (int K = 0; K < SG; K++)
+                BRegs[K] = (ColIn && K0 + K < AYI)
+                               ? AccT(B[(K0 + K) * BYI + Col])
+                               : AccT(0);
+#pragma unroll
+              for (int R = 0; R < TR; R++) {
+                const int Row = Row0 + R;
+                // all lanes take part in broadcast, even out of range ones
+                const AccT AVal = (Row < AXI && K0 + Lane < AYI)
+                                      ? AccT(A[Row * AYI + K0 + Lane])
+                                      : AccT(0);
+#pragma unroll
+                for (int K = 0; K < SG; K++) {
+                  const AccT AK = sycl::group_broadcast(SubGroup, AVal, K);
+                  Acc[R] += AK * BRegs[K];
+                }
+              }
+            }
+
+#pragma unroll
+            for (int R = 0; R < TR; R++)
+              if (Row0 + R < AXI && ColIn)
+                C[(Row0 + R) * BYI + Col] = Acc[R];
+          };
+
+      Cgh.parallel_for<class mmult_subgroup<T, AccT, SG, TR>>(Range, KernMul);
+    });
+  }
+
+  // same rows x column per item, but A comes from global memory
+  sycl::event submit_plain(const T *A, const T *B, AccT *C, size_t AX,
+                           size_t AY, size_t BY,
+                           const std::vector<sycl::event> &Deps) {
+    const int LSZ = Cfg_.Lsz;
+    const int AXI = AX, AYI = AY, BYI = BY;
+    sycl::range<2> BlockSize{LSZ, LSZ};
+    sycl::range<2> Grid{simplemath::roundup<size_t>((AX + TR - 1) / TR, LSZ),
+                        simplemath::roundup<size_t>(BY, LSZ)};
+    sycl::nd_range<2> Range{Grid, BlockSize};
+
+    return Queue().submit([&](sycl::handler &Cgh) {
+      Cgh.depends_on(Deps);
+      auto KernMul = [=](sycl::nd_item<2> It) {
+        const int Row0 = It.get_global_id(0) * TR;
+        const int Col = It.get_global_id(1);
+        if (Col >= BYI)
+          return;
+        AccT Acc[TR] = {};
+        for (int K = 0; K < AYI; K++) {
+          const AccT BVal = AccT(B[K * BYI + Col]);
+#pragma unroll
+          for (int R = 0; R < TR; R++)
+            if (Row0 + R < AXI)
+              Acc[R] += AccT(A[(Row0 + R) * AYI + K]) * BVal;
+        }
+#pragma unroll
+        for (int R = 0; R < TR; R++)
+          if (Row0 + R < AXI)
+            C[(Row0 + R) * BYI + Col] = Acc[R];
+      };
+
+      Cgh.parallel_for<class mmult_subgroup<T, AccT, 0, TR>>(Range, KernMul);
+    });
+  }
+
+public:
+  static constexpr bool any_size = true; // see sgemm::tune_space
+  static size_t local_bytes(size_t) { return 0; } // registers only
+  MatrixMultSubgroup(sycl::queue &DeviceQueue, ConfigTy Cfg)
+      : sycltesters::MatrixMult<T, AccT>(DeviceQueue), Cfg_(Cfg),
+        SG_(select_sub_group(DeviceQueue.get_device())) {
+    if (SG_ != SG_SIZE)
+      sycltesters::qout << "Sub-group size " << SG_SIZE
+                        << " not supported, using "
+                        << (SG_ ? std::to_string(SG_) : "no sub-groups")
+                        << std::endl;
+  }
+
+  sycltesters::EvtRet_t operator()(const T *Aptr, const T *Bptr, AccT *Cptr,
+                                   size_t AX, size_t AY, size_t BY) override {
+    assert(Aptr != nullptr && Bptr != nullptr && Cptr != nullptr);
+    sycltesters::EvtVec_t ProfInfo;
+    auto &DeviceQueue = Queue();
+
+    auto *A = sycltesters::pool_malloc_device<T>(AX * AY, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_device<T>(AY * BY, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_device<AccT>(AX * BY, DeviceQueue);
+    // events are wrapped right after submit: host stamp is taken there
+    auto EvtCpyA = DeviceQueue.copy(Aptr, A, AX * AY);
+    ProfInfo.emplace_back(EvtCpyA, "Copy A");
+    auto EvtCpyB = DeviceQueue.copy(Bptr, B, AY * BY);
+    ProfInfo.emplace_back(EvtCpyB, "Copy B");
+    std::vector<sycl::event> Copies{EvtCpyA, EvtCpyB};
+
+    sycl::event Evt;
+    switch (SG_) {
+    case 8:
+      Evt = submit_subgroup<8>(A, B, C, AX, AY, BY, Copies);
+      break;
+    case 16:
+      Evt = submit_subgroup<16>(A, B, C, AX, AY, BY, Copies);
+      break;
+    case 32:
+      Evt = submit_subgroup<32>(A, B, C, AX, AY, BY, Copies);
+      break;
+    default:
+      Evt = submit_plain(A, B, C, AX, AY, BY, Copies);
+    }
+    ProfInfo.emplace_back(Evt, "Main execution");
+    auto EvtCpyC = DeviceQueue.copy(C, Cptr, AX * BY, Evt);
+    ProfInfo.emplace_back(EvtCpyC, "Copy C back");
+    EvtCpyC.wait();
+
+    // reverse order: pool is LIFO, next call gets same blocks
+    sycltesters::pool_free(C, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    return ProfInfo;
+  }
+};
+
+REGISTER_VARIANT(sgemm, "matmult_subgroup", MatrixMultSubgroup<float, 4>);
+
+#ifndef SYCL_BENCH
+int main(int argc, char **argv) {
+  using namespace sycltesters::sgemm;
+  sycltesters::test_sequence<MatrixMultSubgroup<InTy, TILE_R, AccTy>>(argc,
+                                                                      argv);
+}
+#endif
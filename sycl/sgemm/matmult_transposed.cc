@@ -39,9 +39,9 @@ public:
 
     auto &DeviceQueue = Queue();
 
-    auto *A = sycl::malloc_shared<T>(AX * AY, DeviceQueue);
-    auto *B = sycl::malloc_shared<T>(AY * BY, DeviceQueue);
-    auto *C = sycl::malloc_shared<T>(AX * BY, DeviceQueue);
+    auto *A = sycltesters::pool_malloc_shared<T>(AX * AY, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_shared<T>(AY * BY, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_shared<T>(AX * BY, DeviceQueue);
     std::copy(Aptr, Aptr + AX * AY, A);
     // transpose matrix B
     for (int i = 0; i < AY; ++i)
@@ -66,13 +66,18 @@ public:
     ProfInfo.push_back(Evt);
     DeviceQueue.wait();
     std::copy(C, C + AX * BY, Cptr);
-    sycl::free(A, DeviceQueue);
-    sycl::free(B, DeviceQueue);
-    sycl::free(C, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(sgemm, "matmult_transposed",
+                 MatrixMultSharedTransposed<float>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<MatrixMultSharedTransposed<float>>(argc, argv);
-}
\ No newline at end of file
+}
+#endif
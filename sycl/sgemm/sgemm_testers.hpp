@@ -7,12 +7,26 @@
 //  * inherited from testers.hpp: RUNHOST, INORD...
 //  -DMEASURE_NORMAL : measure with normal host code
 //  -DMULT_INEFF : in host code, not transpose matrix first for cache effects
+//  -DGEMM_PREC=<p> : input/accumulator types of tiled variants
+//                    0: float/float (default), 1: half/float,
+//                    2: bfloat16/float, 3: int8/int32
 //
 // Options to control things:
-// -ax=<n>, -ay=<m>, -by=<k> : matrix sizes
+// -ax=<n>, -ay=<m>, -by=<k> : matrix sizes (in -bsz units, -bsz=1 for any
+//                              sizes; matmult_local, matmult_local_shared
+//                              and matmult_regblock take them unpadded)
 // -lsz=<l> : amount of local address space
+// -adata=<file>, -bdata=<file> : binary float matrices (see dataset.hpp)
+//                                of AX x AY and AY x BY, override sizes
 // -vis : visualize matrices (use wisely) available only in measure_normal
 // -quiet : quiet mode (say for gnuplot stuff), output only GPU time or errors
+// -reps=<n>, -warmup=<w> : measured and warmup runs (see testers.hpp)
+// -tune : tune lsz for device, tuned lsz is default afterwards (tuner.hpp)
+// -batch=<n> : number of products for batched variants (see matmult_batched)
+// -batchptr : batched variants take pointer arrays instead of strides
+// -pad=<n> : strided batched form leaves n elements between matrices,
+//            tester checks that gaps of C are not written
+// numeric options may be lists or ranges: -ax=4..20:2 -lsz=8,16
 //
 //------------------------------------------------------------------------------
 //
@@ -23,14 +37,30 @@
 
 #pragma once
 
+#include <algorithm>
 #include <bit>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 #include <CL/sycl.hpp>
 
+#ifndef GEMM_PREC
+#define GEMM_PREC 0
+#endif
+
+#if GEMM_PREC == 2
+#include <sycl/ext/oneapi/bfloat16.hpp>
+#endif
+
 // problems with boost in OneAPI console on Windows
 #ifdef USE_BOOST_OPTPARSE
 #include "optparse.hpp"
@@ -45,20 +75,75 @@ constexpr int DEF_AX = 5;
 constexpr int DEF_AY = 4;
 constexpr int DEF_BY = 3;
 constexpr int DEF_LSZ = 8;
+constexpr int DEF_BATCH = 1;
 
 namespace sycltesters {
 
 namespace sgemm {
+
+#if GEMM_PREC == 1
+using InTy = sycl::half;
+using AccTy = float;
+#elif GEMM_PREC == 2
+using InTy = sycl::ext::oneapi::bfloat16;
+using AccTy = float;
+#elif GEMM_PREC == 3
+using InTy = std::int8_t;
+using AccTy = std::int32_t;
+#else
+using InTy = float;
+using AccTy = float;
+#endif
+
+template <typename T> constexpr const char *type_name() {
+  if constexpr (std::is_same_v<T, float>)
+    return "float";
+  else if constexpr (std::is_same_v<T, sycl::half>)
+    return "half";
+#if GEMM_PREC == 2
+  else if constexpr (std::is_same_v<T, sycl::ext::oneapi::bfloat16>)
+    return "bf16";
+#endif
+  else if constexpr (std::is_same_v<T, std::int8_t>)
+    return "int8";
+  else if constexpr (std::is_same_v<T, std::int32_t>)
+    return "int32";
+  else
+    return "unknown";
+}
+
+// report family: Base for float, <Base>_<input>_<accumulator> otherwise,
+// so baselines of different precisions do not mix
+template <typename T, typename AccT>
+std::string family(std::string Base = "sgemm") {
+  if constexpr (std::is_same_v<T, float> && std::is_same_v<AccT, float>)
+    return Base;
+  else
+    return Base + "_" + type_name<T>() + "_" + type_name<AccT>();
+}
+
+// inputs are small integers, exact in every input type, and their products
+// are exact in accumulator, so host and device differ only in summation
+// order: integer accumulation is exact
+template <typename AccT> Tolerance tolerance() {
+  if constexpr (std::is_integral_v<AccT>)
+    return {};
+  else
+    return {0, 1e-5, 4};
+}
+
 struct Config {
   size_t Ax, Ay, By, Block;
   unsigned Lsz;
+  size_t Batch = DEF_BATCH; // batched variants only
+  bool BatchPtr = false;
+  size_t Pad = 0; // strided batched form only
   bool Vis = false, Quiet = false;
+  std::string AFile, BFile;
+  BenchConfig Bench;
 };
 
-inline Config read_config(int argc, char **argv) {
-  Config Cfg;
-
-  options::Parser OptParser;
+inline void add_options(options::Parser &OptParser) {
   OptParser.template add<int>(
       "ax", DEF_AX, "size X of matrix A in A * B in bsz-element blocks");
   OptParser.template add<int>(
@@ -66,18 +151,59 @@ inline Config read_config(int argc, char **argv) {
   OptParser.template add<int>(
       "by", DEF_BY, "size Y of matrix B in A * B in bsz-element blocks");
   OptParser.template add<int>("lsz", DEF_LSZ, "local size");
+  OptParser.template add<int>("batch", DEF_BATCH,
+                              "number of products for batched variants");
+  OptParser.template add<int>("batchptr", 0,
+                              "batched variants take pointer arrays");
+  OptParser.template add<int>("pad", 0,
+                              "gap between matrices of strided batch");
   OptParser.template add<int>("bsz", DEF_BLOCK,
                               "size of block (matrix size multiple)");
+  OptParser.template add<std::string>("adata", "",
+                                      "binary dataset to map as matrix A");
+  OptParser.template add<std::string>("bdata", "",
+                                      "binary dataset to map as matrix B");
   OptParser.template add<int>("vis", 0, "visualize matrices");
   OptParser.template add<int>("quiet", 0, "quiet mode for bulk runs");
-  OptParser.parse(argc, argv);
+  add_bench_options(OptParser);
+}
 
+// for currently selected sweep point
+inline Config read_config(const options::Parser &OptParser,
+                          std::string Program) {
+  Config Cfg;
   Cfg.Block = OptParser.template get<int>("bsz");
   Cfg.Ax = OptParser.template get<int>("ax") * Cfg.Block;
   Cfg.Ay = OptParser.template get<int>("ay") * Cfg.Block;
   Cfg.By = OptParser.template get<int>("by") * Cfg.Block;
   Cfg.Lsz = OptParser.template get<int>("lsz");
+  int Batch = OptParser.template get<int>("batch");
+  if (Batch < 1)
+    throw std::runtime_error("Expect batch >= 1");
+  Cfg.Batch = Batch;
+  Cfg.BatchPtr = OptParser.exists("batchptr");
+  int Pad = OptParser.template get<int>("pad");
+  if (Pad < 0)
+    throw std::runtime_error("Expect pad >= 0");
+  if (Pad > 0 && Cfg.BatchPtr)
+    throw std::runtime_error("Pad applies to strided batch only");
+  Cfg.Pad = Pad;
+  Cfg.AFile = OptParser.template get<std::string>("adata");
+  Cfg.BFile = OptParser.template get<std::string>("bdata");
+  if (!Cfg.AFile.empty() || !Cfg.BFile.empty()) {
+    if (Cfg.AFile.empty() || Cfg.BFile.empty())
+      throw std::runtime_error("Expect both -adata and -bdata");
+    auto AHdr = read_dataset_header(Cfg.AFile);
+    auto BHdr = read_dataset_header(Cfg.BFile);
+    if (AHdr.Rank != 2 || BHdr.Rank != 2 || AHdr.Shape[1] != BHdr.Shape[0])
+      throw std::runtime_error("Expect matrices of AX x AY and AY x BY");
+    Cfg.Ax = AHdr.Shape[0];
+    Cfg.Ay = AHdr.Shape[1];
+    Cfg.By = BHdr.Shape[1];
+  }
   Cfg.Vis = OptParser.exists("vis");
+  Cfg.Bench = read_bench_options(OptParser, Program);
+  Cfg.Bench.Given = given_options(OptParser, {"lsz"});
 
   if (OptParser.exists("quiet")) {
     Cfg.Quiet = true;
@@ -95,37 +221,145 @@ inline void dump_config_info(Config &Cfg) {
        << std::endl;
   qout << "Block size: " << Cfg.Block << std::endl;
   qout << "Local size: " << Cfg.Lsz << std::endl;
+  if (Cfg.Batch > 1)
+    qout << "Batch: " << Cfg.Batch << (Cfg.BatchPtr ? " (pointer array)" : "")
+         << std::endl;
+  if (Cfg.Pad > 0)
+    qout << "Padding between matrices: " << Cfg.Pad << std::endl;
+  if (!Cfg.AFile.empty())
+    qout << "Datasets: " << Cfg.AFile << ", " << Cfg.BFile << std::endl;
+}
+
+inline void record_config(const Config &Cfg, ResultRecord &Rec) {
+  Rec.add("config", "ax", Cfg.Ax);
+  Rec.add("config", "ay", Cfg.Ay);
+  Rec.add("config", "by", Cfg.By);
+  Rec.add("config", "block", Cfg.Block);
+  Rec.add("config", "lsz", Cfg.Lsz);
+  Rec.add("config", "adata", Cfg.AFile);
+  Rec.add("config", "bdata", Cfg.BFile);
+  if (Cfg.Batch > 1) {
+    Rec.add("config", "batch", Cfg.Batch);
+    Rec.add("config", "batchptr", Cfg.BatchPtr);
+    Rec.add("config", "pad", Cfg.Pad);
+  }
+}
+
+// 2 * AX * AY * BY flops, A and B read and C written once
+template <typename T, typename AccT = T>
+WorkCount work_count(const Config &Cfg) {
+  double Ax = Cfg.Ax, Ay = Cfg.Ay, By = Cfg.By;
+  double In = Ax * Ay + Ay * By, Out = Ax * By;
+  return {2.0 * Ax * Ay * By, In * sizeof(T) + Out * sizeof(AccT)};
+}
+
+// inputs and C of tester, host reference has C and returns its copy
+template <typename T, typename AccT = T>
+Footprint footprint(const Config &Cfg) {
+  double A = double(Cfg.Ax) * Cfg.Ay * sizeof(T);
+  double B = double(Cfg.Ay) * Cfg.By * sizeof(T);
+  double C = double(Cfg.Ax) * Cfg.By * sizeof(AccT);
+  return {A + B + C * (1 + 2 * HOST_REF_COPIES), A + B + C,
+          std::max({A, B, C})};
+}
+
+// batched variants: Batch products, all matrices of batch stored together
+template <typename T, typename AccT = T>
+WorkCount batch_work_count(const Config &Cfg) {
+  auto W = work_count<T, AccT>(Cfg);
+  return {W.Flops * Cfg.Batch, W.Bytes * Cfg.Batch};
+}
+
+template <typename T, typename AccT = T>
+Footprint batch_footprint(const Config &Cfg) {
+  auto Fp = footprint<T, AccT>(Cfg);
+  return {Fp.Host * Cfg.Batch, Fp.Device * Cfg.Batch,
+          Fp.MaxAlloc * Cfg.Batch};
+}
+
+// variants which bounds check edges declare
+//   static constexpr bool any_size = true;
+// others need matrix sizes to be multiples of Lsz
+template <typename MMChildT, typename = void>
+struct is_any_size : std::false_type {};
+template <typename MMChildT>
+struct is_any_size<MMChildT, std::enable_if_t<MMChildT::any_size>>
+    : std::true_type {};
+
+// variants with other local memory than two Lsz x Lsz tiles of inputs
+// declare
+//   static size_t local_bytes(size_t Lsz);
+template <typename MMChildT, typename = void>
+struct has_local_bytes : std::false_type {};
+template <typename MMChildT>
+struct has_local_bytes<
+    MMChildT, std::void_t<decltype(MMChildT::local_bytes(size_t{}))>>
+    : std::true_type {};
+
+// what tune_space needs to know about variant
+struct VariantTraits {
+  bool AnySize = false;
+  std::function<size_t(size_t)> LocalBytes; // per work-group for Lsz
+};
+
+template <typename MMChildT> VariantTraits variant_traits() {
+  using T = typename MMChildT::type;
+  VariantTraits Traits;
+  Traits.AnySize = is_any_size<MMChildT>::value;
+  if constexpr (has_local_bytes<MMChildT>::value)
+    Traits.LocalBytes = [](size_t L) { return MMChildT::local_bytes(L); };
+  else
+    Traits.LocalBytes = [](size_t L) { return 2 * L * L * sizeof(T); };
+  return Traits;
+}
+
+// Lsz x Lsz work-groups over C, local memory as variant says; sizes are
+// multiples of bsz, not of every candidate, so divisibility is checked
+// unless variant takes any sizes
+inline TuneSpace tune_space(sycl::device D, Config &Cfg,
+                            const VariantTraits &Traits) {
+  auto Lim = device_limits(D);
+  auto Legal = [Lim, &Cfg, Traits] {
+    size_t L = Cfg.Lsz;
+    return L * L <= Lim.MaxWG && Traits.LocalBytes(L) <= Lim.LocalMem &&
+           (Traits.AnySize ||
+            (Cfg.Ax % L == 0 && Cfg.Ay % L == 0 && Cfg.By % L == 0));
+  };
+  return {{tune_param("lsz", Cfg.Lsz, pow2_candidates(1, 64))}, Legal};
 }
 
 } // namespace sgemm
 
-template <typename T> class MatrixMult {
+// C may have wider accumulator type than inputs, i.e. half inputs, float C
+template <typename T, typename AccT = T> class MatrixMult {
   cl::sycl::queue DeviceQueue_;
 
 public:
   using type = T;
+  using acc_type = AccT;
   MatrixMult(cl::sycl::queue &DeviceQueue) : DeviceQueue_(DeviceQueue) {}
-  virtual EvtRet_t operator()(const T *A, const T *B, T *C, size_t AX,
+  virtual EvtRet_t operator()(const T *A, const T *B, AccT *C, size_t AX,
                               size_t AY, size_t BY) = 0;
   cl::sycl::queue &Queue() { return DeviceQueue_; }
   const cl::sycl::queue &Queue() const { return DeviceQueue_; }
   virtual ~MatrixMult() {}
 };
 
-template <typename T> struct MatrixMultHost : public MatrixMult<T> {
-  void mmult_normal(const T *A, const T *B, T *C, size_t AX, size_t AY,
+template <typename T, typename AccT = T>
+struct MatrixMultHost : public MatrixMult<T, AccT> {
+  void mmult_normal(const T *A, const T *B, AccT *C, size_t AX, size_t AY,
                     size_t BY) {
     int i, j, k;
     for (i = 0; i < AX; i++) {
       for (j = 0; j < BY; j++) {
-        T acc = 0;
+        AccT acc = 0;
         for (k = 0; k < AY; k++)
-          acc += A[i * AY + k] * B[k * BY + j];
+          acc += AccT(A[i * AY + k]) * AccT(B[k * BY + j]);
         C[i * BY + j] = acc;
       }
     }
   }
-  void mmult_transpose(const T *A, const T *B, T *C, size_t AX, size_t AY,
+  void mmult_transpose(const T *A, const T *B, AccT *C, size_t AX, size_t AY,
                        size_t BY) {
     std::vector<T> tmp(BY * AY);
     for (int i = 0; i < AY; i++)
@@ -134,16 +368,17 @@ template <typename T> struct MatrixMultHost : public MatrixMult<T> {
 
     for (int i = 0; i < AX; i++)
       for (int j = 0; j < BY; j++) {
-        T acc = 0;
+        AccT acc = 0;
         for (int k = 0; k < AY; k++)
-          acc += A[i * AY + k] * tmp[j * AY + k];
+          acc += AccT(A[i * AY + k]) * AccT(tmp[j * AY + k]);
         C[i * BY + j] = acc;
       }
   }
 
 public:
-  MatrixMultHost(cl::sycl::queue &DeviceQueue) : MatrixMult<T>(DeviceQueue) {}
-  EvtRet_t operator()(const T *A, const T *B, T *C, size_t AX, size_t AY,
+  MatrixMultHost(cl::sycl::queue &DeviceQueue)
+      : MatrixMult<T, AccT>(DeviceQueue) {}
+  EvtRet_t operator()(const T *A, const T *B, AccT *C, size_t AX, size_t AY,
                       size_t BY) override {
 #if !defined(MULT_INEFF)
     mmult_transpose(A, B, C, AX, AY, BY);
@@ -154,26 +389,33 @@ public:
   }
 };
 
-// we want only floats -10 .. 10
-constexpr int MINF = -10;
-constexpr int MAXF = 10;
+// random inputs are integers -10 .. 10 by default: exact in half and
+// bfloat16 (8 significant bits) and products are exact in float
+// accumulator; int8 takes almost whole range, for int32 accumulator this
+// overflows only for AY over 130000
+template <typename T> struct InputRange {
+  static constexpr int Min = -10, Max = 10;
+};
+template <> struct InputRange<std::int8_t> {
+  static constexpr int Min = -127, Max = 127;
+};
 
-template <typename T> class MatrixMultTester {
-  MatrixMult<T> &Multiply_;
+template <typename T, typename AccT = T> class MatrixMultTester {
+  MatrixMult<T, AccT> &Multiply_;
   Timer Timer_;
   size_t AX_, AY_, BY_;
   const T *A_;
   const T *B_;
-  std::vector<T> C_;
+  std::vector<AccT> C_;
 
 public:
-  MatrixMultTester(MatrixMult<T> &Multiply, const T *A, const T *B, size_t AX,
-                   size_t AY, size_t BY)
+  MatrixMultTester(MatrixMult<T, AccT> &Multiply, const T *A, const T *B,
+                   size_t AX, size_t AY, size_t BY)
       : Multiply_(Multiply), AX_(AX), AY_(AY), BY_(BY), A_(A), B_(B),
         C_(AX * BY) {}
 
-  std::pair<unsigned, unsigned> calculate() {
-    unsigned EvtTiming = 0;
+  Timing_t calculate() {
+    nsec_t EvtTiming = 0;
     Timer_.start();
     EvtRet_t Ret = Multiply_(A_, B_, C_.data(), AX_, AY_, BY_);
     EvtTiming += getTime(Ret);
@@ -183,7 +425,117 @@ public:
 
   const T *getA() const { return A_; }
   const T *getB() const { return B_; }
-  T *getref() { return C_.data(); }
+  AccT *getref() { return C_.data(); }
+};
+
+// Batch products of same sizes in one call
+// strided form: matrix I of A is at A + I * StrideA, same for B and C
+// pointer-array form: matrix I of A is at A[I], same for B and C
+// C may have wider accumulator type than inputs, as for MatrixMult
+template <typename T, typename AccT = T> class BatchedMatrixMult {
+  cl::sycl::queue DeviceQueue_;
+
+public:
+  using type = T;
+  using acc_type = AccT;
+  BatchedMatrixMult(cl::sycl::queue &DeviceQueue)
+      : DeviceQueue_(DeviceQueue) {}
+  virtual EvtRet_t operator()(const T *A, size_t StrideA, const T *B,
+                              size_t StrideB, AccT *C, size_t StrideC,
+                              size_t AX, size_t AY, size_t BY,
+                              size_t Batch) = 0;
+  virtual EvtRet_t operator()(const T *const *A, const T *const *B,
+                              AccT *const *C, size_t AX, size_t AY, size_t BY,
+                              size_t Batch) = 0;
+  cl::sycl::queue &Queue() { return DeviceQueue_; }
+  const cl::sycl::queue &Queue() const { return DeviceQueue_; }
+  virtual ~BatchedMatrixMult() {}
+};
+
+// A and B hold Batch matrices back to back; strided form with Cfg.Pad
+// gets copies with Pad elements after every matrix, gaps of C are filled
+// with marker and checked after every call
+template <typename T, typename AccT = T> class BatchedMatrixMultTester {
+  BatchedMatrixMult<T, AccT> &Multiply_;
+  Timer Timer_;
+  size_t AX_, AY_, BY_, Batch_, Pad_;
+  bool PtrArray_;
+  const T *A_;
+  const T *B_;
+  std::vector<AccT> C_;
+  std::vector<T> APadded_, BPadded_;
+  std::vector<AccT> CPadded_;
+  std::vector<const T *> APtrs_, BPtrs_;
+  std::vector<AccT *> CPtrs_;
+
+  static constexpr int GapMarker = 77;
+
+  // padded copy of Batch matrices of Sz elements
+  template <typename U>
+  std::vector<U> padded(const U *Src, size_t Sz, U Fill) const {
+    std::vector<U> Dst(Batch_ * (Sz + Pad_), Fill);
+    for (size_t I = 0; I < Batch_; ++I)
+      std::copy(Src + I * Sz, Src + (I + 1) * Sz,
+                Dst.begin() + I * (Sz + Pad_));
+    return Dst;
+  }
+
+  // result to packed C_, gaps shall keep marker
+  void unpad_result() {
+    const size_t SzC = AX_ * BY_;
+    for (size_t I = 0; I < Batch_; ++I) {
+      auto Slice = CPadded_.begin() + I * (SzC + Pad_);
+      std::copy(Slice, Slice + SzC, C_.begin() + I * SzC);
+      if (std::any_of(Slice + SzC, Slice + SzC + Pad_,
+                      [](AccT V) { return V != AccT(GapMarker); }))
+        throw std::runtime_error("Strided batch wrote to gap after C " +
+                                 std::to_string(I));
+    }
+  }
+
+public:
+  BatchedMatrixMultTester(BatchedMatrixMult<T, AccT> &Multiply, const T *A,
+                          const T *B, const sgemm::Config &Cfg)
+      : Multiply_(Multiply), AX_(Cfg.Ax), AY_(Cfg.Ay), BY_(Cfg.By),
+        Batch_(Cfg.Batch), Pad_(Cfg.Pad),
+        PtrArray_(Cfg.BatchPtr), A_(A), B_(B),
+        C_(Cfg.Ax * Cfg.By * Cfg.Batch) {
+    if (Pad_ > 0) {
+      APadded_ = padded(A_, AX_ * AY_, T(0));
+      BPadded_ = padded(B_, AY_ * BY_, T(0));
+      CPadded_ = padded(C_.data(), AX_ * BY_, AccT(GapMarker));
+    }
+    if (!PtrArray_)
+      return;
+    for (size_t I = 0; I < Batch_; ++I) {
+      APtrs_.push_back(A_ + I * AX_ * AY_);
+      BPtrs_.push_back(B_ + I * AY_ * BY_);
+      CPtrs_.push_back(C_.data() + I * AX_ * BY_);
+    }
+  }
+
+  Timing_t calculate() {
+    nsec_t EvtTiming = 0;
+    EvtRet_t Ret;
+    Timer_.start();
+    if (PtrArray_)
+      Ret = Multiply_(APtrs_.data(), BPtrs_.data(), CPtrs_.data(), AX_, AY_,
+                      BY_, Batch_);
+    else if (Pad_ > 0)
+      Ret = Multiply_(APadded_.data(), AX_ * AY_ + Pad_, BPadded_.data(),
+                      AY_ * BY_ + Pad_, CPadded_.data(), AX_ * BY_ + Pad_,
+                      AX_, AY_, BY_, Batch_);
+    else
+      Ret = Multiply_(A_, AX_ * AY_, B_, AY_ * BY_, C_.data(), AX_ * BY_, AX_,
+                      AY_, BY_, Batch_);
+    EvtTiming += getTime(Ret);
+    Timer_.stop();
+    if (Pad_ > 0)
+      unpad_result();
+    return {Timer_.elapsed(), EvtTiming};
+  }
+
+  AccT *getref() { return C_.data(); }
 };
 
 template <typename T>
@@ -191,85 +543,357 @@ void dump_matrix(std::ostream &Os, std::string Name, T *M, int X, int Y) {
   Os << Name << ":\n";
   for (int I = 0; I < X; ++I) {
     for (int J = 0; J < Y; ++J)
-      Os << M[I * Y + J] << " ";
+      Os << static_cast<double>(M[I * Y + J]) << " "; // int8 as number
     Os << "\n";
   }
 }
 
 template <typename T>
 void rand_initialize(T *Arr, size_t Sz, int min, int max) {
-  Dice DZERO(0, 100);
-  Dice D(min, max);
   // most zeroes for floating point to reduce probability of overflow
-  for (int I = 0; I < Sz; ++I)
-    Arr[I] = (DZERO() < 50) ? D() : 0;
+  parallel_generate(Arr, Arr + Sz, [min, max](const RandBlock &R) {
+    return (uniform_int(R[0], 0, 100) < 50)
+               ? T(static_cast<float>(uniform_int(R[1], min, max)))
+               : T(0.0f);
+  });
+}
+
+// mapped dataset or random matrix of Sz elements
+template <typename Ty>
+InputArray<Ty> sgemm_input(const std::string &FileName, size_t Sz) {
+  if (!FileName.empty()) {
+    if constexpr (std::is_same_v<Ty, float>) {
+      qout << "Mapping dataset: " << FileName << std::endl;
+      return InputArray<Ty>{FileName};
+    } else {
+      throw std::runtime_error("Datasets hold float matrices only");
+    }
+  }
+  std::vector<Ty> M(Sz);
+  rand_initialize(M.data(), M.size(), InputRange<Ty>::Min,
+                  InputRange<Ty>::Max);
+  return InputArray<Ty>{std::move(M)};
+}
+
+// host reference result, empty unless MEASURE_NORMAL
+template <typename Ty, typename AccTy = Ty>
+std::vector<AccTy> sgemm_reference(sycl::queue &Q, const sgemm::Config &Cfg,
+                                   const Ty *A, const Ty *B) {
+#ifdef MEASURE_NORMAL
+  qout << "Calculating host" << std::endl;
+  MatrixMultHost<Ty, AccTy> MMultH{Q}; // Q unused for this derived class
+  MatrixMultTester<Ty, AccTy> TesterH{MMultH, A, B, Cfg.Ax, Cfg.Ay, Cfg.By};
+  measure_host(Cfg.Bench, [&] { return TesterH.calculate(); });
+  return {TesterH.getref(), TesterH.getref() + Cfg.Ax * Cfg.By};
+#else
+  return {};
+#endif
+}
+
+// measure one variant on given matrices, HostC is host result or nullptr
+template <typename Ty, typename AccTy = Ty>
+BenchResult bench_sgemm_variant(sycl::queue &Q, const sgemm::Config &Cfg,
+                                MatrixMult<Ty, AccTy> &MMult, const Ty *A,
+                                const Ty *B, const AccTy *HostC) {
+  MatrixMultTester<Ty, AccTy> Tester{MMult, A, B, Cfg.Ax, Cfg.Ay, Cfg.By};
+  const auto Family = sgemm::family<Ty, AccTy>();
+
+  qout << "Calculating gpu" << std::endl;
+  auto Bench = run_bench(Cfg.Bench, [&] { return Tester.calculate(); });
+  attach_work(Q, Cfg.Bench, Bench, sgemm::work_count<Ty, AccTy>(Cfg));
+
+  qout << "Measured time: " << SecFmt{Bench.WallStats.Median} << std::endl;
+  qout << "Pure execution time: " << SecFmt{Bench.EvtStats.Median}
+       << std::endl;
+  dump_bench(qout, Bench);
+  report_result(Family, Cfg, Q.get_device(), Bench);
+
+  if (HostC == nullptr)
+    return Bench;
+
+  AccTy *GPUData = Tester.getref();
+
+  if (Cfg.Vis) {
+    dump_matrix(qout, "A", Tester.getA(), Cfg.Ax, Cfg.Ay);
+    dump_matrix(qout, "B", Tester.getB(), Cfg.Ay, Cfg.By);
+    dump_matrix(qout, "Host result", HostC, Cfg.Ax, Cfg.By);
+    dump_matrix(qout, "GPU result", GPUData, Cfg.Ax, Cfg.By);
+  }
+
+#if defined(VERIFY)
+  // verification with host result, summation order differs from host
+  check_result(Family, HostC, GPUData, size_t(Cfg.Ax) * Cfg.By, Cfg.Bench,
+               sgemm::tolerance<AccTy>());
+#endif // VERIFY
+  return Bench;
+}
+
+// Make(Cfg) creates variant for current sizes of Cfg, Traits are its
+// sgemm::variant_traits
+template <typename Ty, typename AccTy = Ty, typename MakeF>
+void tune_sgemm_variant(sycl::queue &Q, sgemm::Config &Cfg, MakeF Make,
+                        const Ty *A, const Ty *B,
+                        const sgemm::VariantTraits &Traits) {
+  auto Space = sgemm::tune_space(Q.get_device(), Cfg, Traits);
+  tune_config(Q, Cfg.Bench, Space, [&] {
+    auto MMult = Make(Cfg);
+    MatrixMultTester<Ty, AccTy> Tester{*MMult, A, B, Cfg.Ax, Cfg.Ay, Cfg.By};
+    return Tester.calculate();
+  });
+  // given or default lsz is not checked by tuning: clear error, not failed
+  // launch
+  auto Need = Traits.LocalBytes(Cfg.Lsz);
+  auto Have = device_limits(Q.get_device()).LocalMem;
+  if (Need > Have)
+    throw std::runtime_error("Local size " + std::to_string(Cfg.Lsz) +
+                             " needs " + std::to_string(Need) +
+                             " bytes of local memory, device has " +
+                             std::to_string(Have));
+}
+
+template <typename MMChildT>
+void single_sgemm_sequence(sycl::queue &Q, sgemm::Config Cfg) {
+  using Ty = typename MMChildT::type;
+  using AccTy = typename MMChildT::acc_type;
+  if constexpr (!std::is_same_v<Ty, AccTy>)
+    qout << "Precision: " << sgemm::type_name<Ty>() << " inputs, "
+         << sgemm::type_name<AccTy>() << " accumulator" << std::endl;
+  if constexpr (std::is_same_v<Ty, sycl::half>)
+    if (!Q.get_device().has(sycl::aspect::fp16)) {
+      qout << "Device has no fp16 support, skipped" << std::endl;
+      return;
+    }
+  preflight(Q.get_device(), sgemm::footprint<Ty, AccTy>(Cfg));
+  qout << "Initializing" << std::endl;
+  auto A = sgemm_input<Ty>(Cfg.AFile, Cfg.Ax * Cfg.Ay);
+  auto B = sgemm_input<Ty>(Cfg.BFile, Cfg.Ay * Cfg.By);
+  tune_sgemm_variant<Ty, AccTy>(
+      Q, Cfg,
+      [&Q](const sgemm::Config &C) { return std::make_unique<MMChildT>(Q, C); },
+      A.data(), B.data(), sgemm::variant_traits<MMChildT>());
+  auto HostC = sgemm_reference<Ty, AccTy>(Q, Cfg, A.data(), B.data());
+
+  MMChildT MMult{Q, Cfg};
+  auto Bench = bench_sgemm_variant<Ty, AccTy>(
+      Q, Cfg, MMult, A.data(), B.data(),
+      HostC.empty() ? nullptr : HostC.data());
+
+  // only things that shall occur on console in quiet mode: Ax and time
+  // we may run this in the loop
+  if (Cfg.Quiet) {
+    qout.set(!Cfg.Quiet);
+    qout << Cfg.Ax << " " << SecFmt{Bench.EvtStats.Median} << std::endl;
+    qout.set(Cfg.Quiet);
+  }
 }
 
 template <typename MMChildT> void test_sequence(int argc, char **argv) {
   try {
-    auto Cfg = sgemm::read_config(argc, argv);
+    options::Parser OptParser;
+    sgemm::add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return sgemm::read_config(Parser, argv[0]);
+    });
     qout << "Welcome to matrix multiplication" << std::endl;
-    sgemm::dump_config_info(Cfg);
 
     auto Q = set_queue();
     print_info(qout, Q.get_device());
 
-    qout << "Initializing" << std::endl;
-    using Ty = typename MMChildT::type;
-    std::vector<Ty> A(Cfg.Ax * Cfg.Ay), B(Cfg.Ay * Cfg.By);
-    rand_initialize(A.data(), A.size(), MINF, MAXF);
-    rand_initialize(B.data(), B.size(), MINF, MAXF);
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      dump_sweep_point(I, Cfgs.size());
+      sgemm::dump_config_info(Cfgs[I]);
+      reseed(Cfgs[I].Bench);
+      single_sgemm_sequence<MMChildT>(Q, Cfgs[I]);
+    }
+  } catch (cl::sycl::exception const &err) {
+    std::cerr << "SYCL ERROR: " << err.what() << "\n";
+    abort();
+  } catch (std::exception const &err) {
+    std::cerr << "Exception: " << err.what() << "\n";
+    abort();
+  } catch (...) {
+    std::cerr << "Unknown error\n";
+    abort();
+  }
+  qout << "Everything is correct" << std::endl;
+}
 
+// host reference of batch, product by product, empty unless MEASURE_NORMAL
+template <typename Ty, typename AccTy = Ty>
+std::vector<AccTy> batched_reference(sycl::queue &Q, const sgemm::Config &Cfg,
+                                     const Ty *A, const Ty *B) {
 #ifdef MEASURE_NORMAL
-    qout << "Calculating host" << std::endl;
-    MatrixMultHost<Ty> MMultH{Q}; // Q unused for this derived class
-    MatrixMultTester<Ty> TesterH{MMultH, A.data(), B.data(),
-                                 Cfg.Ax, Cfg.Ay,   Cfg.By};
-    auto ElapsedH = TesterH.calculate();
-    qout << "Measured host time: " << ElapsedH.first / msec_per_sec << "\n";
+  qout << "Calculating host" << std::endl;
+  MatrixMultHost<Ty, AccTy> MMultH{Q}; // Q unused for this derived class
+  const size_t SzA = Cfg.Ax * Cfg.Ay, SzB = Cfg.Ay * Cfg.By;
+  const size_t SzC = Cfg.Ax * Cfg.By;
+  std::vector<AccTy> C(SzC * Cfg.Batch);
+  measure_host(Cfg.Bench, [&] {
+    Timer Tm;
+    Tm.start();
+    for (size_t I = 0; I < Cfg.Batch; ++I)
+      MMultH(A + I * SzA, B + I * SzB, C.data() + I * SzC, Cfg.Ax, Cfg.Ay,
+             Cfg.By);
+    Tm.stop();
+    return Timing_t{Tm.elapsed(), 0};
+  });
+  return C;
+#else
+  return {};
 #endif
+}
 
-    MMChildT MMult{Q, Cfg};
+template <typename MMChildT>
+void single_batched_sequence(sycl::queue &Q, const sgemm::Config &Cfg) {
+  using Ty = typename MMChildT::type;
+  using AccTy = typename MMChildT::acc_type;
+  if (!Cfg.AFile.empty())
+    throw std::runtime_error("Batched variants take random matrices only");
+  if constexpr (!std::is_same_v<Ty, AccTy>)
+    qout << "Precision: " << sgemm::type_name<Ty>() << " inputs, "
+         << sgemm::type_name<AccTy>() << " accumulator" << std::endl;
+  if constexpr (std::is_same_v<Ty, sycl::half>)
+    if (!Q.get_device().has(sycl::aspect::fp16)) {
+      qout << "Device has no fp16 support, skipped" << std::endl;
+      return;
+    }
+  preflight(Q.get_device(), sgemm::batch_footprint<Ty, AccTy>(Cfg));
+  qout << "Initializing" << std::endl;
+  auto A = sgemm_input<Ty>("", Cfg.Ax * Cfg.Ay * Cfg.Batch);
+  auto B = sgemm_input<Ty>("", Cfg.Ay * Cfg.By * Cfg.Batch);
+  auto HostC = batched_reference<Ty, AccTy>(Q, Cfg, A.data(), B.data());
+  const auto Family = sgemm::family<Ty, AccTy>("sgemm_batched");
+
+  MMChildT MMult{Q, Cfg};
+  BatchedMatrixMultTester<Ty, AccTy> Tester{MMult, A.data(), B.data(), Cfg};
+  qout << "Calculating gpu" << std::endl;
+  auto Bench = run_bench(Cfg.Bench, [&] { return Tester.calculate(); });
+  attach_work(Q, Cfg.Bench, Bench,
+              sgemm::batch_work_count<Ty, AccTy>(Cfg));
+
+  // aggregate over all products of batch, kernel time without copies
+  auto Sec = run_seconds(Bench);
+  qout << "Measured time: " << SecFmt{Bench.WallStats.Median} << std::endl;
+  qout << "Pure execution time: " << SecFmt{Bench.EvtStats.Median}
+       << std::endl;
+  if (Sec > 0)
+    qout << "Aggregate: " << Bench.Work.Flops / Sec / 1e9 << " GFLOP/s, "
+         << Cfg.Batch / Sec << " products/s" << std::endl;
+  dump_bench(qout, Bench);
+  report_result(Family, Cfg, Q.get_device(), Bench);
+
+  if (Cfg.Quiet) {
+    qout.set(!Cfg.Quiet);
+    qout << Cfg.Batch << " " << Cfg.Ax << " " << SecFmt{Bench.EvtStats.Median}
+         << std::endl;
+    qout.set(Cfg.Quiet);
+  }
 
-    MatrixMultTester<Ty> Tester{MMult,  A.data(), B.data(),
-                                Cfg.Ax, Cfg.Ay,   Cfg.By};
+#if defined(VERIFY)
+  if (!HostC.empty())
+    check_result(Family, HostC.data(), Tester.getref(), HostC.size(),
+                 Cfg.Bench, sgemm::tolerance<AccTy>());
+#endif
+}
 
-    qout << "Calculating gpu" << std::endl;
-    auto Elapsed = Tester.calculate();
-    auto ExecTime = Elapsed.second / nsec_per_sec;
+template <typename MMChildT>
+void batched_test_sequence(int argc, char **argv) {
+  try {
+    options::Parser OptParser;
+    sgemm::add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return sgemm::read_config(Parser, argv[0]);
+    });
+    qout << "Welcome to batched matrix multiplication" << std::endl;
 
-    qout << "Measured time: " << Elapsed.first / msec_per_sec << std::endl;
-    qout << "Pure execution time: " << ExecTime << std::endl;
+    auto Q = set_queue();
+    print_info(qout, Q.get_device());
 
-    // only things that shall occur on console in quiet mode: Ax and time
-    // we may run this in the loop
-    if (Cfg.Quiet) {
-      qout.set(!Cfg.Quiet);
-      qout << Cfg.Ax << " " << ExecTime << std::endl;
-      qout.set(Cfg.Quiet);
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      dump_sweep_point(I, Cfgs.size());
+      sgemm::dump_config_info(Cfgs[I]);
+      reseed(Cfgs[I].Bench);
+      single_batched_sequence<MMChildT>(Q, Cfgs[I]);
     }
+  } catch (cl::sycl::exception const &err) {
+    std::cerr << "SYCL ERROR: " << err.what() << "\n";
+    abort();
+  } catch (std::exception const &err) {
+    std::cerr << "Exception: " << err.what() << "\n";
+    abort();
+  } catch (...) {
+    std::cerr << "Unknown error\n";
+    abort();
+  }
+  qout << "Everything is correct" << std::endl;
+}
 
-#if defined(MEASURE_NORMAL) || defined(VERIFY)
-    Ty *HostData = TesterH.getref();
-    Ty *GPUData = Tester.getref();
+namespace sgemm {
 
-    if (Cfg.Vis) {
-      dump_matrix(qout, "A", Tester.getA(), Cfg.Ax, Cfg.Ay);
-      dump_matrix(qout, "B", Tester.getB(), Cfg.Ay, Cfg.By);
-      dump_matrix(qout, "Host result", HostData, Cfg.Ax, Cfg.By);
-      dump_matrix(qout, "GPU result", GPUData, Cfg.Ax, Cfg.By);
-    }
+template <typename T> using Registry = VariantRegistry<MatrixMult<T>, Config>;
 
-#if defined(VERIFY)
-    // verification with host result
-    for (int I = 0; I < Cfg.Ax * Cfg.By; ++I)
-      if (HostData[I] != GPUData[I]) {
-        std::cerr << "Mismatch at: " << I << std::endl;
-        std::cerr << HostData[I] << " vs " << GPUData[I] << std::endl;
-        std::terminate();
+// traits of registered variants, tuning looks them up by name
+template <typename T>
+std::map<std::string, VariantTraits> &registered_traits() {
+  static std::map<std::string, VariantTraits> Traits;
+  return Traits;
+}
+
+// sycl_bench sequence: requested variants (all if empty) on same matrices
+template <typename Ty>
+void bench_sequence(int argc, char **argv,
+                    const std::vector<std::string> &Requested) {
+  try {
+    auto Names = Registry<Ty>::instance().select(Requested);
+    options::Parser OptParser;
+    add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return read_config(Parser, argv[0]);
+    });
+    qout << "Welcome to matrix multiplication" << std::endl;
+
+    auto Q = set_queue();
+    print_info(qout, Q.get_device());
+
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      auto &Cfg = Cfgs[I];
+      dump_sweep_point(I, Cfgs.size());
+      dump_config_info(Cfg);
+      preflight(Q.get_device(), footprint<Ty>(Cfg));
+      qout << "Initializing" << std::endl;
+      reseed(Cfg.Bench);
+      auto A = sgemm_input<Ty>(Cfg.AFile, Cfg.Ax * Cfg.Ay);
+      auto B = sgemm_input<Ty>(Cfg.BFile, Cfg.Ay * Cfg.By);
+      auto HostC = sgemm_reference(Q, Cfg, A.data(), B.data());
+
+      VariantResults Results;
+      for (auto &&Name : Names) {
+        qout << "Variant: " << Name << std::endl;
+        auto VCfg = Cfg;
+        VCfg.Bench.Program = Name;
+        tune_sgemm_variant<Ty>(
+            Q, VCfg,
+            [&](const Config &C) {
+              return Registry<Ty>::instance().create(Name, Q, C);
+            },
+            A.data(), B.data(), registered_traits<Ty>().at(Name));
+        auto MMult = Registry<Ty>::instance().create(Name, Q, VCfg);
+        auto Bench = bench_sgemm_variant<Ty>(
+            Q, VCfg, *MMult, A.data(), B.data(),
+            HostC.empty() ? nullptr : HostC.data());
+        if (Cfg.Quiet) {
+          qout.set(!Cfg.Quiet);
+          qout << Name << " " << Cfg.Ax << " " << SecFmt{Bench.EvtStats.Median}
+               << std::endl;
+          qout.set(Cfg.Quiet);
+        }
+        Results.emplace_back(Name, Bench);
       }
-#endif // VERIFY
-#endif // MEASURE_NORMAL || VERIFY
+      dump_comparison(qout, Results);
+    }
   } catch (cl::sycl::exception const &err) {
     std::cerr << "SYCL ERROR: " << err.what() << "\n";
     abort();
@@ -283,4 +907,18 @@ template <typename MMChildT> void test_sequence(int argc, char **argv) {
   qout << "Everything is correct" << std::endl;
 }
 
+// used through REGISTER_VARIANT(sgemm, "name", Class)
+template <typename MMChildT> bool register_variant(std::string Name) {
+  using Ty = typename MMChildT::type;
+  registered_traits<Ty>()[Name] = variant_traits<MMChildT>();
+  auto Variants = [] { return Registry<Ty>::instance().names(); };
+  FamilyRegistry::instance().add("sgemm", {bench_sequence<Ty>, Variants});
+  return Registry<Ty>::instance().add(
+      Name, [](sycl::queue &Q, const Config &Cfg) {
+        return std::make_unique<MMChildT>(Q, Cfg);
+      });
+}
+
+} // namespace sgemm
+
 } // namespace sycltesters
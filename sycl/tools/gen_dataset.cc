@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------------
+//
+// Generator of binary datasets (see framework/dataset.hpp)
+//
+// Data is generated chunk by chunk with counter-based generator (dice.hpp),
+// so file may be much bigger than memory and the same seed always gives
+// the same file regardless of chunk size and number of threads
+//
+// Options to control things:
+// -type=<int|float> : element type
+// -shape=<n> or <n>x<m> : vector or row-major matrix
+// -min=<a>, -max=<b> : values in [a, b]
+// -zero=<p> : percent of zeroes (say 50 as for sgemm random matrices)
+// -seed=<s> : generator seed, random if not given (recorded in header)
+// -out=<file> : output file
+// -quiet : no output except errors
+//
+// Try:
+// > gen_dataset -type=int -shape=16777216 -max=255 -seed=1 -out=hist.bin
+// > hist_local -data=hist.bin
+// > gen_dataset -type=float -shape=1024x512 -min=-10 -max=10 -zero=50
+//               -seed=1 -out=a.bin
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef USE_BOOST_OPTPARSE
+#include "optparse.hpp"
+#else
+#include "optparse_alt.hpp"
+#endif
+
+#include "dataset.hpp"
+#include "dice.hpp"
+#include "qstream.hpp"
+
+namespace {
+
+constexpr std::size_t CHUNK = 1 << 22; // elements generated at once
+
+struct GenConfig {
+  std::string Type, OutFile;
+  std::vector<std::uint64_t> Shape;
+  int Min, Max, Zero;
+  std::uint64_t Seed;
+};
+
+// "1024" or "1024x512"
+std::vector<std::uint64_t> parse_shape(const std::string &Shape) {
+  std::vector<std::uint64_t> Ret;
+  std::string::size_type Pos = 0;
+  while (Pos <= Shape.size()) {
+    auto X = Shape.find('x', Pos);
+    if (X == Shape.npos)
+      X = Shape.size();
+    Ret.push_back(std::stoull(Shape.substr(Pos, X - Pos)));
+    if (Ret.back() == 0)
+      throw std::runtime_error("Zero dimension in shape: " + Shape);
+    Pos = X + 1;
+  }
+  return Ret;
+}
+
+template <typename T> void generate(const GenConfig &Cfg) {
+  auto Hdr = sycltesters::make_dataset_header<T>(Cfg.Shape, Cfg.Seed);
+  std::ofstream Os{Cfg.OutFile, std::ios::binary};
+  if (!Os.is_open())
+    throw std::runtime_error("Can not create dataset: " + Cfg.OutFile);
+  Os.write(reinterpret_cast<const char *>(&Hdr), sizeof(Hdr));
+
+  auto Gen = [Min = Cfg.Min, Max = Cfg.Max,
+              Zero = Cfg.Zero](const sycltesters::RandBlock &R) {
+    if (sycltesters::uniform_int(R[1], 0, 99) < Zero)
+      return T(0);
+    return T(sycltesters::uniform_int(R[0], Min, Max));
+  };
+
+  const std::uint64_t Total = Hdr.elements();
+  std::vector<T> Buf(std::min<std::uint64_t>(Total, CHUNK));
+  for (std::uint64_t First = 0; First < Total; First += Buf.size()) {
+    std::size_t N = std::min<std::uint64_t>(Buf.size(), Total - First);
+    // stream 0 of given seed: file does not depend on chunking
+    sycltesters::parallel_generate_at(Buf.begin(), Buf.begin() + N, Gen,
+                                      Cfg.Seed, 0, First);
+    Os.write(reinterpret_cast<const char *>(Buf.data()), N * sizeof(T));
+  }
+  if (!Os)
+    throw std::runtime_error("Write failed: " + Cfg.OutFile);
+
+  sycltesters::qout << "Written " << Total << " elements of " << Cfg.Type
+                    << " to " << Cfg.OutFile << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  try {
+    options::Parser OptParser;
+    OptParser.template add<std::string>("type", "int", "int or float");
+    OptParser.template add<std::string>("shape", "1048576",
+                                        "<n> or <n>x<m> elements");
+    OptParser.template add<int>("min", 0, "minimal value");
+    OptParser.template add<int>("max", 255, "maximal value");
+    OptParser.template add<int>("zero", 0, "percent of zero elements");
+    OptParser.template add<std::string>("seed", "",
+                                        "generator seed (random if empty)");
+    OptParser.template add<std::string>("out", "dataset.bin", "output file");
+    OptParser.template add<int>("quiet", 0, "quiet mode for bulk runs");
+    OptParser.parse(argc, argv);
+
+    GenConfig Cfg;
+    Cfg.Type = OptParser.template get<std::string>("type");
+    Cfg.OutFile = OptParser.template get<std::string>("out");
+    Cfg.Shape = parse_shape(OptParser.template get<std::string>("shape"));
+    Cfg.Min = OptParser.template get<int>("min");
+    Cfg.Max = OptParser.template get<int>("max");
+    Cfg.Zero = OptParser.template get<int>("zero");
+    auto Seed = OptParser.template get<std::string>("seed");
+    Cfg.Seed = Seed.empty() ? sycltesters::get_seed() : std::stoull(Seed);
+    sycltesters::qout.set(OptParser.exists("quiet"));
+
+    if (Cfg.Min > Cfg.Max)
+      throw std::runtime_error("Expect min <= max");
+
+    sycltesters::qout << "Seed: " << Cfg.Seed << std::endl;
+    if (Cfg.Type == "int")
+      generate<int>(Cfg);
+    else if (Cfg.Type == "float")
+      generate<float>(Cfg);
+    else
+      throw std::runtime_error("Unknown type: " + Cfg.Type);
+  } catch (std::exception const &err) {
+    std::cerr << "Exception: " << err.what() << "\n";
+    return 1;
+  }
+}
@@ -6,6 +6,11 @@
 // Macros to control things:
 //  * inherited from testers.hpp: RUNHOST, MEASURE_NORMAL, INORD...
 //
+// Options to control things:
+// -nreps=<n> : number of C = A + B, A = B + C, B = C + A rounds in one run
+// -reps=<n>, -warmup=<w> : measured and warmup runs (see testers.hpp)
+// numeric options may be lists or ranges: -size=512..4096:512
+//
 //------------------------------------------------------------------------------
 //
 // This file is licensed after LGPL v3
@@ -18,6 +23,9 @@
 #include <cassert>
 #include <chrono>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 #include <CL/sycl.hpp>
@@ -44,11 +52,10 @@ constexpr int DEF_QUIET = 0;
 struct Config {
   bool Detailed, Quiet = false;
   int Bsz, Size, NReps;
+  BenchConfig Bench;
 };
 
-inline Config read_config(int argc, char **argv) {
-  Config Cfg;
-  options::Parser OptParser;
+inline void add_options(options::Parser &OptParser) {
   OptParser.template add<int>("bsz", BLOCK_SIZE, "size of block");
   OptParser.template add<int>("size", LIST_SIZE,
                               "size of vectors in bsz-units");
@@ -56,12 +63,19 @@ inline Config read_config(int argc, char **argv) {
                               "number of repetitions in tester loop");
   OptParser.template add<int>("detailed", DEF_DETAILED, "detailed event view");
   OptParser.template add<int>("quiet", DEF_QUIET, "quiet mode for bulk runs");
-  OptParser.parse(argc, argv);
+  add_bench_options(OptParser);
+}
+
+// for currently selected sweep point
+inline Config read_config(const options::Parser &OptParser,
+                          std::string Program) {
+  Config Cfg;
 
   Cfg.Bsz = OptParser.template get<int>("size");
   Cfg.Size = OptParser.template get<int>("size") * Cfg.Bsz;
   Cfg.NReps = OptParser.template get<int>("nreps");
   Cfg.Detailed = OptParser.exists("detailed");
+  Cfg.Bench = read_bench_options(OptParser, Program);
   if (OptParser.exists("quiet")) {
     Cfg.Quiet = true;
     qout.set(Cfg.Quiet);
@@ -74,6 +88,28 @@ inline void dump_config_info(Config &Cfg) {
   qout << "Using #of repetitions = " << Cfg.NReps << "\n";
 }
 
+inline void record_config(const Config &Cfg, ResultRecord &Rec) {
+  Rec.add("config", "size", Cfg.Size);
+  Rec.add("config", "nreps", Cfg.NReps);
+}
+
+// 3 * nreps additions of vectors: one add per element, two reads, one write
+template <typename T> WorkCount work_count(const Config &Cfg) {
+  double Elts = 3.0 * Cfg.NReps * Cfg.Size;
+  return {Elts, 3.0 * Elts * sizeof(T)};
+}
+
+// three vectors in tester, on device and in host reference
+// with -chunk device holds only streaming slots of two inputs
+template <typename T> Footprint footprint(const Config &Cfg) {
+  double Vec = double(Cfg.Size) * sizeof(T);
+  double Host = 3 * Vec * (1 + HOST_REF_COPIES);
+  if (Cfg.Bench.StreamChunk > 0)
+    return stream_footprint<T>(Host, Cfg.Bench.StreamChunk,
+                               Cfg.Bench.StreamBufs, 2, Cfg.Size);
+  return {Host, 3 * Vec, Vec};
+}
+
 } // namespace vadd
 
 template <typename T> class VectorAdd {
@@ -127,9 +163,9 @@ public:
   // C = A + B;
   // A = B + C;
   // B = C + A;
-  std::pair<unsigned, unsigned> calculate() {
+  Timing_t calculate() {
     // timer start
-    unsigned EvtTiming = 0;
+    nsec_t EvtTiming = 0;
     qout << "Nreps = " << Rep_ << "\n";
     Timer_.start();
     // loop
@@ -147,45 +183,148 @@ public:
   }
 };
 
+namespace vadd {
+
+// most variants are constructed from queue only, some take config
+template <typename VaddChildT>
+std::unique_ptr<VaddChildT> make_variant(sycl::queue &Q, const Config &Cfg) {
+  if constexpr (std::is_constructible_v<VaddChildT, sycl::queue &,
+                                        const Config &>)
+    return std::make_unique<VaddChildT>(Q, Cfg);
+  else
+    return std::make_unique<VaddChildT>(Q);
+}
+
+} // namespace vadd
+
+// host run for comparison, no-op unless MEASURE_NORMAL
+inline void vadd_reference(sycl::queue &Q, const vadd::Config &Cfg) {
+#ifdef MEASURE_NORMAL
+  VectorAddHost<int> VaddH{Q}; // Q unused for this derived class
+  VectorAddTester<int> TesterH{VaddH, Cfg.Size, Cfg.NReps};
+  TesterH.initialize();
+  measure_host(Cfg.Bench, [&] { return TesterH.calculate(); });
+#endif
+}
+
+// measure one variant, inputs are deterministic (see initialize)
+template <typename Ty>
+BenchResult bench_vadd_variant(sycl::queue &Q, const vadd::Config &Cfg,
+                               VectorAdd<Ty> &Vadd) {
+  VectorAddTester<Ty> Tester{Vadd, Cfg.Size, Cfg.NReps};
+
+  qout << "Initializing"
+       << "\n";
+  Tester.initialize();
+
+  qout << "Calculating"
+       << "\n";
+  // every run starts from the same vectors
+  auto Bench = run_bench(Cfg.Bench, [&] {
+    Tester.initialize();
+    return Tester.calculate();
+  });
+  attach_work(Q, Cfg.Bench, Bench, vadd::work_count<Ty>(Cfg));
+
+  qout << "Measured time: " << SecFmt{Bench.WallStats.Median} << "\n";
+  qout << "Pure execution time: " << SecFmt{Bench.EvtStats.Median} << "\n";
+  dump_bench(qout, Bench);
+  report_result("vadd", Cfg, Q.get_device(), Bench);
+  return Bench;
+}
+
+template <typename VaddChildT>
+void single_vadd_sequence(sycl::queue &Q, const vadd::Config &Cfg) {
+  preflight(Q.get_device(), vadd::footprint<typename VaddChildT::type>(Cfg));
+  vadd_reference(Q, Cfg);
+
+  auto Vadd = vadd::make_variant<VaddChildT>(Q, Cfg);
+  auto Bench = bench_vadd_variant<typename VaddChildT::type>(Q, Cfg, *Vadd);
+
+  // Quiet mode output: vector size, elapsed time
+  if (Cfg.Quiet) {
+    qout.set(!Cfg.Quiet);
+    qout << Cfg.Size << " " << SecFmt{Bench.EvtStats.Median} << "\n";
+    qout.set(Cfg.Quiet);
+  }
+}
+
 template <typename VaddChildT> void test_sequence(int argc, char **argv) {
   try {
-    auto Cfg = vadd::read_config(argc, argv);
+    options::Parser OptParser;
+    vadd::add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return vadd::read_config(Parser, argv[0]);
+    });
     qout << "Welcome to vector addition"
          << "\n";
-    dump_config_info(Cfg);
     auto Q = set_queue();
     print_info(qout, Q.get_device());
 
-#ifdef MEASURE_NORMAL
-    VectorAddHost<int> VaddH{Q}; // Q unused for this derived class
-    VectorAddTester<int> TesterH{VaddH, Cfg.Size, Cfg.NReps};
-    TesterH.initialize();
-    auto ElapsedH = TesterH.calculate();
-    qout << "Measured host time: " << ElapsedH.first << "\n";
-#endif
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      dump_sweep_point(I, Cfgs.size());
+      dump_config_info(Cfgs[I]);
+      single_vadd_sequence<VaddChildT>(Q, Cfgs[I]);
+    }
+  } catch (cl::sycl::exception const &err) {
+    std::cerr << "SYCL ERROR: " << err.what() << "\n";
+    abort();
+  } catch (std::exception const &err) {
+    std::cerr << "Exception: " << err.what() << "\n";
+    abort();
+  } catch (...) {
+    std::cerr << "Unknown error\n";
+    abort();
+  }
+  qout << "Everything is correct"
+       << "\n";
+}
 
-    VaddChildT Vadd{Q};
-    VectorAddTester<typename VaddChildT::type> Tester{Vadd, Cfg.Size,
-                                                      Cfg.NReps};
+namespace vadd {
 
-    qout << "Initializing"
-         << "\n";
-    Tester.initialize();
+template <typename T> using Registry = VariantRegistry<VectorAdd<T>, Config>;
 
-    qout << "Calculating"
+// sycl_bench sequence: requested variants (all if empty) on same vectors
+template <typename Ty>
+void bench_sequence(int argc, char **argv,
+                    const std::vector<std::string> &Requested) {
+  try {
+    auto Names = Registry<Ty>::instance().select(Requested);
+    options::Parser OptParser;
+    add_options(OptParser);
+    OptParser.parse(argc, argv);
+    auto Cfgs = sweep_configs(OptParser, [argv](auto &&Parser) {
+      return read_config(Parser, argv[0]);
+    });
+    qout << "Welcome to vector addition"
          << "\n";
-    auto Elapsed = Tester.calculate();
-
-    qout << "Measured time: " << Elapsed.first / 1000.0 << "\n";
+    auto Q = set_queue();
+    print_info(qout, Q.get_device());
 
-    auto ExecTime = Elapsed.second / nsec_per_sec;
-    qout << "Pure execution time: " << ExecTime << "\n";
+    for (size_t I = 0; I < Cfgs.size(); ++I) {
+      auto &Cfg = Cfgs[I];
+      dump_sweep_point(I, Cfgs.size());
+      dump_config_info(Cfg);
+      preflight(Q.get_device(), footprint<Ty>(Cfg));
+      vadd_reference(Q, Cfg);
 
-    // Quiet mode output: vector size, elapsed time
-    if (Cfg.Quiet) {
-      qout.set(!Cfg.Quiet);
-      qout << Cfg.Size << " " << ExecTime << "\n";
-      qout.set(Cfg.Quiet);
+      VariantResults Results;
+      for (auto &&Name : Names) {
+        qout << "Variant: " << Name << "\n";
+        auto VCfg = Cfg;
+        VCfg.Bench.Program = Name;
+        auto Vadd = Registry<Ty>::instance().create(Name, Q, VCfg);
+        auto Bench = bench_vadd_variant<Ty>(Q, VCfg, *Vadd);
+        if (Cfg.Quiet) {
+          qout.set(!Cfg.Quiet);
+          qout << Name << " " << Cfg.Size << " "
+               << SecFmt{Bench.EvtStats.Median} << "\n";
+          qout.set(Cfg.Quiet);
+        }
+        Results.emplace_back(Name, Bench);
+      }
+      dump_comparison(qout, Results);
     }
   } catch (cl::sycl::exception const &err) {
     std::cerr << "SYCL ERROR: " << err.what() << "\n";
@@ -201,4 +340,17 @@ template <typename VaddChildT> void test_sequence(int argc, char **argv) {
        << "\n";
 }
 
+// used through REGISTER_VARIANT(vadd, "name", Class)
+template <typename VaddChildT> bool register_variant(std::string Name) {
+  using Ty = typename VaddChildT::type;
+  auto Variants = [] { return Registry<Ty>::instance().names(); };
+  FamilyRegistry::instance().add("vadd", {bench_sequence<Ty>, Variants});
+  return Registry<Ty>::instance().add(
+      Name, [](sycl::queue &Q, const Config &Cfg) {
+        return make_variant<VaddChildT>(Q, Cfg);
+      });
+}
+
+} // namespace vadd
+
 } // namespace sycltesters
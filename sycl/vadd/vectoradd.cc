@@ -74,6 +74,10 @@ public:
   }
 };
 
+REGISTER_VARIANT(vadd, "vectoradd", VectorAddBuf<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<VectorAddBuf<int>>(argc, argv);
 }
+#endif
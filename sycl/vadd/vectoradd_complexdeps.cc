@@ -97,6 +97,10 @@ public:
   }
 };
 
+REGISTER_VARIANT(vadd, "vectoradd_complexdeps", VectorAddComplex<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<VectorAddComplex<int>>(argc, argv);
 }
+#endif
@@ -32,9 +32,9 @@ public:
                                    size_t Sz) override {
     sycltesters::EvtVec_t ProfInfo;
     auto &DeviceQueue = Queue();
-    int *A = cl::sycl::malloc_device<T>(Sz, DeviceQueue);
-    int *B = cl::sycl::malloc_device<T>(Sz, DeviceQueue);
-    int *C = cl::sycl::malloc_device<T>(Sz, DeviceQueue);
+    int *A = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
+    int *B = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
+    int *C = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
 
     // kernels to copy to device
     auto EvtA = DeviceQueue.submit(
@@ -76,13 +76,17 @@ public:
       }
 #endif
 
-    cl::sycl::free(A, DeviceQueue);
-    cl::sycl::free(B, DeviceQueue);
-    cl::sycl::free(C, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(vadd, "vectoradd_devicemem", VectorAddDevice<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<VectorAddDevice<int>>(argc, argv);
 }
+#endif
@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------
+//
+// Vector addition, SYCL way
+// Same three kernel dep graph as vectoradd_complexdeps, but with USM and
+// recorded once into task graph: every call only copies new inputs and
+// replays graph (see taskgraph.hpp)
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+#include <vector>
+
+#include "vadd_testers.hpp"
+
+// classes used for kernel names
+template <typename T> class vector_add_graph;
+template <typename T> class vector_add_graph_scaled23;
+template <typename T> class vector_add_graph_scaled57;
+
+template <typename T> class VectorAddGraph : public sycltesters::VectorAdd<T> {
+  using sycltesters::VectorAdd<T>::Queue;
+  sycltesters::TaskGraph Graph_;
+
+  void record(const T *A, const T *B, T *C, T *X, T *Y, size_t Sz) {
+    cl::sycl::range<1> numOfItems{Sz};
+    auto NodeX = Graph_.add("X = A + B", [=](cl::sycl::handler &cgh) {
+      cgh.parallel_for<class vector_add_graph<T>>(
+          numOfItems, [=](cl::sycl::id<1> wiID) { X[wiID] = A[wiID] + B[wiID]; });
+    });
+    auto NodeY = Graph_.add("Y = 2A + 3B", [=](cl::sycl::handler &cgh) {
+      cgh.parallel_for<class vector_add_graph_scaled23<T>>(
+          numOfItems,
+          [=](cl::sycl::id<1> wiID) { Y[wiID] = 2 * A[wiID] + 3 * B[wiID]; });
+    });
+    Graph_.add(
+        "C = 5X + 7Y",
+        [=](cl::sycl::handler &cgh) {
+          cgh.parallel_for<class vector_add_graph_scaled57<T>>(
+              numOfItems,
+              [=](cl::sycl::id<1> wiID) { C[wiID] = 5 * X[wiID] + 7 * Y[wiID]; });
+        },
+        {NodeX, NodeY});
+  }
+
+public:
+  VectorAddGraph(cl::sycl::queue &DeviceQueue)
+      : sycltesters::VectorAdd<T>(DeviceQueue) {}
+
+  sycltesters::EvtRet_t operator()(T const *AVec, T const *BVec, T *CVec,
+                                   size_t Sz) override {
+    sycltesters::EvtVec_t ProfInfo;
+    auto &DeviceQueue = Queue();
+    T *A = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
+    T *B = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
+    T *C = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
+    T *X = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
+    T *Y = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
+
+    // pool gives same blocks on next call, so graph is recorded once
+    if (Graph_.rebind(A, B, C, X, Y, Sz))
+      record(A, B, C, X, Y, Sz);
+
+    // new inputs
+    auto EvtA = DeviceQueue.copy(AVec, A, Sz);
+    ProfInfo.emplace_back(EvtA, "Copy A");
+    auto EvtB = DeviceQueue.copy(BVec, B, Sz);
+    ProfInfo.emplace_back(EvtB, "Copy B");
+
+    auto GraphInfo = Graph_.replay(DeviceQueue, {EvtA, EvtB});
+    ProfInfo.insert(ProfInfo.end(), GraphInfo.begin(), GraphInfo.end());
+
+    auto EvtD = DeviceQueue.submit([&](cl::sycl::handler &cgh) {
+      cgh.depends_on(GraphInfo.back().Evt_);
+      cgh.copy(C, CVec, Sz);
+    });
+    ProfInfo.emplace_back(EvtD, "Copy back");
+
+    // last wait inevitable
+    DeviceQueue.wait();
+
+// host-side test that one vadd iteration is correct
+#ifdef VERIFY
+    for (int i = 0; i < Sz; ++i)
+      if (CVec[i] != 19 * AVec[i] + 26 * BVec[i]) {
+        std::cerr << "At index: " << i << ". ";
+        std::cerr << CVec[i] << " != " << 19 * AVec[i] + 26 * BVec[i] << "\n";
+        abort();
+      }
+#endif
+
+    // reverse order: pool is LIFO, so next call gets same bindings
+    sycltesters::pool_free(Y, DeviceQueue);
+    sycltesters::pool_free(X, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    return ProfInfo;
+  }
+};
+
+REGISTER_VARIANT(vadd, "vectoradd_graph", VectorAddGraph<int>);
+
+#ifndef SYCL_BENCH
+int main(int argc, char **argv) {
+  sycltesters::test_sequence<VectorAddGraph<int>>(argc, argv);
+}
+#endif
@@ -33,17 +33,17 @@ public:
     auto &DeviceQueue = Queue();
 
 #ifdef HOST_ALLOC
-    int *A = cl::sycl::malloc_host<T>(Sz, DeviceQueue);
-    int *B = cl::sycl::malloc_host<T>(Sz, DeviceQueue);
-    int *C = cl::sycl::malloc_host<T>(Sz, DeviceQueue);
+    int *A = sycltesters::pool_malloc_host<T>(Sz, DeviceQueue);
+    int *B = sycltesters::pool_malloc_host<T>(Sz, DeviceQueue);
+    int *C = sycltesters::pool_malloc_host<T>(Sz, DeviceQueue);
 #else
-    int *A = cl::sycl::malloc_shared<T>(Sz, DeviceQueue);
-    int *B = cl::sycl::malloc_shared<T>(Sz, DeviceQueue);
-    int *C = cl::sycl::malloc_shared<T>(Sz, DeviceQueue);
+    int *A = sycltesters::pool_malloc_shared<T>(Sz, DeviceQueue);
+    int *B = sycltesters::pool_malloc_shared<T>(Sz, DeviceQueue);
+    int *C = sycltesters::pool_malloc_shared<T>(Sz, DeviceQueue);
 #endif
 
     // this multiplier is intended to break stateless-to-statefull
-    int *Mult = cl::sycl::malloc_shared<int>(1, DeviceQueue);
+    int *Mult = sycltesters::pool_malloc_shared<int>(1, DeviceQueue);
     *Mult = 1;
 
     std::copy(AVec, AVec + Sz, A);
@@ -69,9 +69,9 @@ public:
         abort();
       }
 #endif
-    cl::sycl::free(A, DeviceQueue);
-    cl::sycl::free(B, DeviceQueue);
-    cl::sycl::free(C, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
     return ProfInfo;
   }
 };
@@ -33,13 +33,13 @@ public:
     auto &DeviceQueue = Queue();
 
 #ifdef HOST_ALLOC
-    auto *A = cl::sycl::malloc_host<T>(Sz, DeviceQueue);
-    auto *B = cl::sycl::malloc_host<T>(Sz, DeviceQueue);
-    auto *C = cl::sycl::malloc_host<T>(Sz, DeviceQueue);
+    auto *A = sycltesters::pool_malloc_host<T>(Sz, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_host<T>(Sz, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_host<T>(Sz, DeviceQueue);
 #else
-    auto *A = cl::sycl::malloc_shared<T>(Sz, DeviceQueue);
-    auto *B = cl::sycl::malloc_shared<T>(Sz, DeviceQueue);
-    auto *C = cl::sycl::malloc_shared<T>(Sz, DeviceQueue);
+    auto *A = sycltesters::pool_malloc_shared<T>(Sz, DeviceQueue);
+    auto *B = sycltesters::pool_malloc_shared<T>(Sz, DeviceQueue);
+    auto *C = sycltesters::pool_malloc_shared<T>(Sz, DeviceQueue);
 #endif
 
     std::copy(AVec, AVec + Sz, A);
@@ -70,14 +70,18 @@ public:
 #endif
 
 #ifndef FORGET_FREE
-    cl::sycl::free(A, DeviceQueue);
-    cl::sycl::free(B, DeviceQueue);
-    cl::sycl::free(C, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
 #endif
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(vadd, "vectoradd_sharedmem", VectorAddShared<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
   sycltesters::test_sequence<VectorAddShared<int>>(argc, argv);
 }
+#endif
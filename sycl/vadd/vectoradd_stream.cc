@@ -0,0 +1,89 @@
+//------------------------------------------------------------------------------
+//
+// Vector addition, SYCL way, streamed through device in chunks.
+// Copies of next chunk overlap with addition of current one, so vectors
+// may be larger than device memory (see framework/streaming.hpp)
+//
+// > vadd\vectoradd_stream.exe -size=4096 -chunk=1048576 -nbuf=3
+//
+//------------------------------------------------------------------------------
+//
+// This file is licensed after LGPL v3
+// Look at: https://www.gnu.org/licenses/lgpl-3.0.en.html for details
+//
+//------------------------------------------------------------------------------
+
+#include <CL/sycl.hpp>
+
+#include <iostream>
+#include <vector>
+
+#include "vadd_testers.hpp"
+
+using ConfigTy = sycltesters::vadd::Config;
+
+// class is used for kernel name
+template <typename T> class vector_add_stream;
+
+template <typename T> class VectorAddStream : public sycltesters::VectorAdd<T> {
+  using sycltesters::VectorAdd<T>::Queue;
+  ConfigTy Cfg_;
+
+public:
+  VectorAddStream(cl::sycl::queue &DeviceQueue, const ConfigTy &Cfg)
+      : sycltesters::VectorAdd<T>(DeviceQueue), Cfg_(Cfg) {}
+
+  sycltesters::EvtRet_t operator()(T const *AVec, T const *BVec, T *CVec,
+                                   size_t Sz) override {
+    auto &DeviceQueue = Queue();
+    const auto &BCfg = Cfg_.Bench;
+    auto Chunk = sycltesters::stream_chunk<T>(DeviceQueue, BCfg.StreamChunk,
+                                              BCfg.StreamBufs, 2, Sz);
+    sycltesters::ChunkStream<T, 2> Stream{DeviceQueue, Chunk, BCfg.StreamBufs};
+
+    // sum goes in place of A slot and then to its slice of C
+    auto Compute = [&](const sycltesters::ChunkInfo &Ch, auto &Dev,
+                       auto &Copies) {
+      T *A = Dev[0];
+      T *B = Dev[1];
+      // events are wrapped right after submit: host stamp is taken there
+      sycltesters::EvtVec_t Evts;
+      auto EvtAdd = DeviceQueue.submit([&](cl::sycl::handler &cgh) {
+        cgh.depends_on(Copies);
+        cgh.parallel_for<class vector_add_stream<T>>(
+            cl::sycl::range<1>{Ch.Size},
+            [=](cl::sycl::id<1> wiID) { A[wiID] += B[wiID]; });
+      });
+      Evts.emplace_back(EvtAdd, "Chunk add");
+      auto EvtOut = DeviceQueue.submit([&](cl::sycl::handler &cgh) {
+        cgh.depends_on(EvtAdd);
+        cgh.memcpy(CVec + Ch.Offset, A, Ch.Size * sizeof(T));
+      });
+      Evts.emplace_back(EvtOut, "Copy chunk back");
+      return Evts;
+    };
+
+    // output slices are already in place
+    auto ProfInfo = Stream.run({AVec, BVec}, Sz, Compute,
+                               [](const sycltesters::ChunkInfo &) {});
+
+// host-side test that one vadd iteration is correct
+#ifdef VERIFY
+    for (int i = 0; i < Sz; ++i)
+      if (CVec[i] != AVec[i] + BVec[i]) {
+        std::cerr << "At index: " << i << ". ";
+        std::cerr << CVec[i] << " != " << AVec[i] + BVec[i] << "\n";
+        abort();
+      }
+#endif
+    return ProfInfo;
+  }
+};
+
+REGISTER_VARIANT(vadd, "vectoradd_stream", VectorAddStream<int>);
+
+#ifndef SYCL_BENCH
+int main(int argc, char **argv) {
+  sycltesters::test_sequence<VectorAddStream<int>>(argc, argv);
+}
+#endif
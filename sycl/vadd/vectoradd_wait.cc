@@ -20,22 +20,23 @@
 #include "vadd_testers.hpp"
 
 // class is used for kernel name
-template <typename T> class vector_add_device;
+template <typename T> class vector_add_device_wait;
 
-template <typename T> class VectorAddDevice : public sycltesters::VectorAdd<T> {
+template <typename T>
+class VectorAddDeviceWait : public sycltesters::VectorAdd<T> {
   using sycltesters::VectorAdd<T>::Queue;
 
 public:
-  VectorAddDevice(cl::sycl::queue &DeviceQueue)
+  VectorAddDeviceWait(cl::sycl::queue &DeviceQueue)
       : sycltesters::VectorAdd<T>(DeviceQueue) {}
 
   sycltesters::EvtRet_t operator()(T const *AVec, T const *BVec, T *CVec,
                                    size_t Sz) override {
     sycltesters::EvtVec_t ProfInfo;
     auto &DeviceQueue = Queue();
-    int *A = cl::sycl::malloc_device<T>(Sz, DeviceQueue);
-    int *B = cl::sycl::malloc_device<T>(Sz, DeviceQueue);
-    int *C = cl::sycl::malloc_device<T>(Sz, DeviceQueue);
+    int *A = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
+    int *B = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
+    int *C = sycltesters::pool_malloc_device<T>(Sz, DeviceQueue);
 
     // kernels to copy to device
     auto EvtA = DeviceQueue.submit(
@@ -54,7 +55,7 @@ public:
       auto kern = [A, B, C](cl::sycl::id<1> wiID) {
         C[wiID] = A[wiID] + B[wiID];
       };
-      cgh.parallel_for<class vector_add_device<T>>(numOfItems, kern);
+      cgh.parallel_for<class vector_add_device_wait<T>>(numOfItems, kern);
     });
     ProfInfo.push_back(EvtC);
 #ifndef NOWAIT
@@ -83,13 +84,17 @@ public:
         abort();
       }
 #endif
-    cl::sycl::free(A, DeviceQueue);
-    cl::sycl::free(B, DeviceQueue);
-    cl::sycl::free(C, DeviceQueue);
+    sycltesters::pool_free(A, DeviceQueue);
+    sycltesters::pool_free(B, DeviceQueue);
+    sycltesters::pool_free(C, DeviceQueue);
     return ProfInfo;
   }
 };
 
+REGISTER_VARIANT(vadd, "vectoradd_wait", VectorAddDeviceWait<int>);
+
+#ifndef SYCL_BENCH
 int main(int argc, char **argv) {
-  sycltesters::test_sequence<VectorAddDevice<int>>(argc, argv);
+  sycltesters::test_sequence<VectorAddDeviceWait<int>>(argc, argv);
 }
+#endif